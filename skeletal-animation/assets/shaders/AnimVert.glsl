@@ -15,18 +15,97 @@ uniform mat4 u_Projection;
 const int MAX_TOTAL_JOINTS = 100;
 const int MAX_JOINTS_PER_VERTEX = 4; // no more than 4 joints can influence the position of a single vertex
 
+// The palette's layout is picked when the shader is compiled (see PaletteFormat.h): PALETTE_AFFINE_3X4,
+// PALETTE_DUAL_QUATERNION, or neither for whole matrices
+#if defined(PALETTE_AFFINE_3X4)
+// top three rows of each joint's offset from its bind pose, in model space
+uniform vec4 u_Palette[MAX_TOTAL_JOINTS * 3];
+#elif defined(PALETTE_DUAL_QUATERNION)
+// real then dual part of each joint's offset from its bind pose, in model space
+uniform vec4 u_Palette[MAX_TOTAL_JOINTS * 2];
+#else
 // joint's offset from its bind pose, in model space
 uniform mat4 u_SkinningMatrices[MAX_TOTAL_JOINTS];
+#endif
 
 out vec2 v_TexCoords;
 out vec3 v_Normal;
 out vec3 v_FragPos;
 
+#ifdef PALETTE_DUAL_QUATERNION
+// Blends the dual quaternions of the vertex's joints, rather than their matrices, and moves the vertex by the result
+void SkinDualQuaternion(out vec4 finalPosition, out vec3 localNormal)
+{
+	vec4 blendReal = vec4(0.0);
+	vec4 blendDual = vec4(0.0);
+	vec4 firstReal = vec4(0.0);
+	bool hasFirst = false;
+
+	for (int i = 0; i < MAX_JOINTS_PER_VERTEX; i++)
+	{
+		if (a_JointIds[i] == -1)
+		{
+			continue;
+		}
+		if (a_JointIds[i] >= MAX_TOTAL_JOINTS)
+		{
+			finalPosition = vec4(a_Position, 1.0);
+			localNormal = a_Normal;
+			return;
+		}
+
+		vec4 real = u_Palette[a_JointIds[i] * 2];
+		vec4 dual = u_Palette[a_JointIds[i] * 2 + 1];
+		if (!hasFirst)
+		{
+			firstReal = real;
+			hasFirst = true;
+		}
+
+		// q and -q are the same rotation, so blend the ones pointing the same way as the first
+		float weight = dot(real, firstReal) < 0.0 ? -a_JointWeights[i] : a_JointWeights[i];
+		blendReal += real * weight;
+		blendDual += dual * weight;
+	}
+
+	// Vertices no joint influences have nothing to blend, so they keep their bind pose
+	float realLength = length(blendReal);
+	if (realLength < 1e-6)
+	{
+		finalPosition = vec4(a_Position, 1.0);
+		localNormal = a_Normal;
+		return;
+	}
+	blendReal /= realLength;
+	blendDual /= realLength;
+
+	vec3 position = a_Position + 2.0 * cross(blendReal.xyz, cross(blendReal.xyz, a_Position) + blendReal.w * a_Position);
+	vec3 translation = 2.0 * (blendReal.w * blendDual.xyz - blendDual.w * blendReal.xyz + cross(blendReal.xyz, blendDual.xyz));
+	finalPosition = vec4(position + translation, 1.0);
+	localNormal = a_Normal + 2.0 * cross(blendReal.xyz, cross(blendReal.xyz, a_Normal) + blendReal.w * a_Normal);
+}
+#else
+mat4 GetSkinningMatrix(int jointId)
+{
+#ifdef PALETTE_AFFINE_3X4
+	int row = jointId * 3;
+	return transpose(mat4(u_Palette[row], u_Palette[row + 1], u_Palette[row + 2], vec4(0.0, 0.0, 0.0, 1.0)));
+#else
+	return u_SkinningMatrices[jointId];
+#endif
+}
+#endif
+
 void main()
 {
 	vec4 finalPosition = vec4(0.0);
 	vec3 localNormal = vec3(0.0);
 
+#ifdef PALETTE_DUAL_QUATERNION
+	SkinDualQuaternion(finalPosition, localNormal);
+#else
+	bool hasInfluence = false;
+
 	// Go through all joints attached to this vertex, and sum up their contribution to the final pos/rot of the vertex
 	for (int i = 0; i < MAX_JOINTS_PER_VERTEX; i++)
 	{
@@ -38,13 +117,25 @@ void main()
 		{
 			// Do not consider joints with IDs above 100 (S: how can this happen?)
 			finalPosition = vec4(a_Position, 1.0);
+			localNormal = a_Normal;
+			hasInfluence = true;
 			break;
 		}
 
-		vec4 bonePosition = u_SkinningMatrices[a_JointIds[i]] * vec4(a_Position, 1.0);
+		mat4 skinningMatrix = GetSkinningMatrix(a_JointIds[i]);
+		vec4 bonePosition = skinningMatrix * vec4(a_Position, 1.0);
 		finalPosition += bonePosition * a_JointWeights[i];
-		localNormal += mat3(u_SkinningMatrices[a_JointIds[i]]) * a_Normal;
+		localNormal += mat3(skinningMatrix) * a_Normal * a_JointWeights[i];
+		hasInfluence = true;
+	}
+
+	// Vertices no joint influences keep their bind pose, as in CpuSkinning
+	if (!hasInfluence)
+	{
+		finalPosition = vec4(a_Position, 1.0);
+		localNormal = a_Normal;
 	}
+#endif
 	
 	v_FragPos = vec3(u_Model * vec4(a_Position, 1.0));
 	v_Normal = mat3(transpose(inverse(u_Model))) * localNormal;
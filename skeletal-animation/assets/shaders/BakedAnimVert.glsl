@@ -0,0 +1,87 @@
+#version 330 core
+
+layout (location = 0) in vec3 a_Position;
+layout (location = 1) in vec3 a_Normal;
+layout (location = 2) in vec2 a_TexCoords;
+layout (location = 3) in vec3 a_Tangent;
+layout (location = 4) in vec3 a_BiTangent;
+layout (location = 5) in ivec4 a_JointIds; // IDs of all joints whose position influence this vertex's position
+layout (location = 6) in vec4 a_JointWeights; // weight of each joint's contribution to moving this vertex
+
+uniform mat4 u_Model;
+uniform mat4 u_View;
+uniform mat4 u_Projection;
+
+const int MAX_JOINTS_PER_VERTEX = 4;
+
+// texels per joint in each row of the atlas: the top three rows of its skinning matrix (see PaletteAtlas)
+const int TEXELS_PER_JOINT = 3;
+
+// skinning palettes baked by PaletteAtlas, one frame per row
+uniform sampler2D u_PaletteAtlas;
+
+// where the playing clip is in the atlas, and its timing in seconds
+uniform int u_ClipFirstRow;
+uniform int u_ClipNumFrames;
+uniform float u_ClipFrameDuration;
+uniform float u_ClipDuration;
+
+// seconds since the clip started; clips loop
+uniform float u_ClipTime;
+
+out vec2 v_TexCoords;
+out vec3 v_Normal;
+out vec3 v_FragPos;
+
+// joint's offset from its bind pose, blended between two consecutive frames
+mat4 FetchSkinningMatrix(int jointId, int row, float blend)
+{
+	int column = jointId * TEXELS_PER_JOINT;
+	vec4 rows[TEXELS_PER_JOINT];
+	for (int i = 0; i < TEXELS_PER_JOINT; i++)
+	{
+		vec4 current = texelFetch(u_PaletteAtlas, ivec2(column + i, row), 0);
+		vec4 next = texelFetch(u_PaletteAtlas, ivec2(column + i, row + 1), 0);
+		rows[i] = mix(current, next, blend);
+	}
+	return transpose(mat4(rows[0], rows[1], rows[2], vec4(0.0, 0.0, 0.0, 1.0)));
+}
+
+void main()
+{
+	// Same steps as PaletteAtlas::SamplePalette
+	float clipTime = mod(u_ClipTime, u_ClipDuration);
+	float framePosition = clipTime / u_ClipFrameDuration;
+	int frame = min(int(framePosition), u_ClipNumFrames - 2);
+	float blend = clamp(framePosition - float(frame), 0.0, 1.0);
+	int row = u_ClipFirstRow + frame;
+
+	vec4 finalPosition = vec4(0.0);
+	vec3 localNormal = vec3(0.0);
+	bool hasInfluence = false;
+
+	for (int i = 0; i < MAX_JOINTS_PER_VERTEX; i++)
+	{
+		if (a_JointIds[i] == -1)
+		{
+			continue;
+		}
+
+		mat4 skinningMatrix = FetchSkinningMatrix(a_JointIds[i], row, blend);
+		finalPosition += skinningMatrix * vec4(a_Position, 1.0) * a_JointWeights[i];
+		localNormal += mat3(skinningMatrix) * a_Normal * a_JointWeights[i];
+		hasInfluence = true;
+	}
+
+	// Vertices no joint influences keep their bind pose, as in CpuSkinning
+	if (!hasInfluence)
+	{
+		finalPosition = vec4(a_Position, 1.0);
+		localNormal = a_Normal;
+	}
+
+	v_FragPos = vec3(u_Model * vec4(a_Position, 1.0));
+	v_Normal = mat3(transpose(inverse(u_Model))) * localNormal;
+	gl_Position = u_Projection * u_View * u_Model * finalPosition;
+	v_TexCoords = a_TexCoords;
+}
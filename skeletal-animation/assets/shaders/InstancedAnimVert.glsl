@@ -0,0 +1,70 @@
+#version 330 core
+
+layout (location = 0) in vec3 a_Position;
+layout (location = 1) in vec3 a_Normal;
+layout (location = 2) in vec2 a_TexCoords;
+layout (location = 3) in vec3 a_Tangent;
+layout (location = 4) in vec3 a_BiTangent;
+layout (location = 5) in ivec4 a_JointIds; // IDs of all joints whose position influence this vertex's position
+layout (location = 6) in vec4 a_JointWeights; // weight of each joint's contribution to moving this vertex
+
+// per instance (see InstanceData in Mesh.h); the model matrix takes locations 7 to 10
+layout (location = 7) in mat4 a_InstanceModel;
+layout (location = 11) in int a_PaletteOffset; // where this instance's palette starts in u_Palettes, in joints
+
+uniform mat4 u_View;
+uniform mat4 u_Projection;
+
+const int MAX_JOINTS_PER_VERTEX = 4;
+
+// texels per joint in u_Palettes: the top three rows of its skinning matrix (see SkinnedInstanceBatch)
+const int TEXELS_PER_JOINT = 3;
+
+// every instance's palette, one after another
+uniform samplerBuffer u_Palettes;
+
+out vec2 v_TexCoords;
+out vec3 v_Normal;
+out vec3 v_FragPos;
+
+// joint's offset from its bind pose, in model space
+mat4 FetchSkinningMatrix(int jointId)
+{
+	int texel = (a_PaletteOffset + jointId) * TEXELS_PER_JOINT;
+	vec4 row0 = texelFetch(u_Palettes, texel);
+	vec4 row1 = texelFetch(u_Palettes, texel + 1);
+	vec4 row2 = texelFetch(u_Palettes, texel + 2);
+	return transpose(mat4(row0, row1, row2, vec4(0.0, 0.0, 0.0, 1.0)));
+}
+
+void main()
+{
+	vec4 finalPosition = vec4(0.0);
+	vec3 localNormal = vec3(0.0);
+	bool hasInfluence = false;
+
+	for (int i = 0; i < MAX_JOINTS_PER_VERTEX; i++)
+	{
+		if (a_JointIds[i] == -1)
+		{
+			continue;
+		}
+
+		mat4 skinningMatrix = FetchSkinningMatrix(a_JointIds[i]);
+		finalPosition += skinningMatrix * vec4(a_Position, 1.0) * a_JointWeights[i];
+		localNormal += mat3(skinningMatrix) * a_Normal * a_JointWeights[i];
+		hasInfluence = true;
+	}
+
+	// Vertices no joint influences keep their bind pose, as in CpuSkinning
+	if (!hasInfluence)
+	{
+		finalPosition = vec4(a_Position, 1.0);
+		localNormal = a_Normal;
+	}
+
+	v_FragPos = vec3(a_InstanceModel * vec4(a_Position, 1.0));
+	v_Normal = mat3(transpose(inverse(a_InstanceModel))) * localNormal;
+	gl_Position = u_Projection * u_View * a_InstanceModel * finalPosition;
+	v_TexCoords = a_TexCoords;
+}
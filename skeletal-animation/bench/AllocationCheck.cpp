@@ -0,0 +1,155 @@
+#include "AllocationCheck.h"
+
+#include "BenchmarkRig.h"
+
+#include "Animation/AllocationTracker.h"
+#include "Animation/AnimationScheduler.h"
+#include "Animation/Animator.h"
+#include "Animation/BlendNode.h"
+
+#include <glm/gtc/constants.hpp>
+
+namespace AllocationCheck
+{
+	static constexpr int NUM_JOINTS = 65;
+	static constexpr int NUM_CHARACTERS = 8;
+	static constexpr float FRAME_TIME = 1.0f / 60.0f;
+
+	//! Every character goes through the same sequence of inputs once per cycle
+	static constexpr int FRAMES_PER_CYCLE = 360;
+	static constexpr int WARM_UP_CYCLES = 2;
+	static constexpr int CHECKED_CYCLES = 4;
+
+	//! A small version of the demo's graph: idle, walk/run blend and a jump that returns to idle
+	struct Character
+	{
+		std::unique_ptr<BlendNode> LocomotionNode;
+
+		std::unique_ptr<AnimationState> IdleState;
+		std::unique_ptr<AnimationState> LocomotionState;
+		std::unique_ptr<AnimationState> JumpState;
+
+		std::unique_ptr<Transition> IdleToMove;
+		std::unique_ptr<Transition> MoveToIdle;
+		std::unique_ptr<Transition> IdleToJump;
+		std::unique_ptr<Transition> JumpToIdle;
+
+		Animator Instance;
+	};
+
+	struct Clips
+	{
+		std::unique_ptr<AnimationClip> Idle;
+		std::unique_ptr<AnimationClip> Walk;
+		std::unique_ptr<AnimationClip> Run;
+		std::unique_ptr<AnimationClip> Jump;
+	};
+
+	static void CreateCharacter(Character& character, const Clips& clips, const std::shared_ptr<JointDirectory>& jointDirectory,
+								const std::shared_ptr<AnimationLodSettings>& lodSettings)
+	{
+		character.LocomotionNode = std::make_unique<BlendNode>(clips.Walk.get(), clips.Run.get());
+
+		character.IdleState = std::make_unique<AnimationState>("Idle", clips.Idle.get(), true);
+		character.LocomotionState = std::make_unique<AnimationState>("Locomotion", character.LocomotionNode.get(), true, false);
+		character.LocomotionState->AddVar<float>("MoveSpeed", { 0.0f, 0.0f, 1.0f });
+		character.JumpState = std::make_unique<AnimationState>("Jumping", clips.Jump.get());
+
+		character.IdleToMove = std::make_unique<Transition>(character.IdleState.get(), character.LocomotionState.get(), 0.3f);
+		character.IdleState->AddTriggerTransition("MoveTrigger", character.IdleToMove.get());
+
+		character.MoveToIdle = std::make_unique<Transition>(character.LocomotionState.get(), character.IdleState.get(), 0.3f);
+		character.LocomotionState->AddTriggerTransition("IdleTrigger", character.MoveToIdle.get());
+
+		character.IdleToJump = std::make_unique<Transition>(character.IdleState.get(), character.JumpState.get(), 0.2f);
+		character.IdleState->AddTriggerTransition("JumpTrigger", character.IdleToJump.get());
+
+		character.JumpToIdle = std::make_unique<Transition>(character.JumpState.get(), character.IdleState.get(), 0.2f);
+		character.JumpState->SetOnCompleteTransition(character.JumpToIdle.get());
+
+		character.Instance.SetDirectory(jointDirectory);
+		character.Instance.SetState(character.IdleState.get());
+		character.Instance.SetFixedUpdateRate(30.0f);
+		character.Instance.SetLodSettings(lodSettings);
+	}
+
+	bool Run(std::ostream& stream)
+	{
+		if (!AllocationTracker::IsInstalled())
+		{
+			stream << "Allocation tracking isn't installed; compile AllocationHooks.cpp into this executable" << std::endl;
+			return false;
+		}
+
+		std::shared_ptr<JointDirectory> jointDirectory = BenchmarkRig::CreateSkeleton(NUM_JOINTS);
+
+		Clips clips;
+		clips.Idle = BenchmarkRig::CreateClip(*jointDirectory, 30);
+		clips.Walk = BenchmarkRig::CreateClip(*jointDirectory, 30);
+		clips.Run = BenchmarkRig::CreateClip(*jointDirectory, 20);
+		clips.Jump = BenchmarkRig::CreateClip(*jointDirectory, 30);
+
+		std::shared_ptr<AnimationLodSettings> lodSettings =
+			std::make_shared<AnimationLodSettings>(AnimationLodSettings::CreateDefault());
+
+		AnimationScheduler scheduler(1000.0f, 4);
+		std::vector<std::unique_ptr<Character>> characters;
+		for (int i = 0; i < NUM_CHARACTERS; i++)
+		{
+			characters.push_back(std::make_unique<Character>());
+			CreateCharacter(*characters.back(), clips, jointDirectory, lodSettings);
+			scheduler.AddAnimator(&characters.back()->Instance);
+		}
+
+		// Names are kept around as strings, so setting parameters doesn't construct any
+		const std::string moveTrigger = "MoveTrigger";
+		const std::string idleTrigger = "IdleTrigger";
+		const std::string jumpTrigger = "JumpTrigger";
+		const std::string moveSpeed = "MoveSpeed";
+
+		auto simulateFrame = [&](int frame)
+		{
+			int cycleFrame = frame % FRAMES_PER_CYCLE;
+			for (int i = 0; i < NUM_CHARACTERS; i++)
+			{
+				Animator& animator = characters[i]->Instance;
+
+				// Walk up to full speed, stop, then jump
+				if (cycleFrame == 30)
+					animator.SetTrigger(moveTrigger);
+				if (cycleFrame >= 30 && cycleFrame < 150)
+					animator.SetFloat(moveSpeed, (cycleFrame - 30) / 120.0f);
+				if (cycleFrame == 200)
+					animator.SetTrigger(idleTrigger);
+				if (cycleFrame == 260)
+					animator.SetTrigger(jumpTrigger);
+
+				// Move every character through all LOD tiers, and off-screen and back
+				float distance = 50.0f + 50.0f * glm::sin(glm::two_pi<float>() * (frame + 40 * i) / FRAMES_PER_CYCLE);
+				animator.SetLodFromDistance(distance);
+				animator.SetVisible(cycleFrame < 320 || i % 2 == 0);
+			}
+			scheduler.Update(FRAME_TIME);
+		};
+
+		int frame = 0;
+		for (; frame < WARM_UP_CYCLES * FRAMES_PER_CYCLE; frame++)
+			simulateFrame(frame);
+
+		stream << "Allocations while warming up: " << AllocationTracker::GetNumAllocations() << "\n";
+		AllocationTracker::Reset();
+		{
+			AllocationTracker::ForbidAllocationsScope forbidAllocations;
+			for (; frame < (WARM_UP_CYCLES + CHECKED_CYCLES) * FRAMES_PER_CYCLE; frame++)
+				simulateFrame(frame);
+		}
+
+		uint64_t numAllocations = AllocationTracker::GetNumForbiddenAllocations();
+		stream << "Steady state allocations over " << CHECKED_CYCLES * FRAMES_PER_CYCLE << " frames of "
+			<< NUM_CHARACTERS << " characters: " << numAllocations << "\n";
+		AllocationTracker::WriteReport(stream);
+		stream << std::flush;
+
+		return numAllocations == 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <ostream>
+
+//! Verifies that steady state animation updates don't allocate: drives a set of characters through their
+//! animation graphs until every state, transition and LOD tier has been used, then keeps doing the same with
+//! allocations forbidden. Needs AllocationHooks.cpp to be compiled into the executable.
+namespace AllocationCheck
+{
+	//! Returns whether no allocations happened after warming up, writing a per subsystem report to the stream
+	bool Run(std::ostream& stream);
+}
\ No newline at end of file
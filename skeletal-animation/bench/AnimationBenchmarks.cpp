@@ -0,0 +1,815 @@
+// Headless benchmarks of the animation runtime. Run with e.g.
+//   animation-benchmarks --benchmark_format=json --benchmark_out=results.json
+// to get machine-readable results that can be compared across releases.
+// When built with S_ENABLE_PROFILER, --trace_out=trace.json also records a Chrome trace of the run.
+// --check_allocations runs AllocationCheck instead of the benchmarks, failing if steady state updates allocate.
+// --check_accuracy runs PoseAccuracy instead, failing if a cheaper sampling or blending path strays too far from the reference.
+// --memory_report prints how much memory the benchmark assets take (see AssetMemory) instead of running the benchmarks.
+// --replay=recording.anrc plays back a recording made with the demo's --record instead (see RecordingReplay), optionally
+// with --poses_out=poses.bin to save the resulting poses and --compare_poses=poses.bin to compare them with saved ones.
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCheck.h"
+#include "AssetMemory.h"
+#include "PoseAccuracy.h"
+#include "RecordingReplay.h"
+#include "BenchmarkRig.h"
+#include "PerfCounters.h"
+
+#include "Animation/AllocationTracker.h"
+#include "Animation/AnimationScheduler.h"
+#include "Animation/Animator.h"
+#include "Animation/BlendHelper.h"
+#include "Animation/CpuSkinning.h"
+#include "Animation/FrameArena.h"
+#include "Animation/JointMask.h"
+#include "Animation/MotionDatabase.h"
+#include "Animation/PaletteAtlas.h"
+#include "Animation/PaletteFormat.h"
+#include "Animation/PoseCache.h"
+#include "Animation/PoseHelper.h"
+#include "Animation/Profiler.h"
+
+#include <cstring>
+#include <iostream>
+
+#include <random>
+
+//! Size of the Mixamo rig the demo uses, and a much bigger one to show how costs scale
+static constexpr int BOSS_SIZED_RIG_JOINTS = 65;
+static constexpr int LARGE_RIG_JOINTS = 1000;
+static constexpr int KEYS_PER_SECOND = 30;
+
+//! Stand-in for the vertex count of the boss model, which isn't in the repository (the demo's --cpu_skinning prints
+//! the real one), and a dense mesh
+static constexpr int BOSS_SIZED_MESH_VERTICES = 25000;
+static constexpr int DENSE_MESH_VERTICES = 200000;
+
+static constexpr float FRAME_TIME = 1.0f / 60.0f;
+
+static const AnimationLodTier s_FullDetail;
+
+//! Random times within a clip, so key lookups don't always hit the same spot
+static std::vector<float> CreateSampleTimes(float duration, size_t count = 256)
+{
+	std::mt19937 random(42);
+	std::uniform_real_distribution<float> distribution(0.0f, duration);
+
+	std::vector<float> times(count);
+	for (float& time : times)
+		time = distribution(random);
+	return times;
+}
+
+//! Evaluates a clip into a pose of the skeleton it was made for
+class ClipSampler
+{
+public:
+	ClipSampler(AnimationClip& clip, const JointDirectory& skeleton)
+		: m_Clip(clip), m_Skeleton(skeleton), m_Pose(skeleton.GetDefaultPose()) {}
+
+	PoseBuffer& Sample(float animationTime)
+	{
+		EvaluationContext context = { m_Skeleton, s_FullDetail, m_Arena };
+		m_Clip.Evaluate(animationTime, context, m_Pose.GetView());
+		return m_Pose;
+	}
+private:
+	AnimationClip& m_Clip;
+	const JointDirectory& m_Skeleton;
+	FrameArena m_Arena;
+	PoseBuffer m_Pose;
+};
+
+// Key lookup: sampling a single channel is dominated by finding the surrounding key frames
+static void BM_KeyLookup(benchmark::State& state)
+{
+	int numKeys = (int)state.range(0);
+	std::shared_ptr<JointDirectory> jointDirectory = BenchmarkRig::CreateSkeleton(1);
+	std::unique_ptr<AnimationClip> clip = BenchmarkRig::CreateClip(*jointDirectory, numKeys);
+	ClipSampler sampler(*clip, *jointDirectory);
+	std::vector<float> times = CreateSampleTimes(clip->GetDuration());
+
+	size_t i = 0;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(sampler.Sample(times[i++ % times.size()]));
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_KeyLookup)->Arg(8)->Arg(64)->Arg(512)->Arg(4096);
+
+static void BM_SampleClip(benchmark::State& state)
+{
+	int numJoints = (int)state.range(0);
+	std::shared_ptr<JointDirectory> jointDirectory = BenchmarkRig::CreateSkeleton(numJoints);
+	std::unique_ptr<AnimationClip> clip = BenchmarkRig::CreateClip(*jointDirectory, KEYS_PER_SECOND);
+	ClipSampler sampler(*clip, *jointDirectory);
+	std::vector<float> times = CreateSampleTimes(clip->GetDuration());
+
+	size_t i = 0;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(sampler.Sample(times[i++ % times.size()]));
+	state.SetItemsProcessed(state.iterations() * numJoints);
+}
+BENCHMARK(BM_SampleClip)->Arg(BOSS_SIZED_RIG_JOINTS)->Arg(LARGE_RIG_JOINTS);
+
+static void BM_BlendPoses(benchmark::State& state)
+{
+	int numJoints = (int)state.range(0);
+	std::shared_ptr<JointDirectory> jointDirectory = BenchmarkRig::CreateSkeleton(numJoints);
+	std::unique_ptr<AnimationClip> clip = BenchmarkRig::CreateClip(*jointDirectory, KEYS_PER_SECOND);
+	ClipSampler sourceSampler(*clip, *jointDirectory);
+	ClipSampler targetSampler(*clip, *jointDirectory);
+	PoseBuffer& source = sourceSampler.Sample(0.25f * clip->GetDuration());
+	PoseBuffer& target = targetSampler.Sample(0.75f * clip->GetDuration());
+
+	PoseBuffer blendedPose = jointDirectory->GetDefaultPose();
+	for (auto _ : state)
+	{
+		BlendHelper::BlendPoses(blendedPose.GetView(), source.GetView(), target.GetView(), 0.3f);
+		benchmark::DoNotOptimize(blendedPose);
+	}
+	state.SetItemsProcessed(state.iterations() * numJoints);
+}
+BENCHMARK(BM_BlendPoses)->Arg(BOSS_SIZED_RIG_JOINTS)->Arg(LARGE_RIG_JOINTS);
+
+static void BM_NlerpPoses(benchmark::State& state)
+{
+	int numJoints = (int)state.range(0);
+	std::shared_ptr<JointDirectory> jointDirectory = BenchmarkRig::CreateSkeleton(numJoints);
+	PoseBuffer source = jointDirectory->GetDefaultPose();
+	PoseBuffer target = source;
+	for (glm::quat& rotation : target.Rotations)
+		rotation = glm::angleAxis(0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
+
+	PoseBuffer blendedPose = source;
+	for (auto _ : state)
+	{
+		BlendHelper::NlerpPoses(blendedPose.GetView(), source.GetView(), target.GetView(), 0.3f);
+		benchmark::DoNotOptimize(blendedPose.Rotations.data());
+	}
+	state.SetItemsProcessed(state.iterations() * numJoints);
+}
+BENCHMARK(BM_NlerpPoses)->Arg(BOSS_SIZED_RIG_JOINTS)->Arg(LARGE_RIG_JOINTS);
+
+static void BM_LocalToModel(benchmark::State& state)
+{
+	int numJoints = (int)state.range(0);
+	std::shared_ptr<JointDirectory> jointDirectory = BenchmarkRig::CreateSkeleton(numJoints);
+	PoseBuffer pose = jointDirectory->GetDefaultPose();
+
+	std::vector<glm::mat4> modelSpaceTransforms;
+	for (auto _ : state)
+	{
+		PoseHelper::LocalToModel(jointDirectory->GetFlatNodes(), pose, modelSpaceTransforms);
+		benchmark::DoNotOptimize(modelSpaceTransforms.data());
+	}
+	state.SetItemsProcessed(state.iterations() * numJoints);
+}
+BENCHMARK(BM_LocalToModel)->Arg(BOSS_SIZED_RIG_JOINTS)->Arg(LARGE_RIG_JOINTS);
+
+static void BM_SkinningMatrices(benchmark::State& state)
+{
+	int numJoints = (int)state.range(0);
+	std::shared_ptr<JointDirectory> jointDirectory = BenchmarkRig::CreateSkeleton(numJoints);
+	PoseBuffer pose = jointDirectory->GetDefaultPose();
+
+	std::vector<glm::mat4> modelSpaceTransforms;
+	PoseHelper::LocalToModel(jointDirectory->GetFlatNodes(), pose, modelSpaceTransforms);
+
+	std::vector<glm::mat4> skinningMatrices(numJoints);
+	for (auto _ : state)
+	{
+		PoseHelper::BuildSkinningMatrices(jointDirectory->GetFlatNodes(), modelSpaceTransforms, skinningMatrices);
+		benchmark::DoNotOptimize(skinningMatrices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * numJoints);
+}
+BENCHMARK(BM_SkinningMatrices)->Arg(BOSS_SIZED_RIG_JOINTS)->Arg(LARGE_RIG_JOINTS);
+
+//! Ticks numInstances Animators playing the same clip once per iteration, as AnimationScheduler would run a frame
+static void RunAnimatorUpdates(benchmark::State& state, const std::shared_ptr<JointDirectory>& jointDirectory,
+							   AnimationClip& clip, int numInstances, const std::shared_ptr<JointMask>& jointMask = nullptr,
+							   const std::shared_ptr<PoseCache>& poseCache = nullptr)
+{
+	std::vector<std::unique_ptr<AnimationState>> states;
+	std::vector<std::unique_ptr<Animator>> animators;
+	for (int i = 0; i < numInstances; i++)
+	{
+		states.push_back(std::make_unique<AnimationState>("Loop", &clip, true));
+		animators.push_back(std::make_unique<Animator>());
+		animators.back()->SetDirectory(jointDirectory);
+		animators.back()->SetJointMask(jointMask);
+		animators.back()->SetPoseCache(poseCache);
+		animators.back()->SetState(states.back().get());
+
+		// Spread the instances out over the clip
+		animators.back()->Update(clip.GetDuration() / clip.GetTicksPerSecond() * i / numInstances);
+	}
+
+	uint64_t numAllocationsBefore = AllocationTracker::GetNumAllocations();
+	for (auto _ : state)
+	{
+		S_PROFILE_FRAME();
+		FrameArena::Get().BeginFrame();
+		for (std::unique_ptr<Animator>& animator : animators)
+			animator->Update(FRAME_TIME);
+		FrameArena::Get().EndFrame();
+	}
+	state.SetItemsProcessed(state.iterations() * numInstances);
+
+	// Includes the first iteration, so this isn't quite 0 even when the steady state doesn't allocate
+	state.counters["allocations"] = benchmark::Counter((double)(AllocationTracker::GetNumAllocations() - numAllocationsBefore),
+													   benchmark::Counter::kAvgIterations);
+}
+
+// Full Animator update (sampling, pose capture, hierarchy and palette) for 1 and N instances sharing a clip
+static void BM_AnimatorUpdate(benchmark::State& state)
+{
+	int numInstances = (int)state.range(0);
+	std::shared_ptr<JointDirectory> jointDirectory = BenchmarkRig::CreateSkeleton(BOSS_SIZED_RIG_JOINTS);
+	std::unique_ptr<AnimationClip> clip = BenchmarkRig::CreateClip(*jointDirectory, KEYS_PER_SECOND);
+	RunAnimatorUpdates(state, jointDirectory, *clip, numInstances);
+}
+BENCHMARK(BM_AnimatorUpdate)->Arg(1)->Arg(100);
+
+// Scaling sweep over rig size, key density and instance count, on deep skeletons made of chains like real limbs.
+// Filter with e.g. --benchmark_filter=BM_AnimatorUpdateSweep/joints:4000 to look at one slice.
+static void BM_AnimatorUpdateSweep(benchmark::State& state)
+{
+	SyntheticSkeletonSettings skeletonSettings;
+	skeletonSettings.NumJoints = (int)state.range(0);
+	skeletonSettings.ChainLength = 4;
+	std::shared_ptr<JointDirectory> jointDirectory = SyntheticRigHelper::CreateSkeleton(skeletonSettings);
+
+	SyntheticClipSettings clipSettings;
+	clipSettings.DurationSeconds = 4.0f;
+	clipSettings.KeysPerSecond = (float)state.range(1);
+	std::unique_ptr<AnimationClip> clip = SyntheticRigHelper::CreateClip(*jointDirectory, clipSettings);
+
+	RunAnimatorUpdates(state, jointDirectory, *clip, (int)state.range(2));
+	state.counters["depth"] = (double)SyntheticRigHelper::GetDepth(*jointDirectory);
+}
+BENCHMARK(BM_AnimatorUpdateSweep)
+	->ArgNames({ "joints", "keys", "instances" })
+	->ArgsProduct({ { 65, 500, 4000 }, { 30, 240 }, { 1, 16 } })
+	->Unit(benchmark::kMicrosecond);
+
+// Headless server update that only needs a root and three far apart joints (like hips, head and hands for hitboxes),
+// against the full update that builds every joint's skinning matrix
+static void BM_ServerAnimatorUpdate(benchmark::State& state)
+{
+	SyntheticSkeletonSettings skeletonSettings;
+	skeletonSettings.ChainLength = 4;
+	std::shared_ptr<JointDirectory> jointDirectory = SyntheticRigHelper::CreateSkeleton(skeletonSettings);
+	std::unique_ptr<AnimationClip> clip = BenchmarkRig::CreateClip(*jointDirectory, KEYS_PER_SECOND);
+
+	std::shared_ptr<JointMask> jointMask;
+	if (state.range(0) != 0)
+	{
+		const std::vector<FlatSkeletonNode>& nodes = jointDirectory->GetFlatNodes();
+		std::vector<std::string> jointNames;
+		for (size_t i : { (size_t)0, nodes.size() / 3, nodes.size() * 2 / 3, nodes.size() - 1 })
+			jointNames.push_back(nodes[i].Name);
+		jointMask = std::make_shared<JointMask>(*jointDirectory, jointNames);
+		state.counters["nodes"] = (double)jointMask->GetNodeIndices().size();
+	}
+	else
+	{
+		state.counters["nodes"] = (double)jointDirectory->GetFlatNodes().size();
+	}
+
+	RunAnimatorUpdates(state, jointDirectory, *clip, 100, jointMask);
+}
+BENCHMARK(BM_ServerAnimatorUpdate)->ArgName("masked")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// A crowd spread at random over many long clips, updated by an AnimationScheduler in order of urgency ("grouped:0") or
+// grouped by clip. Reports hardware cache misses per frame where the kernel lets us count them.
+static void BM_MixedCrowdUpdate(benchmark::State& state)
+{
+	constexpr int numClips = 32;
+	int numInstances = (int)state.range(0);
+	std::shared_ptr<JointDirectory> jointDirectory = BenchmarkRig::CreateSkeleton(BOSS_SIZED_RIG_JOINTS);
+
+	SyntheticClipSettings clipSettings;
+	clipSettings.DurationSeconds = 4.0f;
+	clipSettings.KeysPerSecond = 60.0f;
+	std::vector<std::unique_ptr<AnimationClip>> clips;
+	for (int i = 0; i < numClips; i++)
+	{
+		clipSettings.Seed = i;
+		clips.push_back(SyntheticRigHelper::CreateClip(*jointDirectory, clipSettings));
+	}
+
+	// Budget large enough that everyone is updated every frame, so both orders do the same work
+	AnimationScheduler scheduler(1000.0f, 4);
+	scheduler.SetGroupedByAnimation(state.range(1) != 0);
+
+	std::mt19937 random(7);
+	std::vector<std::unique_ptr<AnimationState>> states;
+	std::vector<std::unique_ptr<Animator>> animators;
+	for (int i = 0; i < numInstances; i++)
+	{
+		AnimationClip& clip = *clips[random() % numClips];
+		states.push_back(std::make_unique<AnimationState>("Loop", &clip, true));
+		animators.push_back(std::make_unique<Animator>());
+		animators.back()->SetDirectory(jointDirectory);
+		animators.back()->SetState(states.back().get());
+		animators.back()->Update(clipSettings.DurationSeconds * (random() % 1000) / 1000.0f);
+		scheduler.AddAnimator(animators.back().get());
+	}
+
+	PerfCounters perfCounters;
+	for (auto _ : state)
+	{
+		perfCounters.Start();
+		scheduler.Update(FRAME_TIME);
+		perfCounters.Stop();
+	}
+	state.SetItemsProcessed(state.iterations() * numInstances);
+	state.counters["groups"] = (double)scheduler.GetStats().NumAnimationGroups;
+
+	if (perfCounters.IsAvailable())
+	{
+		const PerfCounters::Counts& counts = perfCounters.GetCounts();
+		state.counters["llc_misses"] = benchmark::Counter((double)counts.CacheMisses, benchmark::Counter::kAvgIterations);
+		state.counters["llc_refs"] = benchmark::Counter((double)counts.CacheReferences, benchmark::Counter::kAvgIterations);
+		state.counters["l1d_misses"] = benchmark::Counter((double)counts.L1DataMisses, benchmark::Counter::kAvgIterations);
+	}
+}
+BENCHMARK(BM_MixedCrowdUpdate)
+	->ArgNames({ "instances", "grouped" })
+	->ArgsProduct({ { 256, 1024 }, { 0, 1 } })
+	->Unit(benchmark::kMillisecond);
+
+// A crowd idling in the same looping clip out of step, with and without a pose cache of 1/30 s buckets
+static void BM_PoseCacheCrowd(benchmark::State& state)
+{
+	int numInstances = (int)state.range(0);
+	std::shared_ptr<JointDirectory> jointDirectory = BenchmarkRig::CreateSkeleton(BOSS_SIZED_RIG_JOINTS);
+	SyntheticClipSettings clipSettings;
+	clipSettings.DurationSeconds = 4.0f;
+	std::unique_ptr<AnimationClip> clip = SyntheticRigHelper::CreateClip(*jointDirectory, clipSettings);
+
+	std::shared_ptr<PoseCache> poseCache = state.range(1) != 0 ? std::make_shared<PoseCache>() : nullptr;
+	RunAnimatorUpdates(state, jointDirectory, *clip, numInstances, nullptr, poseCache);
+	if (poseCache)
+		state.counters["hit_rate"] = poseCache->GetStats().GetHitRate();
+}
+BENCHMARK(BM_PoseCacheCrowd)
+	->ArgNames({ "instances", "cached" })
+	->ArgsProduct({ { 100, 1000 }, { 0, 1 } })
+	->Unit(benchmark::kMicrosecond);
+
+// Off-screen characters that only need a few joints this frame (e.g. a weapon attachment and hitboxes): the graph moves
+// on without sampling, then each joint is queried. "joints:0" is the full visible update, for comparison.
+static void BM_JointQuery(benchmark::State& state)
+{
+	int numQueries = (int)state.range(0);
+	SyntheticSkeletonSettings skeletonSettings;
+	skeletonSettings.ChainLength = 4;
+	std::shared_ptr<JointDirectory> jointDirectory = SyntheticRigHelper::CreateSkeleton(skeletonSettings);
+	std::unique_ptr<AnimationClip> clip = BenchmarkRig::CreateClip(*jointDirectory, KEYS_PER_SECOND);
+
+	// Leaves at the ends of different limbs, so each query after the first shares only part of its chain
+	int numNodes = (int)jointDirectory->GetFlatNodes().size();
+	std::vector<int> queriedNodes;
+	for (int i = 0; i < numQueries; i++)
+		queriedNodes.push_back(numNodes - 1 - i * numNodes / 8);
+
+	AnimationState animationState("Loop", clip.get(), true);
+	Animator animator;
+	animator.SetDirectory(jointDirectory);
+	animator.SetState(&animationState);
+	animator.SetVisible(numQueries == 0);
+
+	for (auto _ : state)
+	{
+		FrameArena::Get().BeginFrame();
+		animator.Update(FRAME_TIME);
+		for (int node : queriedNodes)
+			benchmark::DoNotOptimize(animator.QueryModelSpaceTransform(node));
+		FrameArena::Get().EndFrame();
+	}
+}
+BENCHMARK(BM_JointQuery)->ArgName("joints")->Arg(0)->Arg(1)->Arg(4);
+
+//! Samples a crowd playing the same clip out of step, one character at a time or with one EvaluateBatch
+static void RunCrowdSampling(benchmark::State& state, AnimationClip& clip, const JointDirectory& skeleton, int numInstances,
+							 bool isBatched)
+{
+	std::vector<PoseBuffer> poses(numInstances, skeleton.GetDefaultPose());
+	std::vector<PoseView> poseViews;
+	for (PoseBuffer& pose : poses)
+		poseViews.push_back(pose.GetView());
+
+	// Clips in normalised time take a fraction of their duration
+	std::vector<float> times = CreateSampleTimes(clip.UsesLocalTime() ? clip.GetDuration() : 1.0f, numInstances);
+	FrameArena arena;
+	EvaluationContext context = { skeleton, s_FullDetail, arena };
+
+	for (auto _ : state)
+	{
+		if (isBatched)
+		{
+			clip.EvaluateBatch(times.data(), poseViews.data(), numInstances, context);
+		}
+		else
+		{
+			for (int i = 0; i < numInstances; i++)
+				clip.Evaluate(times[i], context, poseViews[i]);
+		}
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * numInstances);
+}
+
+static void BM_CrowdSampling(benchmark::State& state)
+{
+	std::shared_ptr<JointDirectory> jointDirectory = BenchmarkRig::CreateSkeleton(BOSS_SIZED_RIG_JOINTS);
+	SyntheticClipSettings clipSettings;
+	clipSettings.DurationSeconds = 4.0f;
+	std::unique_ptr<AnimationClip> clip = SyntheticRigHelper::CreateClip(*jointDirectory, clipSettings);
+	RunCrowdSampling(state, *clip, *jointDirectory, (int)state.range(0), state.range(1) != 0);
+}
+BENCHMARK(BM_CrowdSampling)
+	->ArgNames({ "instances", "batched" })
+	->ArgsProduct({ { 100, 1000 }, { 0, 1 } })
+	->Unit(benchmark::kMicrosecond);
+
+//! A motion matching database of about numFrames frames over generated clips that walk and turn at different rates
+class SyntheticMotionDatabase
+{
+public:
+	explicit SyntheticMotionDatabase(int numFrames)
+	{
+		m_Skeleton = BenchmarkRig::CreateSkeleton(BOSS_SIZED_RIG_JOINTS);
+
+		SyntheticClipSettings clipSettings;
+		clipSettings.DurationSeconds = CLIP_SECONDS;
+		clipSettings.KeysPerSecond = 10.0f;
+
+		int numClips = glm::max(numFrames / (int)(CLIP_SECONDS * 30.0f), 1);
+		for (int i = 0; i < numClips; i++)
+		{
+			clipSettings.Seed = i;
+			clipSettings.RootSpeed = (float)(i % 4);
+			clipSettings.RootTurnRate = ((i % 7) - 3) * 0.3f;
+			clipSettings.Name = "MotionClip" + std::to_string(i);
+			m_Clips.push_back(SyntheticRigHelper::CreateClip(*m_Skeleton, clipSettings));
+			m_Database.AddClip(m_Clips.back().get());
+		}
+
+		// The root, and a few leaves standing in for the feet and hands
+		MotionFeatureSettings featureSettings;
+		featureSettings.RootJoint = m_Skeleton->GetFlatNodes()[0].Name;
+		for (int joint : { 64, 50, 30 })
+			featureSettings.FeatureJoints.push_back("syntheticrig:Joint" + std::to_string(joint));
+		m_Database.Build(*m_Skeleton, featureSettings);
+	}
+
+	const MotionDatabase& GetDatabase() const { return m_Database; }
+	const std::shared_ptr<JointDirectory>& GetSkeleton() const { return m_Skeleton; }
+private:
+	static constexpr float CLIP_SECONDS = 10.0f;
+
+	std::shared_ptr<JointDirectory> m_Skeleton;
+	std::vector<std::unique_ptr<AnimationClip>> m_Clips;
+	MotionDatabase m_Database;
+};
+
+//! Queries starting from random frames of the database, asking for random trajectories
+static std::vector<std::vector<float>> CreateMotionQueries(const MotionDatabase& database, size_t count = 64)
+{
+	std::mt19937 random(42);
+	std::uniform_int_distribution<int> frames(0, database.GetNumFrames() - 1);
+	std::uniform_real_distribution<float> offsets(-3.0f, 3.0f);
+
+	MotionTrajectory trajectory;
+	trajectory.Positions.resize(database.GetSettings().TrajectoryTimes.size());
+	trajectory.Directions.resize(trajectory.Positions.size());
+
+	std::vector<std::vector<float>> queries(count, std::vector<float>(database.GetFeatureStride()));
+	for (std::vector<float>& query : queries)
+	{
+		for (size_t i = 0; i < trajectory.Positions.size(); i++)
+		{
+			trajectory.Positions[i] = glm::vec2(offsets(random), offsets(random));
+			trajectory.Directions[i] = glm::normalize(glm::vec2(offsets(random), offsets(random)) + glm::vec2(0.0f, 0.01f));
+		}
+		database.BuildQuery(frames(random), trajectory, query.data());
+	}
+	return queries;
+}
+
+// Motion matching: one search of the feature database, by brute force and with bounding boxes
+static void BM_MotionSearch(benchmark::State& state)
+{
+	SyntheticMotionDatabase motion((int)state.range(0));
+	const MotionDatabase& database = motion.GetDatabase();
+	MotionSearchMode mode = state.range(1) == 0 ? MotionSearchMode::BruteForce : MotionSearchMode::BoundingBoxes;
+	std::vector<std::vector<float>> queries = CreateMotionQueries(database);
+
+	size_t i = 0;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(database.Search(queries[i++ % queries.size()].data(), mode));
+
+	state.SetItemsProcessed(state.iterations());
+	state.counters["frames"] = (double)database.GetNumFrames();
+}
+BENCHMARK(BM_MotionSearch)
+	->ArgNames({ "frames", "boxes" })
+	->ArgsProduct({ { 1000, 10000, 50000 }, { 0, 1 } })
+	->Unit(benchmark::kMicrosecond);
+
+//! Each character moves by its clip's root motion since last frame and looks up its future trajectory (e.g. for
+//! motion matching or gameplay prediction), without sampling a pose
+static void BM_RootMotionQuery(benchmark::State& state)
+{
+	std::shared_ptr<JointDirectory> skeleton = BenchmarkRig::CreateSkeleton(BOSS_SIZED_RIG_JOINTS);
+	SyntheticClipSettings clipSettings;
+	clipSettings.DurationSeconds = 1.2f;
+	clipSettings.RootSpeed = 1.5f;
+	clipSettings.RootTurnRate = 0.5f;
+	clipSettings.ShouldExtractRootMotion = true;
+	std::unique_ptr<AnimationClip> clip = SyntheticRigHelper::CreateClip(*skeleton, clipSettings);
+	const RootMotionTrack& rootMotion = clip->GetRootMotion();
+
+	int numCharacters = (int)state.range(0);
+	std::vector<float> times = CreateSampleTimes(rootMotion.GetDuration());
+	const float futureSeconds[] = { 0.33f, 0.66f, 1.0f };
+	const float deltaTime = 1.0f / 60.0f;
+	glm::vec2 positions[3];
+	glm::vec2 directions[3];
+
+	size_t frame = 0;
+	for (auto _ : state)
+	{
+		for (int i = 0; i < numCharacters; i++)
+		{
+			float time = times[(frame + i) % times.size()];
+			benchmark::DoNotOptimize(rootMotion.GetDelta(time, time + deltaTime, true));
+			rootMotion.GetTrajectory(time, futureSeconds, 3, positions, directions, true);
+			benchmark::DoNotOptimize(positions);
+		}
+		frame++;
+	}
+
+	state.SetItemsProcessed(state.iterations() * numCharacters);
+}
+BENCHMARK(BM_RootMotionQuery)->ArgName("characters")->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+//! One-off cost of baking a clip's palettes for GPU playback (see PaletteAtlas), and the size of the texture it makes
+static void BM_BakePaletteAtlas(benchmark::State& state)
+{
+	std::shared_ptr<JointDirectory> skeleton = BenchmarkRig::CreateSkeleton(BOSS_SIZED_RIG_JOINTS);
+	std::unique_ptr<AnimationClip> clip = BenchmarkRig::CreateClip(*skeleton, KEYS_PER_SECOND);
+
+	PaletteAtlasSettings settings;
+	settings.UseHalfFloats = state.range(0) != 0;
+
+	size_t textureBytes = 0;
+	for (auto _ : state)
+	{
+		PaletteAtlas atlas;
+		atlas.AddClip(clip.get());
+		atlas.Build(*skeleton, settings);
+		textureBytes = atlas.GetTexelBytes();
+		benchmark::DoNotOptimize(atlas.GetTexels());
+	}
+
+	state.counters["texture_kb"] = textureBytes / 1024.0;
+}
+BENCHMARK(BM_BakePaletteAtlas)->ArgName("half")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Palette packing: what each format costs the CPU per character, against the bytes it saves uploading
+static void BM_PackPalette(benchmark::State& state)
+{
+	PaletteFormat format = (PaletteFormat)state.range(0);
+	std::shared_ptr<JointDirectory> skeleton = BenchmarkRig::CreateSkeleton(BOSS_SIZED_RIG_JOINTS);
+	std::unique_ptr<AnimationClip> clip = BenchmarkRig::CreateClip(*skeleton, KEYS_PER_SECOND);
+	ClipSampler sampler(*clip, *skeleton);
+
+	std::vector<glm::mat4> modelSpaceTransforms;
+	std::vector<glm::mat4> skinningMatrices(skeleton->GetNumJoints(), glm::mat4(1.0f));
+	PoseHelper::LocalToModel(skeleton->GetFlatNodes(), sampler.Sample(0.5f), modelSpaceTransforms);
+	PoseHelper::BuildSkinningMatrices(skeleton->GetFlatNodes(), modelSpaceTransforms, skinningMatrices);
+
+	std::vector<float> palette(skinningMatrices.size() * PaletteHelper::GetFloatsPerJoint(format));
+	for (auto _ : state)
+	{
+		PaletteHelper::Pack(format, skinningMatrices.data(), skinningMatrices.size(), palette.data());
+		benchmark::DoNotOptimize(palette.data());
+		benchmark::ClobberMemory();
+	}
+
+	state.SetLabel(PaletteHelper::GetName(format));
+	state.counters["palette_bytes"] = (double)(palette.size() * sizeof(float));
+}
+BENCHMARK(BM_PackPalette)->ArgName("format")
+	->Arg((int)PaletteFormat::Matrix4x4)->Arg((int)PaletteFormat::Affine3x4)->Arg((int)PaletteFormat::DualQuaternion);
+
+// CPU skinning: each thread skins its share of the mesh's chunks, as jobs of a parallel-for would
+static void BM_CpuSkinning(benchmark::State& state)
+{
+	size_t numVertices = (size_t)state.range(0);
+	std::shared_ptr<JointDirectory> skeleton = BenchmarkRig::CreateSkeleton(BOSS_SIZED_RIG_JOINTS);
+	std::unique_ptr<AnimationClip> clip = BenchmarkRig::CreateClip(*skeleton, KEYS_PER_SECOND);
+	ClipSampler sampler(*clip, *skeleton);
+
+	std::vector<glm::mat4> modelSpaceTransforms;
+	std::vector<glm::mat4> skinningMatrices(skeleton->GetNumJoints(), glm::mat4(1.0f));
+	PoseHelper::LocalToModel(skeleton->GetFlatNodes(), sampler.Sample(0.5f), modelSpaceTransforms);
+	PoseHelper::BuildSkinningMatrices(skeleton->GetFlatNodes(), modelSpaceTransforms, skinningMatrices);
+
+	std::vector<BenchmarkRig::SkinnedVertex> vertices = BenchmarkRig::CreateSkinnedVertices(skeleton->GetNumJoints(), numVertices);
+	CpuSkinningSettings settings;
+	settings.GroupByInfluenceCount = state.range(1) != 0;
+	CpuSkinning skinning;
+	skinning.Build(BenchmarkRig::GetSkinningSource(vertices), settings);
+
+	uint32_t numChunks = skinning.GetNumChunks();
+	uint32_t firstChunk = numChunks * state.thread_index() / state.threads();
+	uint32_t endChunk = numChunks * (state.thread_index() + 1) / state.threads();
+
+	std::vector<glm::vec3> positions(numVertices);
+	std::vector<glm::vec3> normals(numVertices);
+	for (auto _ : state)
+	{
+		skinning.SkinChunks(skinningMatrices.data(), skinningMatrices.size(), positions.data(), normals.data(),
+							firstChunk, endChunk - firstChunk);
+		benchmark::ClobberMemory();
+	}
+
+	size_t numSkinned = glm::min((size_t)endChunk * settings.ChunkSize, numVertices) - (size_t)firstChunk * settings.ChunkSize;
+	state.SetItemsProcessed(state.iterations() * numSkinned);
+}
+BENCHMARK(BM_CpuSkinning)
+	->ArgNames({ "vertices", "grouped" })
+	->ArgsProduct({ { BOSS_SIZED_MESH_VERTICES, DENSE_MESH_VERTICES }, { 0, 1 } })
+	->Threads(1)->Threads(4)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+#ifdef ANIMATION_WITH_ASSIMP
+static void BM_ImportBossClip(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		std::shared_ptr<JointDirectory> jointDirectory = std::make_shared<JointDirectory>();
+		AnimationClip clip(BenchmarkRig::GetBossAssetPath("walking.fbx"), jointDirectory, true);
+		benchmark::DoNotOptimize(clip.GetDuration());
+	}
+}
+BENCHMARK(BM_ImportBossClip)->Unit(benchmark::kMillisecond);
+
+static void BM_SampleBossClip(benchmark::State& state)
+{
+	std::shared_ptr<JointDirectory> jointDirectory = std::make_shared<JointDirectory>();
+	AnimationClip clip(BenchmarkRig::GetBossAssetPath("walking.fbx"), jointDirectory, true);
+	ClipSampler sampler(clip, *jointDirectory);
+	std::vector<float> times = CreateSampleTimes(1.0f);
+
+	size_t i = 0;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(sampler.Sample(times[i++ % times.size()]));
+}
+BENCHMARK(BM_SampleBossClip);
+
+static void BM_BossAnimatorUpdate(benchmark::State& state)
+{
+	int numInstances = (int)state.range(0);
+	std::shared_ptr<JointDirectory> jointDirectory = std::make_shared<JointDirectory>();
+	AnimationClip idleClip(BenchmarkRig::GetBossAssetPath("idle (2).fbx"), jointDirectory, false, true);
+	BenchmarkRig::BindAllNodesAsJoints(*jointDirectory);
+
+	std::vector<std::unique_ptr<AnimationState>> states;
+	std::vector<std::unique_ptr<Animator>> animators;
+	for (int i = 0; i < numInstances; i++)
+	{
+		states.push_back(std::make_unique<AnimationState>("Idle", &idleClip, true));
+		animators.push_back(std::make_unique<Animator>());
+		animators.back()->SetDirectory(jointDirectory);
+		animators.back()->SetState(states.back().get());
+	}
+
+	for (auto _ : state)
+	{
+		for (std::unique_ptr<Animator>& animator : animators)
+			animator->Update(FRAME_TIME);
+	}
+	state.SetItemsProcessed(state.iterations() * numInstances);
+}
+BENCHMARK(BM_BossAnimatorUpdate)->Arg(1)->Arg(100);
+
+static void BM_BossCrowdSampling(benchmark::State& state)
+{
+	std::shared_ptr<JointDirectory> jointDirectory = std::make_shared<JointDirectory>();
+	AnimationClip clip(BenchmarkRig::GetBossAssetPath("walking.fbx"), jointDirectory, true);
+	RunCrowdSampling(state, clip, *jointDirectory, (int)state.range(0), state.range(1) != 0);
+}
+BENCHMARK(BM_BossCrowdSampling)
+	->ArgNames({ "instances", "batched" })
+	->ArgsProduct({ { 100, 1000 }, { 0, 1 } })
+	->Unit(benchmark::kMicrosecond);
+
+// Motion matching over every boss clip, matching the feet and hips
+static void BM_BossMotionSearch(benchmark::State& state)
+{
+	std::shared_ptr<JointDirectory> jointDirectory = std::make_shared<JointDirectory>();
+	std::vector<std::unique_ptr<AnimationClip>> clips = BenchmarkRig::LoadBossClips(jointDirectory);
+
+	MotionDatabase database;
+	for (std::unique_ptr<AnimationClip>& clip : clips)
+		database.AddClip(clip.get());
+
+	MotionFeatureSettings featureSettings;
+	featureSettings.RootJoint = "mixamorig:Hips";
+	featureSettings.FeatureJoints = { "mixamorig:LeftFoot", "mixamorig:RightFoot", "mixamorig:Hips" };
+	database.Build(*jointDirectory, featureSettings);
+
+	MotionSearchMode mode = state.range(0) == 0 ? MotionSearchMode::BruteForce : MotionSearchMode::BoundingBoxes;
+	std::vector<std::vector<float>> queries = CreateMotionQueries(database);
+
+	size_t i = 0;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(database.Search(queries[i++ % queries.size()].data(), mode));
+
+	state.counters["frames"] = (double)database.GetNumFrames();
+}
+BENCHMARK(BM_BossMotionSearch)->ArgName("boxes")->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+#endif
+
+int main(int argc, char** argv)
+{
+	// Take out our own arguments before Google Benchmark complains about them
+	const char* traceFilePath = nullptr;
+	bool shouldCheckAllocations = false;
+	bool shouldReportMemory = false;
+	bool shouldCheckAccuracy = false;
+	RecordingReplay::Options replayOptions;
+	int numArgs = 0;
+	for (int i = 0; i < argc; i++)
+	{
+		if (std::strncmp(argv[i], "--trace_out=", 12) == 0)
+			traceFilePath = argv[i] + 12;
+		else if (std::strcmp(argv[i], "--check_allocations") == 0)
+			shouldCheckAllocations = true;
+		else if (std::strcmp(argv[i], "--check_accuracy") == 0)
+			shouldCheckAccuracy = true;
+		else if (std::strcmp(argv[i], "--memory_report") == 0)
+			shouldReportMemory = true;
+		else if (std::strncmp(argv[i], "--replay=", 9) == 0)
+			replayOptions.RecordingPath = argv[i] + 9;
+		else if (std::strncmp(argv[i], "--poses_out=", 12) == 0)
+			replayOptions.PosesOutPath = argv[i] + 12;
+		else if (std::strncmp(argv[i], "--compare_poses=", 16) == 0)
+			replayOptions.ComparePosesPath = argv[i] + 16;
+		else
+			argv[numArgs++] = argv[i];
+	}
+	argc = numArgs;
+
+	if (shouldCheckAllocations)
+		return AllocationCheck::Run(std::cout) ? 0 : 1;
+
+	if (shouldCheckAccuracy)
+		return PoseAccuracy::Run(std::cout) ? 0 : 1;
+
+	if (shouldReportMemory)
+	{
+		AssetMemory::WriteReport(std::cout);
+		return 0;
+	}
+
+	if (replayOptions.RecordingPath)
+		return RecordingReplay::Run(replayOptions, std::cout) ? 0 : 1;
+
+#ifndef S_ENABLE_PROFILER
+	if (traceFilePath)
+	{
+		std::cerr << "--trace_out needs the benchmarks to be built with S_ENABLE_PROFILER" << std::endl;
+		return 1;
+	}
+#endif
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	if (traceFilePath)
+		Profiler::BeginSession();
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	if (traceFilePath)
+	{
+		Profiler::EndSession();
+		if (!Profiler::WriteChromeTrace(traceFilePath))
+		{
+			std::cerr << "Failed to write trace to " << traceFilePath << std::endl;
+			return 1;
+		}
+		Profiler::WriteFrameSummary(std::cerr);
+	}
+	return 0;
+}
\ No newline at end of file
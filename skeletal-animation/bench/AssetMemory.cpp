@@ -0,0 +1,67 @@
+#include "AssetMemory.h"
+
+#include "BenchmarkRig.h"
+
+#include "Animation/Animator.h"
+#include "Animation/MemoryReport.h"
+
+#include <string>
+
+namespace AssetMemory
+{
+	//! Sizes of the rigs in the benchmarks
+	static constexpr int RIG_SIZES[] = { 65, 1000 };
+	static constexpr int KEYS_PER_SECOND = 30;
+
+	//! Runs an animator for a frame so its pose buffers are allocated, then adds it to the report
+	static void ReportAnimator(MemoryReport& report, const std::shared_ptr<JointDirectory>& jointDirectory,
+							   AnimationNode* animation, const std::string& name)
+	{
+		AnimationState state("Report", animation, true);
+		Animator animator;
+		animator.SetDirectory(jointDirectory);
+		animator.SetState(&state);
+		animator.Update(1.0f / 60.0f);
+		animator.ReportMemory(report, name);
+	}
+
+	void WriteReport(std::ostream& stream)
+	{
+		MemoryReport report;
+
+#ifdef ANIMATION_WITH_ASSIMP
+		{
+			static const char* bossClipFiles[] = {
+				"idle (2).fbx", "walking.fbx", "running.fbx", "run to stop.fbx",
+				"jumping up.fbx", "falling idle.fbx", "hard landing.fbx", "falling to roll.fbx"
+			};
+
+			std::shared_ptr<JointDirectory> jointDirectory = std::make_shared<JointDirectory>();
+			std::vector<std::unique_ptr<AnimationClip>> clips;
+			for (const char* fileName : bossClipFiles)
+				clips.push_back(std::make_unique<AnimationClip>(BenchmarkRig::GetBossAssetPath(fileName), jointDirectory, false, true));
+			BenchmarkRig::BindAllNodesAsJoints(*jointDirectory);
+
+			for (const std::unique_ptr<AnimationClip>& clip : clips)
+				clip->ReportMemory(report);
+			jointDirectory->ReportMemory(report, "The Boss.fbx");
+			ReportAnimator(report, jointDirectory, clips.front().get(), "Boss");
+		}
+#else
+		stream << "Built without assimp, so only generated rigs are reported\n";
+#endif
+
+		for (int numJoints : RIG_SIZES)
+		{
+			std::string name = "BenchmarkRig" + std::to_string(numJoints);
+			std::shared_ptr<JointDirectory> jointDirectory = BenchmarkRig::CreateSkeleton(numJoints);
+			std::unique_ptr<AnimationClip> clip = BenchmarkRig::CreateClip(*jointDirectory, KEYS_PER_SECOND);
+
+			clip->ReportMemory(report);
+			jointDirectory->ReportMemory(report, name);
+			ReportAnimator(report, jointDirectory, clip.get(), name);
+		}
+
+		report.Write(stream);
+	}
+}
\ No newline at end of file
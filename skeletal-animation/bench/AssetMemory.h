@@ -0,0 +1,11 @@
+#pragma once
+
+#include <ostream>
+
+//! Memory accounting of the assets the benchmarks use: the boss skeleton and clips (when built with assimp) and
+//! generated rigs of different sizes, plus an Animator for each. Meshes and textures need a GL context, so only
+//! the demo reports those (see its --memory_report).
+namespace AssetMemory
+{
+	void WriteReport(std::ostream& stream);
+}
\ No newline at end of file
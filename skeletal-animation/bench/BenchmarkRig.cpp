@@ -0,0 +1,103 @@
+#include "BenchmarkRig.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+namespace BenchmarkRig
+{
+	std::shared_ptr<JointDirectory> CreateSkeleton(int numJoints, int branching)
+	{
+		SyntheticSkeletonSettings settings;
+		settings.NumJoints = numJoints;
+		settings.Branching = branching;
+		return SyntheticRigHelper::CreateSkeleton(settings);
+	}
+
+	std::unique_ptr<AnimationClip> CreateClip(const JointDirectory& skeleton, int numKeys)
+	{
+		SyntheticClipSettings settings;
+		settings.KeysPerSecond = (float)numKeys;
+		return SyntheticRigHelper::CreateClip(skeleton, settings);
+	}
+
+	std::vector<SkinnedVertex> CreateSkinnedVertices(int numJoints, size_t numVertices)
+	{
+		// Share of vertices with 1, 2, 3 and 4 influences
+		static constexpr float INFLUENCE_SHARES[CpuSkinningSource::MAX_INFLUENCES] = { 0.35f, 0.3f, 0.2f, 0.15f };
+
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+		std::vector<SkinnedVertex> vertices(numVertices);
+		for (size_t i = 0; i < numVertices; i++)
+		{
+			SkinnedVertex& vertex = vertices[i];
+			vertex.Position = glm::vec3(distribution(random), distribution(random), distribution(random)) * 2.0f - 1.0f;
+			vertex.Normal = glm::normalize(vertex.Position + glm::vec3(0.0f, 0.0f, 0.1f));
+
+			int numInfluences = 1;
+			for (float share = INFLUENCE_SHARES[0], roll = distribution(random); roll > share && numInfluences < 4; numInfluences++)
+				share += INFLUENCE_SHARES[numInfluences];
+
+			int firstJoint = (int)(i * numJoints / numVertices);
+			float totalWeight = 0.0f;
+			for (int influence = 0; influence < CpuSkinningSource::MAX_INFLUENCES; influence++)
+			{
+				bool isUsed = influence < numInfluences;
+				vertex.JointIds[influence] = isUsed ? (firstJoint + influence) % numJoints : -1;
+				vertex.Weights[influence] = isUsed ? 0.1f + distribution(random) : 0.0f;
+				totalWeight += vertex.Weights[influence];
+			}
+			for (float& weight : vertex.Weights)
+				weight /= totalWeight;
+		}
+		return vertices;
+	}
+
+	CpuSkinningSource GetSkinningSource(const std::vector<SkinnedVertex>& vertices)
+	{
+		CpuSkinningSource source;
+		source.Positions = &vertices[0].Position;
+		source.Normals = &vertices[0].Normal;
+		source.JointIds = vertices[0].JointIds;
+		source.Weights = vertices[0].Weights;
+		source.NumVertices = vertices.size();
+		source.Stride = sizeof(SkinnedVertex);
+		return source;
+	}
+
+#ifdef ANIMATION_WITH_ASSIMP
+	std::string GetBossAssetPath(const std::string& fileName)
+	{
+		return std::string(ANIMATION_ASSET_DIR) + "/models/boss/" + fileName;
+	}
+
+	std::vector<std::unique_ptr<AnimationClip>> LoadBossClips(const std::shared_ptr<JointDirectory>& jointDirectory)
+	{
+		std::vector<std::unique_ptr<AnimationClip>> clips;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(GetBossAssetPath("")))
+		{
+			if (entry.path().extension() == ".fbx" && entry.path().filename() != "The Boss.fbx")
+				clips.push_back(std::make_unique<AnimationClip>(entry.path().generic_string(), jointDirectory, false, true));
+		}
+		std::sort(clips.begin(), clips.end(), [](const auto& a, const auto& b) { return a->GetName() < b->GetName(); });
+		return clips;
+	}
+
+	void BindAllNodesAsJoints(JointDirectory& jointDirectory)
+	{
+		const std::vector<FlatSkeletonNode>& nodes = jointDirectory.GetFlatNodes();
+		std::vector<glm::mat4> bindTransforms(nodes.size());
+		for (size_t i = 0; i < nodes.size(); i++)
+		{
+			glm::mat4 localTransform = glm::translate(glm::mat4(1.0f), nodes[i].Translation)
+				* glm::mat4_cast(nodes[i].Rotation)
+				* glm::scale(glm::mat4(1.0f), nodes[i].Scale);
+			bindTransforms[i] = nodes[i].ParentIndex >= 0 ? bindTransforms[nodes[i].ParentIndex] * localTransform : localTransform;
+			jointDirectory.AppendJoint(nodes[i].Name, glm::inverse(bindTransforms[i]));
+		}
+	}
+#endif
+}
\ No newline at end of file
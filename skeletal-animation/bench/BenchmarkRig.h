@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Animation/CpuSkinning.h"
+#include "Animation/SyntheticRigHelper.h"
+
+//! Shorthands for the skeletons and clips the benchmarks use (see SyntheticRigHelper for more control over their shape)
+namespace BenchmarkRig
+{
+	//! Tree of numJoints joints in which every joint has up to `branching` children
+	std::shared_ptr<JointDirectory> CreateSkeleton(int numJoints, int branching = 3);
+
+	//! Clip animating every joint of the skeleton, with numKeys keys per channel over one second
+	std::unique_ptr<AnimationClip> CreateClip(const JointDirectory& skeleton, int numKeys);
+
+	//! Skinning inputs of a mesh vertex, laid out like the demo's Vertex without its texture coordinates and tangents
+	struct SkinnedVertex
+	{
+		glm::vec3 Position;
+		glm::vec3 Normal;
+		int JointIds[CpuSkinningSource::MAX_INFLUENCES];
+		float Weights[CpuSkinningSource::MAX_INFLUENCES];
+	};
+
+	//! Vertices bound to 1 to 4 of numJoints joints, mostly fewer, as on a typical character. Neighbouring vertices
+	//! share joints, like neighbouring parts of a mesh do.
+	std::vector<SkinnedVertex> CreateSkinnedVertices(int numJoints, size_t numVertices);
+
+	CpuSkinningSource GetSkinningSource(const std::vector<SkinnedVertex>& vertices);
+
+#ifdef ANIMATION_WITH_ASSIMP
+	//! Path of a file in assets/models/boss
+	std::string GetBossAssetPath(const std::string& fileName);
+
+	//! Every clip in assets/models/boss (everything but the model itself), in local time and sorted by name
+	std::vector<std::unique_ptr<AnimationClip>> LoadBossClips(const std::shared_ptr<JointDirectory>& jointDirectory);
+
+	//! Binds every skeleton node loaded from the boss clips as a joint, since headless runs don't load the mesh
+	//! that would normally register them
+	void BindAllNodesAsJoints(JointDirectory& jointDirectory);
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+
+static int OpenCounter(uint32_t type, uint64_t config)
+{
+	perf_event_attr attributes;
+	std::memset(&attributes, 0, sizeof(attributes));
+	attributes.size = sizeof(attributes);
+	attributes.type = type;
+	attributes.config = config;
+	attributes.disabled = 1;
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+
+	// This thread only, on whichever CPU it runs
+	return (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+
+PerfCounters::PerfCounters()
+{
+	const uint64_t l1DataReadMisses = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+		| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+	m_FileDescriptors[0] = OpenCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+	m_FileDescriptors[1] = OpenCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
+	m_FileDescriptors[2] = OpenCounter(PERF_TYPE_HW_CACHE, l1DataReadMisses);
+
+	m_IsAvailable = true;
+	for (int fileDescriptor : m_FileDescriptors)
+		m_IsAvailable &= fileDescriptor >= 0;
+}
+
+PerfCounters::~PerfCounters()
+{
+	for (int fileDescriptor : m_FileDescriptors)
+	{
+		if (fileDescriptor >= 0)
+			close(fileDescriptor);
+	}
+}
+
+void PerfCounters::Start()
+{
+	if (!m_IsAvailable)
+		return;
+
+	for (int fileDescriptor : m_FileDescriptors)
+	{
+		ioctl(fileDescriptor, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fileDescriptor, PERF_EVENT_IOC_ENABLE, 0);
+	}
+}
+
+void PerfCounters::Stop()
+{
+	if (!m_IsAvailable)
+		return;
+
+	uint64_t values[NUM_COUNTERS] = {};
+	for (int i = 0; i < NUM_COUNTERS; i++)
+	{
+		ioctl(m_FileDescriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+		if (read(m_FileDescriptors[i], &values[i], sizeof(values[i])) != sizeof(values[i]))
+			values[i] = 0;
+	}
+
+	m_Counts.CacheMisses += values[0];
+	m_Counts.CacheReferences += values[1];
+	m_Counts.L1DataMisses += values[2];
+}
+#else
+PerfCounters::PerfCounters()
+{
+	for (int& fileDescriptor : m_FileDescriptors)
+		fileDescriptor = -1;
+}
+
+PerfCounters::~PerfCounters() {}
+void PerfCounters::Start() {}
+void PerfCounters::Stop() {}
+#endif
\ No newline at end of file
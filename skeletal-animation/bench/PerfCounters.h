@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+//! Hardware cache counters for the calling thread, read through perf_event_open on Linux. Elsewhere, or where the
+//! kernel doesn't allow it (e.g. perf_event_paranoid is too high, or in some containers), IsAvailable is false
+//! and every count stays 0.
+class PerfCounters
+{
+public:
+	struct Counts
+	{
+		//! Last level cache misses
+		uint64_t CacheMisses = 0;
+		uint64_t CacheReferences = 0;
+
+		//! Level 1 data cache read misses
+		uint64_t L1DataMisses = 0;
+	};
+
+	PerfCounters();
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	bool IsAvailable() const { return m_IsAvailable; }
+
+	//! Counting only happens between Start and Stop, adding to what was counted before
+	void Start();
+	void Stop();
+
+	const Counts& GetCounts() const { return m_Counts; }
+private:
+	static constexpr int NUM_COUNTERS = 3;
+
+	int m_FileDescriptors[NUM_COUNTERS];
+	bool m_IsAvailable = false;
+	Counts m_Counts;
+};
\ No newline at end of file
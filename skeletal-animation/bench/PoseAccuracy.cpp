@@ -0,0 +1,471 @@
+#include "PoseAccuracy.h"
+
+#include "BenchmarkRig.h"
+
+#include "Animation/BlendHelper.h"
+#include "Animation/FrameArena.h"
+#include "Animation/PaletteAtlas.h"
+#include "Animation/PaletteFormat.h"
+#include "Animation/PoseCache.h"
+#include "Animation/PoseHelper.h"
+#include "Animation/SyntheticRigHelper.h"
+
+#include <iomanip>
+
+#include <glm/gtc/constants.hpp>
+
+namespace PoseAccuracy
+{
+	//! Samples per clip tick, so we also land between key frames
+	static constexpr int SAMPLES_PER_TICK = 4;
+
+	//! Virtual vertices sit this far from their joint, as a fraction of the height of the skeleton
+	static constexpr float VIRTUAL_VERTEX_DISTANCE = 0.05f;
+
+	//! Fixed update rate the demo interpolates between (see Animator::SetFixedUpdateRate)
+	static constexpr float FIXED_UPDATE_RATE = 30.0f;
+
+	//! Pose produced from a clip at a time; both the reference and the candidate path of a Candidate are one of these
+	using SampleFunction = void (*)(AnimationClip& clip, float time, const EvaluationContext& context,
+									FrameArena& arena, PoseBuffer& pose);
+
+	struct Candidate
+	{
+		const char* Name;
+		SampleFunction Reference;
+		SampleFunction Sample;
+
+		//! Largest acceptable virtual vertex error, as a fraction of the height of the skeleton
+		float Tolerance;
+	};
+
+	struct ErrorStats
+	{
+		float MaxTranslation = 0.0f;
+		double TotalTranslation = 0.0;
+		float MaxRotation = 0.0f;
+		double TotalRotation = 0.0;
+		float MaxPosition = 0.0f;
+		double TotalPosition = 0.0;
+		float MaxVertex = 0.0f;
+		double TotalVertex = 0.0;
+		uint64_t NumSamples = 0;
+	};
+
+	//! Clips in local time are sampled in ticks, the others as a fraction of their duration
+	static float GetTimeRange(const AnimationClip& clip)
+	{
+		return clip.UsesLocalTime() ? clip.GetDuration() : 1.0f;
+	}
+
+	static void SampleClip(AnimationClip& clip, float time, const EvaluationContext& context, FrameArena&, PoseBuffer& pose)
+	{
+		clip.Evaluate(time, context, pose.GetView());
+	}
+
+	static void SampleReducedKeys(AnimationClip& clip, float time, const EvaluationContext& context, FrameArena&, PoseBuffer& pose)
+	{
+		AnimationLodTier lod = context.Lod;
+		lod.UseReducedKeys = true;
+		EvaluationContext reducedContext = { context.Skeleton, lod, context.Arena };
+		clip.Evaluate(time, reducedContext, pose.GetView());
+	}
+
+	//! Halfway between the poses of two consecutive fixed updates, which is what the Animator interpolates between
+	template <bool UseNlerp>
+	static void SampleFixedUpdateBlend(AnimationClip& clip, float time, const EvaluationContext& context, FrameArena& arena,
+									   PoseBuffer& pose)
+	{
+		float timeRange = GetTimeRange(clip);
+		float fixedTimeStep = clip.GetTicksPerSecond() / FIXED_UPDATE_RATE * timeRange / clip.GetDuration();
+
+		FrameArena::Scope scratchScope(arena);
+		PoseView source = PoseHelper::AllocatePose(arena, pose.Size());
+		PoseView target = PoseHelper::AllocatePose(arena, pose.Size());
+		clip.Evaluate(time, context, source);
+		clip.Evaluate(glm::min(time + fixedTimeStep, timeRange), context, target);
+
+		if (UseNlerp)
+			BlendHelper::NlerpPoses(pose.GetView(), source, target, 0.5f);
+		else
+			BlendHelper::BlendPoses(pose.GetView(), source, target, 0.5f);
+	}
+
+	//! What an Animator sharing a PoseCache with the default quantum shows: the pose at the start of its time bucket
+	static void SampleCachedBucket(AnimationClip& clip, float time, const EvaluationContext& context, FrameArena&, PoseBuffer& pose)
+	{
+		static const PoseCache s_PoseCache;
+		clip.Evaluate(s_PoseCache.GetBucketTime(clip, s_PoseCache.GetBucket(clip, time)), context, pose.GetView());
+	}
+
+	static const Candidate s_Candidates[] = {
+		// Only used by distant LOD tiers, where a few percent of the character's height isn't visible
+		{ "ReducedKeys", SampleClip, SampleReducedKeys, 0.05f },
+		{ "NlerpFixedStep", SampleFixedUpdateBlend<false>, SampleFixedUpdateBlend<true>, 0.001f },
+		// Lags up to a 1/30 s bucket behind. The generated clips swing every joint through a whole cycle each second,
+		// much faster than real motion, so this has to be loose for them.
+		{ "PoseCache", SampleClip, SampleCachedBucket, 0.2f },
+	};
+
+	//! Baked palettes only hold skinning matrices, so they're measured on their own: virtual vertices around each joint's
+	//! bind position are skinned by both the live palette and the atlas. There's no local pose, so the joint space
+	//! columns stay at 0.
+	struct PaletteCandidate
+	{
+		const char* Name;
+		bool UseHalfFloats;
+		float Tolerance;
+	};
+
+	static const PaletteCandidate s_PaletteCandidates[] = {
+		// Matrices are blended linearly between frames 1/30 s apart, rather than slerped key by key
+		{ "BakedPalette32", false, 0.02f },
+		{ "BakedPalette16", true, 0.02f },
+	};
+
+	//! Palette formats are measured the same way, each joint's matrix against the one its packed entry unpacks to
+	struct FormatCandidate
+	{
+		const char* Name;
+		PaletteFormat Format;
+		float Tolerance;
+	};
+
+	static const FormatCandidate s_FormatCandidates[] = {
+		{ "AffinePalette", PaletteFormat::Affine3x4, 0.0001f },
+		// Drops scale, which skinning matrices of rigs without scaled joints don't have
+		{ "DualQuatPalette", PaletteFormat::DualQuaternion, 0.001f },
+	};
+
+	//! Extracted root motion is measured by putting it back: the skinning matrices of a generated clip played in place
+	//! and moved by its RootMotionTrack, against those of the same clip generated without extraction
+	struct RootMotionCandidate
+	{
+		const char* Name;
+		float RootSpeed;
+		float RootTurnRate;
+		float RootTumbleRate;
+		glm::vec3 RootTumbleAxis;
+		float Tolerance;
+	};
+
+	static const RootMotionCandidate s_RootMotionCandidates[] = {
+		// The track is lerped between samples 1/30 s apart, while the keys it was taken out of are slerped
+		{ "RootMotion", 2.0f, 1.0f, 0.0f, glm::vec3(1.0f, 0.0f, 0.0f), 0.002f },
+		// Tumble a whole turn each second while turning, so the root's other axes point straight up on the way round.
+		// The heading has to switch axes as they do, and much faster than real clips turn.
+		{ "RootMotionPitch", 2.0f, 1.0f, glm::two_pi<float>(), glm::vec3(1.0f, 0.0f, 0.0f), 0.02f },
+		{ "RootMotionRoll", 2.0f, 1.0f, glm::two_pi<float>(), glm::vec3(0.0f, 0.0f, 1.0f), 0.02f },
+	};
+
+	static float GetRotationError(const glm::quat& a, const glm::quat& b)
+	{
+		float cosHalfAngle = glm::min(glm::abs(glm::dot(a, b)), 1.0f);
+		return 2.0f * glm::acos(cosHalfAngle);
+	}
+
+	static void AccumulateErrors(ErrorStats& stats, const PoseBuffer& reference, const PoseBuffer& sample,
+								 const std::vector<glm::mat4>& referenceTransforms, const std::vector<glm::mat4>& sampleTransforms,
+								 float vertexDistance)
+	{
+		for (size_t i = 0; i < reference.Size(); i++)
+		{
+			float translationError = glm::distance(reference.Translations[i], sample.Translations[i]);
+			float rotationError = GetRotationError(reference.Rotations[i], sample.Rotations[i]);
+			float positionError = glm::distance(glm::vec3(referenceTransforms[i][3]), glm::vec3(sampleTransforms[i][3]));
+
+			// Points around the joint show rotation errors that its position alone wouldn't
+			float vertexError = 0.0f;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				glm::vec4 vertex(0.0f, 0.0f, 0.0f, 1.0f);
+				vertex[axis] = vertexDistance;
+				vertexError = glm::max(vertexError, glm::distance(referenceTransforms[i] * vertex, sampleTransforms[i] * vertex));
+			}
+
+			stats.MaxTranslation = glm::max(stats.MaxTranslation, translationError);
+			stats.TotalTranslation += translationError;
+			stats.MaxRotation = glm::max(stats.MaxRotation, rotationError);
+			stats.TotalRotation += rotationError;
+			stats.MaxPosition = glm::max(stats.MaxPosition, positionError);
+			stats.TotalPosition += positionError;
+			stats.MaxVertex = glm::max(stats.MaxVertex, vertexError);
+			stats.TotalVertex += vertexError;
+			stats.NumSamples++;
+		}
+	}
+
+	//! Largest distance of any node from the root in the skeleton's default pose, so errors can be judged relative to it
+	static float GetSkeletonHeight(const JointDirectory& skeleton)
+	{
+		std::vector<glm::mat4> transforms;
+		PoseHelper::LocalToModel(skeleton.GetFlatNodes(), skeleton.GetDefaultPose(), transforms);
+
+		float height = 0.0f;
+		for (const glm::mat4& transform : transforms)
+			height = glm::max(height, glm::distance(glm::vec3(transform[3]), glm::vec3(transforms[0][3])));
+		return glm::max(height, 1e-6f);
+	}
+
+	static ErrorStats MeasureClip(const Candidate& candidate, AnimationClip& clip, const JointDirectory& skeleton, float vertexDistance)
+	{
+		static const AnimationLodTier fullDetail;
+		FrameArena arena;
+		EvaluationContext context = { skeleton, fullDetail, arena };
+
+		PoseBuffer reference = skeleton.GetDefaultPose();
+		PoseBuffer sample = skeleton.GetDefaultPose();
+		std::vector<glm::mat4> referenceTransforms;
+		std::vector<glm::mat4> sampleTransforms;
+
+		float timeRange = GetTimeRange(clip);
+		int numSamples = glm::max((int)(clip.GetDuration() * SAMPLES_PER_TICK), 2);
+
+		ErrorStats stats;
+		for (int i = 0; i < numSamples; i++)
+		{
+			float time = timeRange * i / (numSamples - 1);
+			candidate.Reference(clip, time, context, arena, reference);
+			candidate.Sample(clip, time, context, arena, sample);
+
+			PoseHelper::LocalToModel(skeleton.GetFlatNodes(), reference, referenceTransforms);
+			PoseHelper::LocalToModel(skeleton.GetFlatNodes(), sample, sampleTransforms);
+			AccumulateErrors(stats, reference, sample, referenceTransforms, sampleTransforms, vertexDistance);
+		}
+		return stats;
+	}
+
+	//! Skins virtual vertices around each joint's bind position by both palettes
+	static void AccumulatePaletteErrors(ErrorStats& stats, const std::vector<FlatSkeletonNode>& nodes,
+										const std::vector<glm::mat4>& referencePalette, const std::vector<glm::mat4>& samplePalette,
+										float vertexDistance)
+	{
+		for (const FlatSkeletonNode& node : nodes)
+		{
+			if (node.JointId < 0)
+				continue;
+
+			const glm::mat4& reference = referencePalette[node.JointId];
+			const glm::mat4& sample = samplePalette[node.JointId];
+			glm::vec4 bindPosition = glm::inverse(node.InverseBindPose)[3];
+			float positionError = glm::distance(reference * bindPosition, sample * bindPosition);
+
+			float vertexError = 0.0f;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				glm::vec4 vertex = bindPosition;
+				vertex[axis] += vertexDistance;
+				vertexError = glm::max(vertexError, glm::distance(reference * vertex, sample * vertex));
+			}
+
+			stats.MaxPosition = glm::max(stats.MaxPosition, positionError);
+			stats.TotalPosition += positionError;
+			stats.MaxVertex = glm::max(stats.MaxVertex, vertexError);
+			stats.TotalVertex += vertexError;
+			stats.NumSamples++;
+		}
+	}
+
+	static ErrorStats MeasureBakedPalette(const PaletteAtlas& atlas, int clipIndex, const JointDirectory& skeleton, float vertexDistance)
+	{
+		static const AnimationLodTier fullDetail;
+		FrameArena arena;
+		EvaluationContext context = { skeleton, fullDetail, arena };
+
+		const std::vector<FlatSkeletonNode>& nodes = skeleton.GetFlatNodes();
+		PoseBuffer pose = skeleton.GetDefaultPose();
+		std::vector<glm::mat4> modelSpaceTransforms;
+		std::vector<glm::mat4> referencePalette(atlas.GetNumJoints(), glm::mat4(1.0f));
+		std::vector<glm::mat4> bakedPalette(atlas.GetNumJoints());
+
+		// The atlas plays clips as loops, so the end of a clip is its start again
+		const PaletteAtlas::ClipInfo& info = atlas.GetClip(clipIndex);
+		int numSamples = glm::max((int)(info.Clip->GetDuration() * SAMPLES_PER_TICK), 2);
+
+		ErrorStats stats;
+		for (int i = 0; i < numSamples; i++)
+		{
+			float seconds = info.Duration * i / numSamples;
+			info.Clip->Evaluate(info.Clip->ToClipTime(seconds), context, pose.GetView());
+			PoseHelper::LocalToModel(nodes, pose, modelSpaceTransforms);
+			PoseHelper::BuildSkinningMatrices(nodes, modelSpaceTransforms, referencePalette);
+			atlas.SamplePalette(clipIndex, seconds, bakedPalette.data());
+
+			AccumulatePaletteErrors(stats, nodes, referencePalette, bakedPalette, vertexDistance);
+		}
+		return stats;
+	}
+
+	static ErrorStats MeasurePaletteFormat(PaletteFormat format, AnimationClip& clip, const JointDirectory& skeleton,
+										   float vertexDistance)
+	{
+		static const AnimationLodTier fullDetail;
+		FrameArena arena;
+		EvaluationContext context = { skeleton, fullDetail, arena };
+
+		const std::vector<FlatSkeletonNode>& nodes = skeleton.GetFlatNodes();
+		int numJoints = skeleton.GetNumJoints();
+		int floatsPerJoint = PaletteHelper::GetFloatsPerJoint(format);
+		PoseBuffer pose = skeleton.GetDefaultPose();
+		std::vector<glm::mat4> modelSpaceTransforms;
+		std::vector<glm::mat4> referencePalette(numJoints, glm::mat4(1.0f));
+		std::vector<glm::mat4> unpackedPalette(numJoints);
+		std::vector<float> palette((size_t)numJoints * floatsPerJoint);
+
+		float timeRange = GetTimeRange(clip);
+		int numSamples = glm::max((int)(clip.GetDuration() * SAMPLES_PER_TICK), 2);
+
+		ErrorStats stats;
+		for (int i = 0; i < numSamples; i++)
+		{
+			SampleClip(clip, timeRange * i / (numSamples - 1), context, arena, pose);
+			PoseHelper::LocalToModel(nodes, pose, modelSpaceTransforms);
+			PoseHelper::BuildSkinningMatrices(nodes, modelSpaceTransforms, referencePalette);
+
+			PaletteHelper::Pack(format, referencePalette.data(), numJoints, palette.data());
+			for (int joint = 0; joint < numJoints; joint++)
+				unpackedPalette[joint] = PaletteHelper::Unpack(format, &palette[(size_t)joint * floatsPerJoint]);
+
+			AccumulatePaletteErrors(stats, nodes, referencePalette, unpackedPalette, vertexDistance);
+		}
+		return stats;
+	}
+
+	static ErrorStats MeasureRootMotion(AnimationClip& inPlaceClip, AnimationClip& clip, const JointDirectory& skeleton,
+										float vertexDistance)
+	{
+		static const AnimationLodTier fullDetail;
+		FrameArena arena;
+		EvaluationContext context = { skeleton, fullDetail, arena };
+
+		const std::vector<FlatSkeletonNode>& nodes = skeleton.GetFlatNodes();
+		int numJoints = skeleton.GetNumJoints();
+		PoseBuffer pose = skeleton.GetDefaultPose();
+		std::vector<glm::mat4> modelSpaceTransforms;
+		std::vector<glm::mat4> referencePalette(numJoints, glm::mat4(1.0f));
+		std::vector<glm::mat4> samplePalette(numJoints, glm::mat4(1.0f));
+
+		float timeRange = GetTimeRange(clip);
+		int numSamples = glm::max((int)(clip.GetDuration() * SAMPLES_PER_TICK), 2);
+
+		ErrorStats stats;
+		for (int i = 0; i < numSamples; i++)
+		{
+			float time = timeRange * i / (numSamples - 1);
+			SampleClip(clip, time, context, arena, pose);
+			PoseHelper::LocalToModel(nodes, pose, modelSpaceTransforms);
+			PoseHelper::BuildSkinningMatrices(nodes, modelSpaceTransforms, referencePalette);
+
+			SampleClip(inPlaceClip, time, context, arena, pose);
+			PoseHelper::LocalToModel(nodes, pose, modelSpaceTransforms);
+			glm::mat4 rootMotion = inPlaceClip.GetRootMotion().GetTransform(time / timeRange * clip.GetDuration() / clip.GetTicksPerSecond());
+			for (glm::mat4& transform : modelSpaceTransforms)
+				transform = rootMotion * transform;
+			PoseHelper::BuildSkinningMatrices(nodes, modelSpaceTransforms, samplePalette);
+
+			AccumulatePaletteErrors(stats, nodes, referencePalette, samplePalette, vertexDistance);
+		}
+		return stats;
+	}
+
+	static bool WriteStats(std::ostream& stream, const char* candidateName, float tolerance, const std::string& clipName,
+						   const ErrorStats& stats, float skeletonHeight)
+	{
+		double numSamples = (double)glm::max(stats.NumSamples, (uint64_t)1);
+		bool isWithinTolerance = stats.MaxVertex <= tolerance * skeletonHeight;
+
+		stream << std::left << std::setw(16) << candidateName << std::setw(24) << clipName.substr(0, 23) << std::right
+			<< std::setprecision(4)
+			<< std::setw(11) << stats.MaxTranslation << std::setw(11) << stats.TotalTranslation / numSamples
+			<< std::setw(11) << glm::degrees(stats.MaxRotation) << std::setw(11) << glm::degrees(stats.TotalRotation / numSamples)
+			<< std::setw(11) << stats.MaxPosition << std::setw(11) << stats.TotalPosition / numSamples
+			<< std::setw(11) << stats.MaxVertex << std::setw(11) << stats.TotalVertex / numSamples
+			<< "  " << (isWithinTolerance ? "ok" : "FAILED") << "\n";
+		return isWithinTolerance;
+	}
+
+	bool Run(std::ostream& stream)
+	{
+		std::shared_ptr<JointDirectory> jointDirectory;
+		std::vector<std::unique_ptr<AnimationClip>> clips;
+
+#ifdef ANIMATION_WITH_ASSIMP
+		jointDirectory = std::make_shared<JointDirectory>();
+		clips = BenchmarkRig::LoadBossClips(jointDirectory);
+#else
+		stream << "Built without assimp, so measuring generated clips instead of the boss clips\n";
+		jointDirectory = BenchmarkRig::CreateSkeleton(65);
+		clips.push_back(BenchmarkRig::CreateClip(*jointDirectory, 30));
+		clips.push_back(BenchmarkRig::CreateClip(*jointDirectory, 120));
+#endif
+
+		float skeletonHeight = GetSkeletonHeight(*jointDirectory);
+		float vertexDistance = VIRTUAL_VERTEX_DISTANCE * skeletonHeight;
+		stream << "Skeleton height " << skeletonHeight << ", virtual vertices " << vertexDistance << " from their joint\n"
+			<< "Translation, position and vertex errors are in model units, rotations in degrees\n\n";
+
+		stream << std::left << std::setw(16) << "Candidate" << std::setw(24) << "Clip" << std::right
+			<< std::setw(11) << "Trans max" << std::setw(11) << "Trans mean"
+			<< std::setw(11) << "Rot max" << std::setw(11) << "Rot mean"
+			<< std::setw(11) << "Pos max" << std::setw(11) << "Pos mean"
+			<< std::setw(11) << "Vert max" << std::setw(11) << "Vert mean" << "\n";
+
+		bool isWithinTolerance = true;
+		for (const Candidate& candidate : s_Candidates)
+		{
+			for (const std::unique_ptr<AnimationClip>& clip : clips)
+			{
+				ErrorStats stats = MeasureClip(candidate, *clip, *jointDirectory, vertexDistance);
+				isWithinTolerance &= WriteStats(stream, candidate.Name, candidate.Tolerance, clip->GetName(), stats, skeletonHeight);
+			}
+		}
+
+		for (const PaletteCandidate& candidate : s_PaletteCandidates)
+		{
+			PaletteAtlas atlas;
+			for (const std::unique_ptr<AnimationClip>& clip : clips)
+				atlas.AddClip(clip.get());
+
+			PaletteAtlasSettings settings;
+			settings.UseHalfFloats = candidate.UseHalfFloats;
+			atlas.Build(*jointDirectory, settings);
+
+			for (int clipIndex = 0; clipIndex < atlas.GetNumClips(); clipIndex++)
+			{
+				ErrorStats stats = MeasureBakedPalette(atlas, clipIndex, *jointDirectory, vertexDistance);
+				isWithinTolerance &= WriteStats(stream, candidate.Name, candidate.Tolerance, atlas.GetClip(clipIndex).Clip->GetName(),
+												stats, skeletonHeight);
+			}
+		}
+
+		for (const FormatCandidate& candidate : s_FormatCandidates)
+		{
+			for (const std::unique_ptr<AnimationClip>& clip : clips)
+			{
+				ErrorStats stats = MeasurePaletteFormat(candidate.Format, *clip, *jointDirectory, vertexDistance);
+				isWithinTolerance &= WriteStats(stream, candidate.Name, candidate.Tolerance, clip->GetName(), stats, skeletonHeight);
+			}
+		}
+
+		// Generated in both builds, on a skeleton of their own
+		std::shared_ptr<JointDirectory> generatedSkeleton = BenchmarkRig::CreateSkeleton(65);
+		float generatedHeight = GetSkeletonHeight(*generatedSkeleton);
+		for (const RootMotionCandidate& candidate : s_RootMotionCandidates)
+		{
+			SyntheticClipSettings clipSettings;
+			clipSettings.RootSpeed = candidate.RootSpeed;
+			clipSettings.RootTurnRate = candidate.RootTurnRate;
+			clipSettings.RootTumbleRate = candidate.RootTumbleRate;
+			clipSettings.RootTumbleAxis = candidate.RootTumbleAxis;
+			std::unique_ptr<AnimationClip> clip = SyntheticRigHelper::CreateClip(*generatedSkeleton, clipSettings);
+			clipSettings.ShouldExtractRootMotion = true;
+			std::unique_ptr<AnimationClip> inPlaceClip = SyntheticRigHelper::CreateClip(*generatedSkeleton, clipSettings);
+
+			ErrorStats stats = MeasureRootMotion(*inPlaceClip, *clip, *generatedSkeleton, VIRTUAL_VERTEX_DISTANCE * generatedHeight);
+			isWithinTolerance &= WriteStats(stream, candidate.Name, candidate.Tolerance, clip->GetName(), stats, generatedHeight);
+		}
+
+		stream << "\n" << (isWithinTolerance ? "All candidates are within tolerance" : "Some candidates exceeded their tolerance") << std::endl;
+		return isWithinTolerance;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <ostream>
+
+//! Measures how far cheaper ways of producing poses (e.g. reduced keys, nlerp blending, baked palettes, packed palette formats) drift from the reference
+//! JointClip sampling and BlendHelper::BlendPoses. Every clip in assets/models/boss (or generated clips, without
+//! assimp) is sampled densely with both, and the joint space, model space and virtual vertex errors are reported.
+namespace PoseAccuracy
+{
+	//! Returns whether every candidate stayed within its tolerance, so it can be used as a gate
+	bool Run(std::ostream& stream);
+}
\ No newline at end of file
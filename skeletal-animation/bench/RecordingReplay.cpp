@@ -0,0 +1,164 @@
+#include "RecordingReplay.h"
+
+#include "BenchmarkRig.h"
+
+#include "Animation/AnimationRecording.h"
+#include "Animation/AnimationReplayer.h"
+#include "Animation/Animator.h"
+#include "Animation/Profiler.h"
+
+#ifdef ANIMATION_WITH_ASSIMP
+	#include "BossCharacter.h"
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace RecordingReplay
+{
+#ifdef ANIMATION_WITH_ASSIMP
+	//! Largest difference in any skinning matrix element that still counts as the same pose
+	static constexpr float POSE_TOLERANCE = 1e-4f;
+
+	//! Per frame: the number of matrices, then the matrices themselves
+	static void WritePoses(std::ofstream& stream, const std::vector<glm::mat4>& skinningMatrices, int numJoints)
+	{
+		uint32_t numMatrices = (uint32_t)numJoints;
+		stream.write(reinterpret_cast<const char*>(&numMatrices), sizeof(numMatrices));
+		stream.write(reinterpret_cast<const char*>(skinningMatrices.data()), numMatrices * sizeof(glm::mat4));
+	}
+
+	//! Largest element-wise difference from the next frame of the reference file, or a negative number if it has no such frame
+	static float ComparePoses(std::ifstream& stream, const std::vector<glm::mat4>& skinningMatrices, int numJoints,
+							  std::vector<glm::mat4>& referenceMatrices)
+	{
+		uint32_t numMatrices;
+		if (!stream.read(reinterpret_cast<char*>(&numMatrices), sizeof(numMatrices)) || numMatrices != (uint32_t)numJoints)
+			return -1.0f;
+
+		referenceMatrices.resize(numMatrices);
+		if (!stream.read(reinterpret_cast<char*>(referenceMatrices.data()), numMatrices * sizeof(glm::mat4)))
+			return -1.0f;
+
+		float maxDifference = 0.0f;
+		for (uint32_t i = 0; i < numMatrices; i++)
+		{
+			for (int column = 0; column < 4; column++)
+			{
+				glm::vec4 difference = glm::abs(skinningMatrices[i][column] - referenceMatrices[i][column]);
+				maxDifference = std::max(maxDifference, glm::max(glm::max(difference.x, difference.y), glm::max(difference.z, difference.w)));
+			}
+		}
+		return maxDifference;
+	}
+#endif
+
+	bool Run(const Options& options, std::ostream& stream)
+	{
+#ifndef ANIMATION_WITH_ASSIMP
+		(void)options;
+		stream << "Replaying needs the boss clips, so the benchmarks have to be built with assimp" << std::endl;
+		return false;
+#else
+		AnimationRecording recording;
+		if (!recording.Load(options.RecordingPath))
+		{
+			stream << "Failed to load recording " << options.RecordingPath << std::endl;
+			return false;
+		}
+
+		std::shared_ptr<JointDirectory> jointDirectory = std::make_shared<JointDirectory>();
+		BossCharacter boss(ANIMATION_ASSET_DIR, jointDirectory);
+		BenchmarkRig::BindAllNodesAsJoints(*jointDirectory);
+
+		Animator animator;
+		boss.SetUpAnimator(animator);
+
+		std::ofstream posesOut;
+		if (options.PosesOutPath)
+			posesOut.open(options.PosesOutPath, std::ios::binary);
+
+		std::ifstream comparePoses;
+		if (options.ComparePosesPath)
+			comparePoses.open(options.ComparePosesPath, std::ios::binary);
+
+		if ((options.PosesOutPath && !posesOut) || (options.ComparePosesPath && !comparePoses))
+		{
+			stream << "Failed to open pose file" << std::endl;
+			return false;
+		}
+
+#ifdef S_ENABLE_PROFILER
+		Profiler::BeginSession();
+#endif
+
+		AnimationReplayer replayer(recording, animator);
+		std::vector<double> frameMilliseconds;
+		frameMilliseconds.reserve(recording.GetNumFrames() + 1);
+
+		std::vector<glm::mat4> referenceMatrices;
+		float maxDifference = 0.0f;
+		int firstMismatchFrame = -1;
+		bool hasReferenceEnded = false;
+
+		while (replayer.ReplayFrame())
+		{
+			frameMilliseconds.push_back(replayer.GetUpdateMilliseconds());
+
+			const std::vector<glm::mat4>& skinningMatrices = animator.GetSkinningMatrices();
+			if (posesOut)
+				WritePoses(posesOut, skinningMatrices, jointDirectory->GetNumJoints());
+
+			if (comparePoses && !hasReferenceEnded)
+			{
+				float difference = ComparePoses(comparePoses, skinningMatrices, jointDirectory->GetNumJoints(), referenceMatrices);
+				hasReferenceEnded = difference < 0.0f;
+				maxDifference = std::max(maxDifference, difference);
+				if (firstMismatchFrame < 0 && (hasReferenceEnded || difference > POSE_TOLERANCE))
+					firstMismatchFrame = (int)replayer.GetNumFramesPlayed() - 1;
+			}
+		}
+
+#ifdef S_ENABLE_PROFILER
+		Profiler::EndSession();
+		Profiler::WriteFrameSummary(stream);
+#endif
+
+		double totalMilliseconds = 0.0;
+		for (double milliseconds : frameMilliseconds)
+			totalMilliseconds += milliseconds;
+
+		std::vector<double> sortedMilliseconds = frameMilliseconds;
+		std::sort(sortedMilliseconds.begin(), sortedMilliseconds.end());
+		auto percentile = [&sortedMilliseconds](double fraction)
+		{
+			return sortedMilliseconds.empty() ? 0.0 : sortedMilliseconds[(size_t)(fraction * (sortedMilliseconds.size() - 1))];
+		};
+
+		stream << "Replayed " << replayer.GetNumFramesPlayed() << " frames of " << options.RecordingPath << "\n"
+			<< "Animator update ms: total " << totalMilliseconds
+			<< ", average " << (frameMilliseconds.empty() ? 0.0 : totalMilliseconds / frameMilliseconds.size())
+			<< ", median " << percentile(0.5) << ", 99th percentile " << percentile(0.99)
+			<< ", max " << percentile(1.0) << "\n";
+
+		if (!comparePoses)
+			return true;
+
+		// The reference shouldn't have any frames left over either
+		uint32_t numLeftOverMatrices;
+		if (!hasReferenceEnded && comparePoses.read(reinterpret_cast<char*>(&numLeftOverMatrices), sizeof(numLeftOverMatrices)))
+		{
+			if (firstMismatchFrame < 0)
+				firstMismatchFrame = (int)replayer.GetNumFramesPlayed();
+		}
+
+		stream << "Largest difference from " << options.ComparePosesPath << ": " << maxDifference << "\n";
+		if (firstMismatchFrame >= 0)
+			stream << "Poses differ from frame " << firstMismatchFrame << " on" << std::endl;
+		else
+			stream << "Poses match" << std::endl;
+		return firstMismatchFrame < 0;
+#endif
+	}
+}
\ No newline at end of file
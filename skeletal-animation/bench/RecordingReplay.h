@@ -0,0 +1,22 @@
+#pragma once
+
+#include <ostream>
+
+//! Plays a recording made with the demo's --record back through the boss graph without a window, timing every
+//! frame, so performance can be compared between runs and runtime versions on exactly the same input.
+namespace RecordingReplay
+{
+	struct Options
+	{
+		const char* RecordingPath = nullptr;
+
+		//! Where to write the skinning matrices of every frame, if anywhere
+		const char* PosesOutPath = nullptr;
+
+		//! Poses written by an earlier replay (e.g. by a previous version of the runtime) to compare against
+		const char* ComparePosesPath = nullptr;
+	};
+
+	//! Returns whether the recording could be replayed and, if there were poses to compare against, whether they matched
+	bool Run(const Options& options, std::ostream& stream);
+}
\ No newline at end of file
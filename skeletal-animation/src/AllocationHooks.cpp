@@ -0,0 +1,82 @@
+// Replaces the global operator new/delete so AllocationTracker can count every heap allocation,
+// including those made by standard containers. Compile this into an executable (not a library) to enable tracking.
+
+#include "Animation/AllocationTracker.h"
+
+#include <cstdlib>
+#include <new>
+
+static void* Allocate(size_t size)
+{
+	AllocationTracker::OnAllocation(size);
+	return std::malloc(size ? size : 1);
+}
+
+static void* AllocateAligned(size_t size, std::align_val_t alignment)
+{
+	AllocationTracker::OnAllocation(size);
+#if defined(_MSC_VER)
+	return _aligned_malloc(size ? size : 1, (size_t)alignment);
+#else
+	// aligned_alloc wants the size to be a multiple of the alignment
+	size_t alignedSize = (size + (size_t)alignment - 1) / (size_t)alignment * (size_t)alignment;
+	return std::aligned_alloc((size_t)alignment, alignedSize ? alignedSize : (size_t)alignment);
+#endif
+}
+
+static void FreeAligned(void* pointer)
+{
+#if defined(_MSC_VER)
+	_aligned_free(pointer);
+#else
+	std::free(pointer);
+#endif
+}
+
+static struct AllocationHooksInstaller
+{
+	AllocationHooksInstaller() { AllocationTracker::SetInstalled(); }
+} s_AllocationHooksInstaller;
+
+void* operator new(size_t size)
+{
+	if (void* pointer = Allocate(size))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return Allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return Allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (void* pointer = AllocateAligned(size, alignment))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { FreeAligned(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { FreeAligned(pointer); }
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "AllocationTracker.h"
+
+#include "Core.h"
+
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+
+namespace AllocationTracker
+{
+	//! Fixed size and lock free, since it's updated from inside operator new
+	struct SubsystemCounters
+	{
+		std::atomic<const char*> Name{ nullptr };
+		std::atomic<uint64_t> NumAllocations{ 0 };
+		std::atomic<uint64_t> NumBytes{ 0 };
+		std::atomic<uint64_t> NumForbiddenAllocations{ 0 };
+	};
+
+	static const char* UNATTRIBUTED_SUBSYSTEM = "Other";
+
+	static SubsystemCounters s_Subsystems[MAX_SUBSYSTEMS];
+	static std::atomic<bool> s_IsInstalled{ false };
+	static std::atomic<bool> s_ShouldBreakOnForbiddenAllocation{ false };
+
+	static thread_local const char* t_Subsystem = nullptr;
+	static thread_local bool t_AreAllocationsForbidden = false;
+
+	static SubsystemCounters& GetCounters(const char* name)
+	{
+		for (SubsystemCounters& counters : s_Subsystems)
+		{
+			const char* slotName = counters.Name.load(std::memory_order_acquire);
+			if (!slotName)
+			{
+				// Claim the free slot, unless another thread just did
+				if (counters.Name.compare_exchange_strong(slotName, name, std::memory_order_acq_rel))
+					return counters;
+			}
+			if (slotName == name || std::strcmp(slotName, name) == 0)
+				return counters;
+		}
+
+		// Out of slots; lump the rest in with the last one rather than lose them
+		return s_Subsystems[MAX_SUBSYSTEMS - 1];
+	}
+
+	void OnAllocation(size_t size)
+	{
+		SubsystemCounters& counters = GetCounters(t_Subsystem ? t_Subsystem : UNATTRIBUTED_SUBSYSTEM);
+		counters.NumAllocations.fetch_add(1, std::memory_order_relaxed);
+		counters.NumBytes.fetch_add(size, std::memory_order_relaxed);
+
+		if (t_AreAllocationsForbidden)
+		{
+			counters.NumForbiddenAllocations.fetch_add(1, std::memory_order_relaxed);
+			if (s_ShouldBreakOnForbiddenAllocation.load(std::memory_order_relaxed))
+				S_DEBUGBREAK();
+		}
+	}
+
+	bool IsInstalled()
+	{
+		return s_IsInstalled.load(std::memory_order_relaxed);
+	}
+
+	void SetInstalled()
+	{
+		s_IsInstalled = true;
+	}
+
+	uint64_t GetNumAllocations()
+	{
+		uint64_t numAllocations = 0;
+		for (const SubsystemCounters& counters : s_Subsystems)
+			numAllocations += counters.NumAllocations.load(std::memory_order_relaxed);
+		return numAllocations;
+	}
+
+	uint64_t GetNumForbiddenAllocations()
+	{
+		uint64_t numAllocations = 0;
+		for (const SubsystemCounters& counters : s_Subsystems)
+			numAllocations += counters.NumForbiddenAllocations.load(std::memory_order_relaxed);
+		return numAllocations;
+	}
+
+	size_t GetSubsystemStats(SubsystemStats* stats, size_t maxStats)
+	{
+		size_t numStats = 0;
+		for (const SubsystemCounters& counters : s_Subsystems)
+		{
+			const char* name = counters.Name.load(std::memory_order_acquire);
+			uint64_t numAllocations = counters.NumAllocations.load(std::memory_order_relaxed);
+			if (!name || numAllocations == 0 || numStats == maxStats)
+				continue;
+
+			stats[numStats++] = { name, numAllocations, counters.NumBytes.load(std::memory_order_relaxed),
+								  counters.NumForbiddenAllocations.load(std::memory_order_relaxed) };
+		}
+		return numStats;
+	}
+
+	void WriteReport(std::ostream& stream)
+	{
+		if (!IsInstalled())
+		{
+			stream << "Allocation tracking isn't installed in this executable\n";
+			return;
+		}
+
+		SubsystemStats stats[MAX_SUBSYSTEMS];
+		size_t numStats = GetSubsystemStats(stats, MAX_SUBSYSTEMS);
+
+		stream << std::left << std::setw(24) << "Subsystem" << std::right
+			<< std::setw(14) << "Allocations" << std::setw(14) << "Bytes" << std::setw(14) << "Forbidden" << "\n";
+		for (size_t i = 0; i < numStats; i++)
+		{
+			stream << std::left << std::setw(24) << stats[i].Name << std::right
+				<< std::setw(14) << stats[i].NumAllocations << std::setw(14) << stats[i].NumBytes
+				<< std::setw(14) << stats[i].NumForbiddenAllocations << "\n";
+		}
+	}
+
+	void Reset()
+	{
+		// Names stay registered, so stats of concurrently running threads don't end up in a different slot
+		for (SubsystemCounters& counters : s_Subsystems)
+		{
+			counters.NumAllocations = 0;
+			counters.NumBytes = 0;
+			counters.NumForbiddenAllocations = 0;
+		}
+	}
+
+	void SetBreakOnForbiddenAllocation(bool shouldBreak)
+	{
+		s_ShouldBreakOnForbiddenAllocation = shouldBreak;
+	}
+
+	SubsystemScope::SubsystemScope(const char* subsystem)
+		: m_PreviousSubsystem(t_Subsystem)
+	{
+		t_Subsystem = subsystem;
+	}
+
+	SubsystemScope::~SubsystemScope()
+	{
+		t_Subsystem = m_PreviousSubsystem;
+	}
+
+	ForbidAllocationsScope::ForbidAllocationsScope()
+		: m_WereForbidden(t_AreAllocationsForbidden)
+	{
+		t_AreAllocationsForbidden = true;
+	}
+
+	ForbidAllocationsScope::~ForbidAllocationsScope()
+	{
+		t_AreAllocationsForbidden = m_WereForbidden;
+	}
+}
\ No newline at end of file
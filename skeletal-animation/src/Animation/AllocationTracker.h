@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+//! Counts heap allocations and attributes them to whichever subsystem was running at the time.
+//! Counting only happens in executables that replace the global operator new with one that calls OnAllocation
+//! (see AllocationHooks.cpp); without it every count stays at zero.
+namespace AllocationTracker
+{
+	static constexpr size_t MAX_SUBSYSTEMS = 32;
+
+	struct SubsystemStats
+	{
+		const char* Name;
+		uint64_t NumAllocations;
+		uint64_t NumBytes;
+
+		//! Allocations made while allocations were forbidden (see ForbidAllocationsScope)
+		uint64_t NumForbiddenAllocations;
+	};
+
+	//! Called by the operator new replacement for every allocation
+	void OnAllocation(size_t size);
+
+	//! Whether the executable installed the operator new replacement
+	bool IsInstalled();
+	void SetInstalled();
+
+	//! Total counts since the last Reset
+	uint64_t GetNumAllocations();
+	uint64_t GetNumForbiddenAllocations();
+
+	//! Writes stats of every subsystem with at least one allocation, returning how many there were
+	size_t GetSubsystemStats(SubsystemStats* stats, size_t maxStats);
+	void WriteReport(std::ostream& stream);
+	void Reset();
+
+	//! Stop in the debugger on forbidden allocations, to find out where they come from
+	void SetBreakOnForbiddenAllocation(bool shouldBreak);
+
+	//! Allocations on this thread are attributed to the innermost subsystem scope.
+	//! Subsystem names must be string literals.
+	class SubsystemScope
+	{
+	public:
+		explicit SubsystemScope(const char* subsystem);
+		~SubsystemScope();
+
+		SubsystemScope(const SubsystemScope&) = delete;
+		SubsystemScope& operator=(const SubsystemScope&) = delete;
+	private:
+		const char* m_PreviousSubsystem;
+	};
+
+	//! Allocations on this thread are counted as forbidden while inside this scope,
+	//! e.g. around steady state animation updates that are meant to be allocation free
+	class ForbidAllocationsScope
+	{
+	public:
+		ForbidAllocationsScope();
+		~ForbidAllocationsScope();
+
+		ForbidAllocationsScope(const ForbidAllocationsScope&) = delete;
+		ForbidAllocationsScope& operator=(const ForbidAllocationsScope&) = delete;
+	private:
+		bool m_WereForbidden;
+	};
+}
+
+#define S_ALLOCATION_CONCAT_IMPL(a, b) a##b
+#define S_ALLOCATION_CONCAT(a, b) S_ALLOCATION_CONCAT_IMPL(a, b)
+
+#define S_ALLOCATION_SCOPE(subsystem) ::AllocationTracker::SubsystemScope S_ALLOCATION_CONCAT(allocationScope, __LINE__)(subsystem)
\ No newline at end of file
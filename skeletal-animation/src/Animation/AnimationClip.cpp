@@ -1,60 +1,235 @@
 #include "AnimationClip.h"
 
-#include "../Core.h"
-#include "../AssimpHelper.h"
+#include "Core.h"
+#include "AllocationTracker.h"
+#include "Profiler.h"
+#include "PoseHelper.h"
+#include "MemoryReport.h"
+#include "JointMask.h"
+#include "FrameArena.h"
 
-AnimationClip::AnimationClip(const std::string& filePath, const std::shared_ptr<JointDirectory>& jointDirectory,
-							 bool shouldFreezeTranslation, bool useLocalTime)
-	: m_ShouldFreezeTranslation(shouldFreezeTranslation), m_UsesLocalTime(useLocalTime), m_JointDirectory(jointDirectory)
+#include <algorithm>
+
+AnimationClip::AnimationClip(const std::string& name, float duration, float ticksPerSecond, std::vector<JointClip>&& jointClips,
+							 bool useLocalTime)
+	: m_Name(name), m_UsesLocalTime(useLocalTime), m_LocalDuration(duration),
+	  m_LocalTicksPerSecond(ticksPerSecond)
+{
+	for (const JointClip& jointClip : jointClips)
+		AddJointClip(jointClip);
+}
+
+void AnimationClip::Evaluate(float animationTime, const EvaluationContext& context, PoseView pose)
+{
+	S_PROFILE_SCOPE("AnimationClip::Evaluate");
+	S_ALLOCATION_SCOPE("Sampling");
+
+	S_ASSERT(IsBoundTo(context.Skeleton));
+
+	float localTime = ToLocalTime(animationTime);
+
+	// Nodes without a joint clip, detail joints at reduced LOD and nodes outside the mask keep their default transform
+	PoseHelper::CopyPose(pose, context.Skeleton.GetDefaultPose());
+
+	const std::vector<JointClip>& jointClips = context.Lod.UseReducedKeys ? m_ReducedJointClips : m_JointClips;
+	for (size_t i = 0; i < jointClips.size(); i++)
+	{
+		if (!ShouldSampleJoint(i, context))
+			continue;
+
+		int nodeIndex = m_NodeIndices[i];
+		LocalPose localPose = jointClips[i].Sample(localTime);
+		pose.Translations[nodeIndex] = localPose.Translation;
+		pose.Rotations[nodeIndex] = localPose.Rotation;
+		pose.Scales[nodeIndex] = localPose.Scale;
+	}
+}
+
+void AnimationClip::EvaluateBatch(const float* animationTimes, PoseView* poses, size_t count, const EvaluationContext& context)
 {
-	m_Name = filePath.substr(filePath.find_last_of('/') + 1);
-	std::cout << "Loaded animation: " << m_Name << std::endl;
+	S_PROFILE_SCOPE("AnimationClip::EvaluateBatch");
+	S_ALLOCATION_SCOPE("Sampling");
 
-	Assimp::Importer importer;
-	const aiScene* scene = importer.ReadFile(filePath, aiProcess_Triangulate);
-	S_ASSERT(scene && scene->mRootNode);
+	S_ASSERT(IsBoundTo(context.Skeleton));
 
-	// TODO: Let's not hardcode just grabbing the first animation
-	aiAnimation* animation = scene->mAnimations[0];
-	m_LocalDuration = animation->mDuration;
-	m_LocalTicksPerSecond = animation->mTicksPerSecond;
+	FrameArena::Scope scratchScope(context.Arena);
+	uint32_t* order = context.Arena.AllocateArray<uint32_t>(count);
+	float* sortedTimes = context.Arena.AllocateArray<float>(count);
+	LocalPose* localPoses = context.Arena.AllocateArray<LocalPose>(std::min(count, BATCH_CHUNK_SIZE));
 
-	m_JointDirectory->ParseRootNode(scene->mRootNode);
-	CreateJointClips(animation);
+	// In time order, neighbouring instances mostly land between the same keys
+	for (size_t i = 0; i < count; i++)
+		order[i] = (uint32_t)i;
+	std::sort(order, order + count, [animationTimes](uint32_t a, uint32_t b) { return animationTimes[a] < animationTimes[b]; });
+	for (size_t i = 0; i < count; i++)
+		sortedTimes[i] = ToLocalTime(animationTimes[order[i]]);
+
+	// Large crowds go in chunks, so the poses being written to stay in cache while every joint is sampled into them
+	const std::vector<JointClip>& jointClips = context.Lod.UseReducedKeys ? m_ReducedJointClips : m_JointClips;
+	for (size_t chunkStart = 0; chunkStart < count; chunkStart += BATCH_CHUNK_SIZE)
+	{
+		size_t chunkSize = std::min(count - chunkStart, BATCH_CHUNK_SIZE);
+		for (size_t j = chunkStart; j < chunkStart + chunkSize; j++)
+			PoseHelper::CopyPose(poses[order[j]], context.Skeleton.GetDefaultPose());
+
+		for (size_t i = 0; i < jointClips.size(); i++)
+		{
+			if (!ShouldSampleJoint(i, context))
+				continue;
+
+			jointClips[i].SampleSorted(sortedTimes + chunkStart, chunkSize, localPoses);
+
+			int nodeIndex = m_NodeIndices[i];
+			for (size_t j = 0; j < chunkSize; j++)
+			{
+				PoseView& pose = poses[order[chunkStart + j]];
+				pose.Translations[nodeIndex] = localPoses[j].Translation;
+				pose.Rotations[nodeIndex] = localPoses[j].Rotation;
+				pose.Scales[nodeIndex] = localPoses[j].Scale;
+			}
+		}
+	}
+}
+
+float AnimationClip::ToClipTime(float seconds) const
+{
+	float ticks = seconds * m_LocalTicksPerSecond;
+	return m_UsesLocalTime ? ticks : glm::clamp(ticks / m_LocalDuration, 0.0f, 1.0f);
 }
 
-void AnimationClip::UpdateLocalPoses(float animationTime)
+float AnimationClip::ToLocalTime(float animationTime) const
 {
-	float localTime;
 	if (m_UsesLocalTime)
+		return animationTime;
+
+	S_ASSERT(animationTime >= 0 && animationTime <= 1);
+	return animationTime * m_LocalDuration;
+}
+
+bool AnimationClip::ShouldSampleJoint(size_t jointClipIndex, const EvaluationContext& context) const
+{
+	int nodeIndex = m_NodeIndices[jointClipIndex];
+	if (nodeIndex < 0)
+		return false;
+	if (context.Lod.UseReducedJointSet && m_JointClips[jointClipIndex].IsDetailJoint())
+		return false;
+	return !context.Mask || context.Mask->Contains(nodeIndex);
+}
+
+void AnimationClip::AddJointClip(const JointClip& jointClip)
+{
+	m_JointClips.push_back(jointClip);
+	m_ReducedJointClips.push_back(jointClip.CreateReduced());
+}
+
+void AnimationClip::ExtractRootMotion(const JointDirectory& skeleton)
+{
+	S_PROFILE_SCOPE("AnimationClip::ExtractRootMotion");
+
+	const std::vector<FlatSkeletonNode>& nodes = skeleton.GetFlatNodes();
+	std::vector<int> depths(nodes.size());
+	for (size_t i = 0; i < nodes.size(); i++)
+		depths[i] = nodes[i].ParentIndex >= 0 ? depths[nodes[i].ParentIndex] + 1 : 0;
+
+	// The animated joint closest to the top of the hierarchy carries the whole character, and its ancestors don't move
+	int rootClipIndex = -1;
+	int rootNodeIndex = -1;
+	for (size_t i = 0; i < m_JointClips.size(); i++)
 	{
-		localTime = animationTime;
+		int nodeIndex = skeleton.GetFlatNodeIndex(m_JointClips[i].GetName());
+		if (nodeIndex >= 0 && (rootNodeIndex < 0 || depths[nodeIndex] < depths[rootNodeIndex]))
+		{
+			rootClipIndex = (int)i;
+			rootNodeIndex = nodeIndex;
+		}
 	}
-	else
+	if (rootClipIndex < 0)
+		return;
+
+	std::vector<glm::mat4> defaultTransforms;
+	PoseHelper::LocalToModel(nodes, skeleton.GetDefaultPose(), defaultTransforms);
+	int parentIndex = nodes[rootNodeIndex].ParentIndex;
+	glm::mat4 parentTransform = parentIndex >= 0 ? defaultTransforms[parentIndex] : glm::mat4(1.0f);
+
+	JointClip& rootClip = m_JointClips[rootClipIndex];
+	m_RootMotion = RootMotionTrack::Extract(rootClip, parentTransform, m_LocalDuration, m_LocalTicksPerSecond);
+	rootClip.RemoveRootMotion(m_RootMotion, parentTransform, m_LocalTicksPerSecond);
+	m_ReducedJointClips[rootClipIndex] = rootClip.CreateReduced();
+	MeasureJointReach(skeleton);
+}
+
+void AnimationClip::FreezeForwardTranslation()
+{
+	// Translations only get shorter, so the measured joint reach still holds
+	for (JointClip& jointClip : m_JointClips)
+		jointClip.FreezeForwardTranslation();
+	for (JointClip& jointClip : m_ReducedJointClips)
+		jointClip.FreezeForwardTranslation();
+}
+
+void AnimationClip::BindSkeleton(const JointDirectory& skeleton)
+{
+	m_BoundSkeleton = &skeleton;
+	m_NumBoundNodes = skeleton.GetFlatNodes().size();
+
+	m_NodeIndices.resize(m_JointClips.size());
+	for (size_t i = 0; i < m_JointClips.size(); i++)
+		m_NodeIndices[i] = skeleton.GetFlatNodeIndex(m_JointClips[i].GetName());
+
+	MeasureJointReach(skeleton);
+}
+
+void AnimationClip::MeasureJointReach(const JointDirectory& skeleton)
+{
+	const std::vector<FlatSkeletonNode>& nodes = skeleton.GetFlatNodes();
+	std::vector<glm::mat4> defaultTransforms;
+	PoseHelper::LocalToModel(nodes, skeleton.GetDefaultPose(), defaultTransforms);
+
+	// How much longer each joint's offset from its parent can get, in model space
+	std::vector<float> growths(nodes.size(), 0.0f);
+	for (const JointClip& jointClip : m_JointClips)
 	{
-		S_ASSERT(animationTime >= 0 && animationTime <= 1);
-		localTime = animationTime * m_LocalDuration;
+		int nodeIndex = skeleton.GetFlatNodeIndex(jointClip.GetName());
+		if (nodeIndex < 0)
+			continue;
+
+		float parentScale = 1.0f;
+		int parentIndex = nodes[nodeIndex].ParentIndex;
+		if (parentIndex >= 0)
+		{
+			const glm::mat4& parentTransform = defaultTransforms[parentIndex];
+			parentScale = glm::max(glm::length(glm::vec3(parentTransform[0])),
+								   glm::max(glm::length(glm::vec3(parentTransform[1])), glm::length(glm::vec3(parentTransform[2]))));
+		}
+
+		float growth = jointClip.GetMaxTranslationLength() - glm::length(nodes[nodeIndex].Translation);
+		growths[nodeIndex] = glm::max(growth, 0.0f) * parentScale;
 	}
 
-	for (auto& [name, jointClip] : m_JointClips)
+	// A joint is moved by its own growth and all of its ancestors'. Parents come before their children.
+	m_ExtraJointReach = 0.0f;
+	for (size_t i = 0; i < nodes.size(); i++)
 	{
-		jointClip.Update(localTime);
-		m_LocalPoses[name] = jointClip.GetLocalPose();
+		if (nodes[i].ParentIndex >= 0)
+			growths[i] += growths[nodes[i].ParentIndex];
+		m_ExtraJointReach = glm::max(m_ExtraJointReach, growths[i]);
 	}
 }
 
-void AnimationClip::CreateJointClips(const aiAnimation* animation)
+bool AnimationClip::IsBoundTo(const JointDirectory& skeleton) const
 {
-	// Note: There may be joints here that were not present when we parsed the mesh
-	// i.e. joints that are not bound to vertices, but which still move and affect
-	// the transforms of their child joints
-	for (uint32_t i = 0; i < animation->mNumChannels; i++)
-	{
-		aiNodeAnim* channel = animation->mChannels[i];
+	return m_BoundSkeleton == &skeleton && m_NumBoundNodes == skeleton.GetFlatNodes().size();
+}
 
-		std::string jointName = std::string(channel->mNodeName.C_Str());
+void AnimationClip::ReportMemory(MemoryReport& report) const
+{
+	size_t bytes = sizeof(*this) + MemoryHelper::GetStringBytes(m_Name) + MemoryHelper::GetVectorBytes(m_NodeIndices)
+		+ MemoryHelper::GetVectorBytes(m_JointClips) + MemoryHelper::GetVectorBytes(m_ReducedJointClips)
+		+ m_RootMotion.GetMemoryUsage();
+	for (const JointClip& jointClip : m_JointClips)
+		bytes += jointClip.GetMemoryUsage();
+	for (const JointClip& jointClip : m_ReducedJointClips)
+		bytes += jointClip.GetMemoryUsage();
 
-		JointClip jointClip(jointName, channel, m_ShouldFreezeTranslation);
-		m_JointClips.emplace(jointName, jointClip);
-	}
+	report.Add("Clips", m_Name, bytes);
 }
\ No newline at end of file
@@ -1,32 +1,102 @@
 #pragma once
 
+#include <memory>
+
 #include "AnimationNode.h"
 #include "JointClip.h"
+#include "JointDirectory.h"
+#include "RootMotionTrack.h"
 
-#include "../Model.h"
+struct aiAnimation;
+class MemoryReport;
 
 class AnimationClip : public AnimationNode
 {
 public:
+	//! Defined in AssimpImport.cpp. See ExtractRootMotion for shouldExtractRootMotion.
 	AnimationClip(const std::string& filePath, const std::shared_ptr<JointDirectory>& jointDirectory,
-				  bool shouldFreezeTranslation = false, bool useLocalTime = false);
+				  bool shouldExtractRootMotion = false, bool useLocalTime = false);
+
+	//! For clips that don't come from a file (e.g. generated for tests and benchmarks)
+	AnimationClip(const std::string& name, float duration, float ticksPerSecond, std::vector<JointClip>&& jointClips,
+				  bool useLocalTime = false);
+
+	void Evaluate(float animationTime, const EvaluationContext& context, PoseView pose) override;
 
-	void UpdateLocalPoses(float animationTime) override;
-	const std::unordered_map<std::string, LocalPose>& GetLocalPoses() const override { return m_LocalPoses; }
+	//! Evaluates the clip for many characters at once (e.g. a crowd playing the same walk out of step): poses[i] gets
+	//! the pose at animationTimes[i], exactly as Evaluate would. The times are sorted so each joint's keys are walked
+	//! once for the whole batch, joint by joint, rather than searched again for every character.
+	void EvaluateBatch(const float* animationTimes, PoseView* poses, size_t count, const EvaluationContext& context);
 
 	float GetTicksPerSecond() const override { return m_LocalTicksPerSecond; }
 	float GetDuration() const override { return m_LocalDuration; }
+	float GetExtraJointReach() const override { return m_ExtraJointReach; }
+
+	const std::string& GetName() const { return m_Name; }
+
+	//! Whether Evaluate takes the time in ticks, rather than as a fraction of the duration
+	bool UsesLocalTime() const { return m_UsesLocalTime; }
+
+	//! Time in seconds since the start of the clip, in the units Evaluate takes
+	float ToClipTime(float seconds) const;
+
+	//! Moves the travel and turning of the clip's topmost animated joint (the hips, in Mixamo rigs) out of its poses and
+	//! into a RootMotionTrack, so the pose plays in place and gameplay can move the character by GetRootMotion instead
+	void ExtractRootMotion(const JointDirectory& skeleton);
+
+	//! Looks up which skeleton node each joint clip animates, so sampling doesn't need to look up names. Clips loaded
+	//! from a file are bound to their skeleton already; generated ones are bound by whoever generates them. Evaluate
+	//! only reads the binding, so one clip can be evaluated on many threads at once, but only for that skeleton.
+	void BindSkeleton(const JointDirectory& skeleton);
+
+	//! Whether the clip was bound to this skeleton, and the skeleton hasn't changed since
+	bool IsBoundTo(const JointDirectory& skeleton) const;
+
+	//! Zeroes the local Z of every joint's translation, which keeps Mixamo hips from travelling forward, so e.g. a walk
+	//! plays in place. Unlike ExtractRootMotion the travel is dropped rather than kept in a track, for characters
+	//! nothing applies root motion to yet.
+	void FreezeForwardTranslation();
+
+	bool HasRootMotion() const { return !m_RootMotion.IsEmpty(); }
+	const RootMotionTrack& GetRootMotion() const { return m_RootMotion; }
+
+	//! Adds this clip to the report's "Clips"
+	void ReportMemory(MemoryReport& report) const;
 private:
 	void CreateJointClips(const aiAnimation* animation);
+	void AddJointClip(const JointClip& jointClip);
+
+	//! Sets m_ExtraJointReach from how far the joint clips translate joints beyond their default offsets
+	void MeasureJointReach(const JointDirectory& skeleton);
+
+	//! Time in ticks of the clip, from the time Evaluate takes
+	float ToLocalTime(float animationTime) const;
+
+	//! Whether the joint clip should be sampled into the pose at the context's LOD and mask
+	bool ShouldSampleJoint(size_t jointClipIndex, const EvaluationContext& context) const;
 private:
+	//! Instances EvaluateBatch samples every joint for before moving on to the next ones
+	static constexpr size_t BATCH_CHUNK_SIZE = 64;
+
 	std::string m_Name;
-	bool m_ShouldFreezeTranslation;
 	bool m_UsesLocalTime;
 
-	std::unordered_map<std::string, JointClip> m_JointClips;
-	std::unordered_map<std::string, LocalPose> m_LocalPoses;
+	std::vector<JointClip> m_JointClips;
+
+	//! Same as m_JointClips but with fewer key frames, used by LOD tiers with UseReducedKeys
+	std::vector<JointClip> m_ReducedJointClips;
 	std::shared_ptr<JointDirectory> m_JointDirectory;
 
+	RootMotionTrack m_RootMotion;
+
+	//! Index into the bound skeleton's flat nodes for each entry of m_JointClips, -1 if it has no such node
+	const JointDirectory* m_BoundSkeleton = nullptr;
+	size_t m_NumBoundNodes = 0;
+	std::vector<int> m_NodeIndices;
+
+	//! See AnimationNode::GetExtraJointReach, for the bound skeleton
+	float m_ExtraJointReach = 0.0f;
+
 	//! The duration (in "ticks") the animation clip has been authored for
 	float m_LocalDuration;
 
@@ -0,0 +1,98 @@
+#include "AnimationLod.h"
+
+#include "Core.h"
+
+#include <glm/glm.hpp>
+
+AnimationLodSettings AnimationLodSettings::CreateDefault()
+{
+	AnimationLodSettings settings;
+
+	AnimationLodTier fullDetail;
+	fullDetail.MaxDistance = 20.0f;
+	settings.AddTier(fullDetail);
+
+	AnimationLodTier medium;
+	medium.MaxDistance = 40.0f;
+	medium.UseReducedJointSet = true;
+	settings.AddTier(medium);
+
+	AnimationLodTier low;
+	low.MaxDistance = 80.0f;
+	low.UpdateInterval = 2;
+	low.UseReducedJointSet = true;
+	low.PruneBlendBranches = true;
+	low.UseReducedKeys = true;
+	settings.AddTier(low);
+
+	AnimationLodTier lowest;
+	lowest.UpdateInterval = 4;
+	lowest.UseReducedJointSet = true;
+	lowest.PruneBlendBranches = true;
+	lowest.UseReducedKeys = true;
+	settings.AddTier(lowest);
+
+	return settings;
+}
+
+void AnimationLodSettings::AddTier(const AnimationLodTier& tier)
+{
+	S_ASSERT(tier.UpdateInterval >= 1);
+	S_ASSERT(m_Tiers.empty() || tier.MaxDistance >= m_Tiers.back().MaxDistance);
+
+	m_Tiers.push_back(tier);
+	m_Stats.emplace_back();
+}
+
+int AnimationLodSettings::SelectTierByDistance(float distance) const
+{
+	S_ASSERT(!m_Tiers.empty());
+	for (int i = 0; i < GetNumTiers(); i++)
+	{
+		if (distance <= m_Tiers[i].MaxDistance)
+			return i;
+	}
+	return GetNumTiers() - 1;
+}
+
+int AnimationLodSettings::SelectTierByImportance(float importance) const
+{
+	S_ASSERT(!m_Tiers.empty());
+	importance = glm::clamp(importance, 0.0f, 1.0f);
+
+	int tier = (int)((1.0f - importance) * GetNumTiers());
+	return glm::min(tier, GetNumTiers() - 1);
+}
+
+const AnimationLodTier& AnimationLodSettings::GetTier(int index) const
+{
+	S_ASSERT(index >= 0 && index < GetNumTiers());
+	return m_Tiers[index];
+}
+
+AnimationLodStats& AnimationLodSettings::GetStats(int tierIndex)
+{
+	S_ASSERT(tierIndex >= 0 && tierIndex < GetNumTiers());
+	return m_Stats[tierIndex];
+}
+
+void AnimationLodSettings::ResetStats()
+{
+	for (AnimationLodStats& stats : m_Stats)
+		stats = AnimationLodStats();
+}
+
+bool AnimationLodSettings::IsDetailJoint(const std::string& jointName)
+{
+	// Mixamo names these e.g. "mixamorig:LeftHandIndex2", "mixamorig:RightEye"
+	static const char* detailJointPatterns[] = {
+		"HandThumb", "HandIndex", "HandMiddle", "HandRing", "HandPinky", "Eye", "HeadTop_End", "Toe_End"
+	};
+
+	for (const char* pattern : detailJointPatterns)
+	{
+		if (jointName.find(pattern) != std::string::npos)
+			return true;
+	}
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//! Describes how much work an Animator may spend on a character
+struct AnimationLodTier
+{
+	//! Characters up to this distance from the camera may use this tier
+	float MaxDistance = FLT_MAX;
+
+	//! Only tick the animation graph on every n-th Update (the skipped time is carried over)
+	int UpdateInterval = 1;
+
+	//! Don't sample joints that are too small to notice from afar (fingers, eyes etc.)
+	bool UseReducedJointSet = false;
+
+	//! Blend nodes only evaluate whichever of their inputs has the highest weight
+	bool PruneBlendBranches = false;
+
+	//! Sample clips from their reduced key frames instead of the authored ones
+	bool UseReducedKeys = false;
+};
+
+struct AnimationLodStats
+{
+	//! How many Animator updates happened while in this tier
+	uint32_t NumInstanceUpdates = 0;
+
+	//! How many of those actually ticked the animation graph, rather than just accumulating time
+	uint32_t NumGraphUpdates = 0;
+
+	//! Time spent ticking the graph and building skinning matrices
+	double UpdateMilliseconds = 0.0;
+};
+
+//! A set of LOD tiers ordered from most to least expensive, shared by all Animators of the same kind of character.
+//! Also collects per-tier counters so we can see where animation time goes.
+class AnimationLodSettings
+{
+public:
+	//! Full detail up close, progressively cheaper further away
+	static AnimationLodSettings CreateDefault();
+
+	//! Tiers must be added in order of increasing MaxDistance
+	void AddTier(const AnimationLodTier& tier);
+
+	int SelectTierByDistance(float distance) const;
+
+	//! Importance in range [0, 1], where 1 gets the most detailed tier
+	int SelectTierByImportance(float importance) const;
+
+	const AnimationLodTier& GetTier(int index) const;
+	int GetNumTiers() const { return (int)m_Tiers.size(); }
+
+	AnimationLodStats& GetStats(int tierIndex);
+	const std::vector<AnimationLodStats>& GetStats() const { return m_Stats; }
+	void ResetStats();
+
+	//! Whether a joint only contributes fine detail (e.g. fingers and face of the Mixamo rig)
+	static bool IsDetailJoint(const std::string& jointName);
+
+private:
+	std::vector<AnimationLodTier> m_Tiers;
+	std::vector<AnimationLodStats> m_Stats;
+};
\ No newline at end of file
@@ -2,24 +2,47 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
-#include <unordered_map>
-#include <string>
 
+#include "AnimationLod.h"
+#include "PoseBuffer.h"
+
+class JointDirectory;
+class JointMask;
+class FrameArena;
+
+//! Transform of a single joint relative to its parent
 struct LocalPose
 {
-	std::string JointName;
-
 	glm::vec3 Translation;
 	glm::quat Rotation;
 	glm::vec3 Scale;
 };
 
+//! Everything an AnimationNode needs to produce a pose, besides its time
+struct EvaluationContext
+{
+	const JointDirectory& Skeleton;
+	const AnimationLodTier& Lod;
+
+	//! Scratch memory for intermediate poses, rewound once the outermost evaluation is done
+	FrameArena& Arena;
+
+	//! If set, only the mask's nodes need to be animated; the rest may be left in their default transform
+	const JointMask* Mask = nullptr;
+};
+
 class AnimationNode
 {
 public:
-	virtual void UpdateLocalPoses(float animationTime) = 0;
-	virtual const std::unordered_map<std::string, LocalPose>& GetLocalPoses() const = 0;
+	//! Writes the local pose of every node of context.Skeleton into pose (see PoseView). Nodes that this
+	//! animation doesn't move are left in their default transform.
+	virtual void Evaluate(float animationTime, const EvaluationContext& context, PoseView pose) = 0;
 
 	virtual float GetTicksPerSecond() const = 0;
 	virtual float GetDuration() const = 0;
+
+	//! How much further from the model's origin this animation can move a joint than the skeleton's default bone
+	//! lengths allow, by translating joints (e.g. a jump lifting the hips). Lets off-screen animators bound their
+	//! poses without sampling them.
+	virtual float GetExtraJointReach() const = 0;
 };
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "AnimationRecording.h"
+
+#include "Core.h"
+
+#include <cstring>
+#include <fstream>
+
+template <typename T>
+static void Write(std::ofstream& stream, const T& value)
+{
+	stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool Read(std::ifstream& stream, T& value)
+{
+	return (bool)stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+void AnimationRecording::Clear()
+{
+	m_Names.clear();
+	m_Events.clear();
+	m_NumFrames = 0;
+}
+
+void AnimationRecording::AddEvent(AnimationEventType type, float value)
+{
+	S_ASSERT(!HasName(type));
+
+	AnimationEvent event;
+	event.Type = type;
+	event.Value = value;
+	m_Events.push_back(event);
+
+	if (type == AnimationEventType::Frame)
+		m_NumFrames++;
+}
+
+void AnimationRecording::AddEvent(AnimationEventType type, const std::string& name, float value)
+{
+	S_ASSERT(HasName(type));
+
+	AnimationEvent event;
+	event.Type = type;
+	event.NameIndex = GetNameIndex(name);
+	event.Value = value;
+	m_Events.push_back(event);
+}
+
+uint16_t AnimationRecording::GetNameIndex(const std::string& name)
+{
+	// There are only ever a handful of parameter names, so a linear search does
+	for (size_t i = 0; i < m_Names.size(); i++)
+	{
+		if (m_Names[i] == name)
+			return (uint16_t)i;
+	}
+
+	S_ASSERT(m_Names.size() < UINT16_MAX);
+	m_Names.push_back(name);
+	return (uint16_t)(m_Names.size() - 1);
+}
+
+bool AnimationRecording::HasName(AnimationEventType type)
+{
+	return type == AnimationEventType::Trigger || type == AnimationEventType::Float;
+}
+
+bool AnimationRecording::Save(const std::string& filePath) const
+{
+	std::ofstream stream(filePath, std::ios::binary);
+	if (!stream)
+		return false;
+
+	stream.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+	Write(stream, FILE_VERSION);
+
+	Write(stream, (uint32_t)m_Names.size());
+	for (const std::string& name : m_Names)
+	{
+		Write(stream, (uint16_t)name.size());
+		stream.write(name.data(), name.size());
+	}
+
+	// Triggers don't need a value, and only triggers and floats need a name
+	Write(stream, (uint32_t)m_Events.size());
+	for (const AnimationEvent& event : m_Events)
+	{
+		Write(stream, event.Type);
+		if (HasName(event.Type))
+			Write(stream, event.NameIndex);
+		if (event.Type != AnimationEventType::Trigger)
+			Write(stream, event.Value);
+	}
+	return (bool)stream;
+}
+
+bool AnimationRecording::Load(const std::string& filePath)
+{
+	Clear();
+
+	std::ifstream stream(filePath, std::ios::binary);
+	char magic[sizeof(FILE_MAGIC)];
+	uint32_t version;
+	if (!stream.read(magic, sizeof(magic)) || std::memcmp(magic, FILE_MAGIC, sizeof(magic)) != 0
+		|| !Read(stream, version) || version != FILE_VERSION)
+		return false;
+
+	uint32_t numNames;
+	if (!Read(stream, numNames))
+		return false;
+	m_Names.resize(numNames);
+	for (std::string& name : m_Names)
+	{
+		uint16_t length;
+		if (!Read(stream, length))
+			return false;
+		name.resize(length);
+		if (!stream.read(&name[0], length))
+			return false;
+	}
+
+	uint32_t numEvents;
+	if (!Read(stream, numEvents))
+		return false;
+	m_Events.resize(numEvents);
+	for (AnimationEvent& event : m_Events)
+	{
+		if (!Read(stream, event.Type) || event.Type > AnimationEventType::LodTier)
+			return false;
+		if (HasName(event.Type) && (!Read(stream, event.NameIndex) || event.NameIndex >= numNames))
+			return false;
+		if (event.Type != AnimationEventType::Trigger && !Read(stream, event.Value))
+			return false;
+
+		if (event.Type == AnimationEventType::Frame)
+			m_NumFrames++;
+	}
+	return true;
+}
\ No newline at end of file
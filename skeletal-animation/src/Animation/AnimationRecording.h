@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class AnimationEventType : uint8_t
+{
+	//! Start of a frame of the application, with its delta time
+	Frame,
+	//! Animator::Update, with its delta time
+	Update,
+	Trigger,
+	Float,
+	Visible,
+	Paused,
+	LodTier
+};
+
+struct AnimationEvent
+{
+	AnimationEventType Type;
+
+	//! Index into AnimationRecording::GetNames, for triggers and floats
+	uint16_t NameIndex = 0;
+
+	//! Delta time, parameter value, tier index, or 1/0 for booleans
+	float Value = 0.0f;
+};
+
+//! Every input an Animator received, in order, so the exact same sequence can be replayed later (see AnimationReplayer).
+//! Animators record themselves while one is set (see Animator::SetRecording), and only inputs that had an effect
+//! are kept: e.g. a trigger with no transition from the current state, or a float set to its current value, is left out.
+class AnimationRecording
+{
+public:
+	void Clear();
+
+	//! Call once at the start of every frame of the application
+	void MarkFrame(float deltaTime) { AddEvent(AnimationEventType::Frame, deltaTime); }
+
+	void AddEvent(AnimationEventType type, float value);
+	void AddEvent(AnimationEventType type, const std::string& name, float value = 0.0f);
+
+	const std::vector<AnimationEvent>& GetEvents() const { return m_Events; }
+	const std::string& GetName(uint16_t nameIndex) const { return m_Names[nameIndex]; }
+	uint32_t GetNumFrames() const { return m_NumFrames; }
+
+	//! Compact binary format: a name table, then a few bytes per event
+	bool Save(const std::string& filePath) const;
+	bool Load(const std::string& filePath);
+private:
+	uint16_t GetNameIndex(const std::string& name);
+	static bool HasName(AnimationEventType type);
+private:
+	static constexpr char FILE_MAGIC[4] = { 'A', 'N', 'R', 'C' };
+	static constexpr uint32_t FILE_VERSION = 1;
+
+	std::vector<std::string> m_Names;
+	std::vector<AnimationEvent> m_Events;
+	uint32_t m_NumFrames = 0;
+};
\ No newline at end of file
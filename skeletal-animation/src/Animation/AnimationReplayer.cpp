@@ -0,0 +1,65 @@
+#include "AnimationReplayer.h"
+
+#include "Animator.h"
+#include "Profiler.h"
+
+#include <chrono>
+
+AnimationReplayer::AnimationReplayer(const AnimationRecording& recording, Animator& animator)
+	: m_Recording(recording), m_Animator(animator)
+{
+}
+
+bool AnimationReplayer::ReplayFrame()
+{
+	const std::vector<AnimationEvent>& events = m_Recording.GetEvents();
+	if (m_NextEvent == events.size())
+		return false;
+
+	S_PROFILE_FRAME();
+
+	m_FrameDeltaTime = 0.0f;
+	m_UpdateMilliseconds = 0.0;
+
+	// Events recorded before the first frame mark (e.g. setting up the animator) are played along with the first frame
+	if (events[m_NextEvent].Type == AnimationEventType::Frame)
+		m_FrameDeltaTime = events[m_NextEvent++].Value;
+
+	for (; m_NextEvent < events.size() && events[m_NextEvent].Type != AnimationEventType::Frame; m_NextEvent++)
+		ApplyEvent(events[m_NextEvent]);
+
+	m_NumFramesPlayed++;
+	return true;
+}
+
+void AnimationReplayer::ApplyEvent(const AnimationEvent& event)
+{
+	switch (event.Type)
+	{
+		case AnimationEventType::Update:
+		{
+			auto startTime = std::chrono::high_resolution_clock::now();
+			m_Animator.Update(event.Value);
+			std::chrono::duration<double, std::milli> updateTime = std::chrono::high_resolution_clock::now() - startTime;
+			m_UpdateMilliseconds += updateTime.count();
+			break;
+		}
+		case AnimationEventType::Trigger:
+			m_Animator.SetTrigger(m_Recording.GetName(event.NameIndex));
+			break;
+		case AnimationEventType::Float:
+			m_Animator.SetFloat(m_Recording.GetName(event.NameIndex), event.Value);
+			break;
+		case AnimationEventType::Visible:
+			m_Animator.SetVisible(event.Value != 0.0f);
+			break;
+		case AnimationEventType::Paused:
+			m_Animator.SetPaused(event.Value != 0.0f);
+			break;
+		case AnimationEventType::LodTier:
+			m_Animator.SetLodTierIndex((int)event.Value);
+			break;
+		case AnimationEventType::Frame:
+			break;
+	}
+}
\ No newline at end of file
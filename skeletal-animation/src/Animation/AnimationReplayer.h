@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+#include "AnimationRecording.h"
+
+class Animator;
+
+//! Drives an Animator through exactly the inputs of an AnimationRecording, one recorded frame at a time.
+//! The animator must have been set up with the same graph, LOD settings and update rate as the recorded one.
+class AnimationReplayer
+{
+public:
+	AnimationReplayer(const AnimationRecording& recording, Animator& animator);
+
+	//! Applies every event of the next recorded frame. Returns false once the whole recording has been played.
+	bool ReplayFrame();
+
+	//! Frames played so far
+	uint32_t GetNumFramesPlayed() const { return m_NumFramesPlayed; }
+
+	//! Delta time the application had in the last played frame
+	float GetFrameDeltaTime() const { return m_FrameDeltaTime; }
+
+	//! Time spent in Animator::Update during the last played frame
+	double GetUpdateMilliseconds() const { return m_UpdateMilliseconds; }
+private:
+	void ApplyEvent(const AnimationEvent& event);
+private:
+	const AnimationRecording& m_Recording;
+	Animator& m_Animator;
+
+	size_t m_NextEvent = 0;
+	uint32_t m_NumFramesPlayed = 0;
+	float m_FrameDeltaTime = 0.0f;
+	double m_UpdateMilliseconds = 0.0;
+};
\ No newline at end of file
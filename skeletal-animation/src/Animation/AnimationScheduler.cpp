@@ -0,0 +1,200 @@
+#include "AnimationScheduler.h"
+
+#include "Animator.h"
+#include "AllocationTracker.h"
+#include "Profiler.h"
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+using Clock = std::chrono::high_resolution_clock;
+
+AnimationScheduler::AnimationScheduler(float budgetMilliseconds, int maxFramesWithoutUpdate)
+	: m_BudgetMilliseconds(budgetMilliseconds), m_MaxFramesWithoutUpdate(maxFramesWithoutUpdate)
+{
+	S_ASSERT(maxFramesWithoutUpdate >= 1);
+}
+
+void AnimationScheduler::AddAnimator(Animator* animator, float priority)
+{
+	S_ASSERT(animator && !Find(animator));
+
+	ScheduledAnimator scheduled;
+	scheduled.Instance = animator;
+	scheduled.Priority = priority;
+	m_Animators.push_back(scheduled);
+}
+
+void AnimationScheduler::RemoveAnimator(Animator* animator)
+{
+	auto it = std::find_if(m_Animators.begin(), m_Animators.end(),
+						   [animator](const ScheduledAnimator& scheduled) { return scheduled.Instance == animator; });
+	if (it != m_Animators.end())
+		m_Animators.erase(it);
+}
+
+void AnimationScheduler::SetPriority(Animator* animator, float priority)
+{
+	ScheduledAnimator* scheduled = Find(animator);
+	S_ASSERT(scheduled);
+	scheduled->Priority = priority;
+}
+
+void AnimationScheduler::Update(float deltaTime)
+{
+	S_PROFILE_SCOPE("AnimationScheduler::Update");
+	S_ALLOCATION_SCOPE("Scheduler");
+
+	m_Stats = AnimationSchedulerStats();
+	m_Stats.NumAnimators = (uint32_t)m_Animators.size();
+	m_Stats.BudgetMilliseconds = m_BudgetMilliseconds;
+
+	// Animators only need scratch memory while they're being updated
+	FrameArena& arena = FrameArena::Get();
+	arena.BeginFrame();
+
+	auto frameStartTime = Clock::now();
+
+	m_UpdateOrder.clear();
+	m_UpdateBatch.clear();
+	for (uint32_t i = 0; i < m_Animators.size(); i++)
+	{
+		ScheduledAnimator& scheduled = m_Animators[i];
+
+		// Sleeping animators would ignore the update anyway, so they don't need a place in the queue
+		if (scheduled.Instance->IsSleeping())
+		{
+			scheduled.PendingTime = 0.0f;
+			scheduled.FramesSinceUpdate = 0;
+			m_Stats.NumSleeping++;
+			continue;
+		}
+
+		scheduled.PendingTime += deltaTime;
+		scheduled.FramesSinceUpdate++;
+
+		// Animators that have waited long enough are updated regardless of the budget
+		if (scheduled.FramesSinceUpdate >= m_MaxFramesWithoutUpdate)
+		{
+			if (m_IsGroupedByAnimation)
+			{
+				m_UpdateBatch.push_back(i);
+			}
+			else
+			{
+				UpdateAnimator(scheduled);
+				m_Stats.NumForcedUpdates++;
+			}
+		}
+		else
+		{
+			m_UpdateOrder.push_back(i);
+		}
+	}
+
+	// The longer an animator has waited, the more urgent it becomes, so low priority ones don't always hit the limit
+	auto urgency = [this](uint32_t index)
+	{
+		const ScheduledAnimator& scheduled = m_Animators[index];
+		return scheduled.Priority * (1 + scheduled.FramesSinceUpdate);
+	};
+	std::sort(m_UpdateOrder.begin(), m_UpdateOrder.end(),
+			  [&urgency](uint32_t a, uint32_t b) { return urgency(a) > urgency(b); });
+
+	if (m_IsGroupedByAnimation)
+	{
+		UpdateGroupedByAnimation(frameStartTime);
+		arena.EndFrame();
+		return;
+	}
+
+	for (uint32_t index : m_UpdateOrder)
+	{
+		std::chrono::duration<double, std::milli> usedTime = Clock::now() - frameStartTime;
+		if (usedTime.count() + m_AverageUpdateMilliseconds > m_BudgetMilliseconds)
+		{
+			m_Stats.NumDeferred++;
+			continue;
+		}
+
+		UpdateAnimator(m_Animators[index]);
+		m_Stats.NumUpdated++;
+	}
+
+	std::chrono::duration<double, std::milli> usedTime = Clock::now() - frameStartTime;
+	m_Stats.UsedMilliseconds = usedTime.count();
+
+	arena.EndFrame();
+}
+
+AnimationScheduler::ScheduledAnimator* AnimationScheduler::Find(Animator* animator)
+{
+	for (ScheduledAnimator& scheduled : m_Animators)
+	{
+		if (scheduled.Instance == animator)
+			return &scheduled;
+	}
+	return nullptr;
+}
+
+void AnimationScheduler::UpdateGroupedByAnimation(Clock::time_point frameStartTime)
+{
+	S_PROFILE_SCOPE("AnimationScheduler::UpdateGroupedByAnimation");
+
+	// Forced updates are already in the batch. The rest get in by urgency, for as long as their predicted cost fits.
+	double predictedMilliseconds = m_UpdateBatch.size() * m_AverageUpdateMilliseconds;
+	for (uint32_t index : m_UpdateOrder)
+	{
+		if (predictedMilliseconds + m_AverageUpdateMilliseconds > m_BudgetMilliseconds)
+		{
+			m_Stats.NumDeferred++;
+			continue;
+		}
+
+		m_UpdateBatch.push_back(index);
+		predictedMilliseconds += m_AverageUpdateMilliseconds;
+	}
+
+	// Grouping doesn't change which animators are updated, or where their results go, only the order
+	std::stable_sort(m_UpdateBatch.begin(), m_UpdateBatch.end(), [this](uint32_t a, uint32_t b)
+	{
+		return std::less<const AnimationNode*>()(m_Animators[a].Instance->GetMainAnimation(), m_Animators[b].Instance->GetMainAnimation());
+	});
+
+	for (uint32_t index : m_UpdateBatch)
+	{
+		ScheduledAnimator& scheduled = m_Animators[index];
+		bool isForced = scheduled.FramesSinceUpdate >= m_MaxFramesWithoutUpdate;
+		UpdateAnimator(scheduled);
+		if (isForced)
+			m_Stats.NumForcedUpdates++;
+		else
+			m_Stats.NumUpdated++;
+	}
+
+	std::chrono::duration<double, std::milli> usedTime = Clock::now() - frameStartTime;
+	m_Stats.UsedMilliseconds = usedTime.count();
+}
+
+void AnimationScheduler::UpdateAnimator(ScheduledAnimator& scheduled)
+{
+	// Counted in either order, to see how well grouping works
+	const AnimationNode* animation = scheduled.Instance->GetMainAnimation();
+	if (m_Stats.NumUpdated + m_Stats.NumForcedUpdates == 0 || animation != m_PreviousAnimation)
+		m_Stats.NumAnimationGroups++;
+	m_PreviousAnimation = animation;
+
+	auto startTime = Clock::now();
+
+	scheduled.Instance->Update(scheduled.PendingTime);
+	scheduled.PendingTime = 0.0f;
+	scheduled.FramesSinceUpdate = 0;
+
+	std::chrono::duration<double, std::milli> updateTime = Clock::now() - startTime;
+
+	// Exponential moving average, so the estimate follows changes in LOD or animation graph cost
+	constexpr double smoothing = 0.1;
+	m_AverageUpdateMilliseconds += (updateTime.count() - m_AverageUpdateMilliseconds) * smoothing;
+}
\ No newline at end of file
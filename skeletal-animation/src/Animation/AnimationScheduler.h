@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+class Animator;
+class AnimationNode;
+
+struct AnimationSchedulerStats
+{
+	uint32_t NumAnimators = 0;
+
+	//! Animators that were updated within the budget
+	uint32_t NumUpdated = 0;
+
+	//! Animators that went over the budget because they had gone too long without an update
+	uint32_t NumForcedUpdates = 0;
+
+	//! Animators that only had their time advanced and kept showing their last skinning matrices
+	uint32_t NumDeferred = 0;
+
+	//! Animators that had nothing to update (see Animator::IsSleeping)
+	uint32_t NumSleeping = 0;
+
+	//! Runs of consecutive updates that shared their main animation (see AnimationScheduler::SetGroupedByAnimation),
+	//! so as many as there are updates when animators sharing a clip never follow each other
+	uint32_t NumAnimationGroups = 0;
+
+	double BudgetMilliseconds = 0.0;
+	double UsedMilliseconds = 0.0;
+
+	float GetSleepingFraction() const { return NumAnimators > 0 ? (float)NumSleeping / NumAnimators : 0.0f; }
+};
+
+//! Updates as many Animators as fit in a fixed per-frame CPU budget, most important first.
+//! Animators that don't fit keep their last skinning matrices and have the time that passed
+//! carried over to their next update, which is guaranteed to happen within a set number of frames.
+class AnimationScheduler
+{
+public:
+	AnimationScheduler(float budgetMilliseconds, int maxFramesWithoutUpdate);
+
+	void AddAnimator(Animator* animator, float priority = 1.0f);
+	void RemoveAnimator(Animator* animator);
+
+	//! Higher priority animators are updated first (e.g. the ones closest to the camera)
+	void SetPriority(Animator* animator, float priority);
+
+	void SetBudget(float budgetMilliseconds) { m_BudgetMilliseconds = budgetMilliseconds; }
+
+	//! Instead of updating animators in order of urgency until the budget runs out, pick the ones that are predicted
+	//! to fit first, then update them grouped by their main animation (see Animator::GetMainAnimation). Each clip's
+	//! key data then comes into cache once per frame, rather than being evicted and reloaded between characters.
+	void SetGroupedByAnimation(bool isGrouped) { m_IsGroupedByAnimation = isGrouped; }
+
+	void Update(float deltaTime);
+
+	//! Stats of the most recent Update
+	const AnimationSchedulerStats& GetStats() const { return m_Stats; }
+private:
+	struct ScheduledAnimator
+	{
+		Animator* Instance;
+		float Priority;
+
+		int FramesSinceUpdate = 0;
+
+		//! Time that has passed since this animator was last updated
+		float PendingTime = 0.0f;
+	};
+
+	ScheduledAnimator* Find(Animator* animator);
+	void UpdateAnimator(ScheduledAnimator& scheduled);
+	void UpdateGroupedByAnimation(std::chrono::high_resolution_clock::time_point frameStartTime);
+private:
+	float m_BudgetMilliseconds;
+	int m_MaxFramesWithoutUpdate;
+
+	std::vector<ScheduledAnimator> m_Animators;
+
+	bool m_IsGroupedByAnimation = false;
+
+	//! Scratch list of indices into m_Animators, sorted by urgency each frame
+	std::vector<uint32_t> m_UpdateOrder;
+
+	//! Scratch list of the animators to update when grouped by animation, forced ones first
+	std::vector<uint32_t> m_UpdateBatch;
+
+	//! Main animation of the animator updated last, for counting groups
+	const AnimationNode* m_PreviousAnimation = nullptr;
+
+	//! Running average of how long a single animator update takes, used to predict what fits in the budget
+	double m_AverageUpdateMilliseconds = 0.0;
+
+	AnimationSchedulerStats m_Stats;
+};
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "Animator.h"
 #include "BlendNode.h"
+#include "Profiler.h"
 
 AnimationState::AnimationState(std::string&& name, AnimationNode* animation, bool shouldLoop, bool isResettable)
 	: m_Name(std::move(name)), m_Animation(animation), m_ShouldLoop(shouldLoop), m_IsResettable(isResettable)
@@ -21,52 +22,63 @@ void AnimationState::AddTriggerTransition(std::string&& triggerName, Transition*
 	m_OnTriggerTransitions[triggerName] = transition;
 }
 
-void AnimationState::Update(float deltaTime)
+void AnimationState::Update(Animator& animator, float deltaTime)
 {
+	S_PROFILE_SCOPE("AnimationState::Update");
+
 	m_AnimationTime += deltaTime * m_Animation->GetTicksPerSecond();
 	if (m_ShouldLoop)
 	{
 		m_AnimationTime = fmod(m_AnimationTime, m_CompletionTime);
 	}
-	else
+	else if (m_AnimationTime >= m_CompletionTime)
 	{
-		if (m_AnimationTime >= m_CompletionTime && m_OnCompleteTransition && !Animator::GetInstance()->IsTransitioning())
+		// Hold the final pose rather than extrapolating past the end of the animation
+		m_AnimationTime = m_CompletionTime;
+		if (m_OnCompleteTransition && !animator.IsTransitioning())
 		{
-			m_AnimationTime = m_CompletionTime;
-			Animator::GetInstance()->OnStateFinished(this, m_OnCompleteTransition);
-			return;
+			animator.OnStateFinished(this, m_OnCompleteTransition);
 		}
 	}
-
-	m_Animation->UpdateLocalPoses(m_AnimationTime);
 }
 
-void AnimationState::SetTrigger(const std::string& name)
+Transition* AnimationState::GetTriggerTransition(const std::string& name) const
 {
-	if (m_OnTriggerTransitions.find(name) != m_OnTriggerTransitions.end())
-	{
-		Animator::GetInstance()->OnStateFinished(this, m_OnTriggerTransitions.at(name));
-	}
+	auto it = m_OnTriggerTransitions.find(name);
+	return it != m_OnTriggerTransitions.end() ? it->second : nullptr;
 }
 
 template <>
 void AnimationState::AddVar<float>(const std::string& name, AnimationVar<float>&& var)
 {
-	m_FloatVars[name] = std::move(var);
+	AnimationVar<float>& addedVar = m_FloatVars[name];
+	addedVar = std::move(var);
+
+	// So the animation starts out agreeing with the variable, rather than waiting for it to be set
+	ApplyVar(addedVar);
 }
 
 template <>
-void AnimationState::SetVar<float>(const std::string& name, float value)
+bool AnimationState::SetVar<float>(const std::string& name, float value)
 {
 	if (m_FloatVars.find(name) != m_FloatVars.end())
 	{
 		AnimationVar<float>& var = m_FloatVars.at(name);
-		BlendNode* blendNode = dynamic_cast<BlendNode*>(m_Animation);
-		if (blendNode)
-		{
-			float t = (value - var.MinValue) / var.MaxValue;
-			blendNode->SetTargetWeight(t);
-		}
+		bool hasChanged = var.Value != value;
+		var.Value = value;
+
+		ApplyVar(var);
+		return hasChanged;
 	}
+	return false;
+}
 
+void AnimationState::ApplyVar(const AnimationVar<float>& var)
+{
+	BlendNode* blendNode = dynamic_cast<BlendNode*>(m_Animation);
+	if (blendNode)
+	{
+		float t = (var.Value - var.MinValue) / var.MaxValue;
+		blendNode->SetTargetWeight(t);
+	}
 }
\ No newline at end of file
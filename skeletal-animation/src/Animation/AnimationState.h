@@ -2,10 +2,13 @@
 
 #include <unordered_map>
 #include <memory>
+#include <string>
 
 #include "AnimationNode.h"
 #include "Transition.h"
 
+class Animator;
+
 template <typename T>
 struct AnimationVar
 {
@@ -21,24 +24,38 @@ public:
 
 	void Reset();
 
-	void Update(float deltaTime);
+	//! Moves the animation's time along; see Evaluate for its pose
+	void Update(Animator& animator, float deltaTime);
+
+	void Evaluate(const EvaluationContext& context, PoseView pose) { m_Animation->Evaluate(m_AnimationTime, context, pose); }
 
 	const std::string& GetName() const { return m_Name; }
 
+	AnimationNode* GetAnimation() const { return m_Animation; }
+
+	//! In the units the animation is evaluated in
+	float GetAnimationTime() const { return m_AnimationTime; }
+
 	template <typename T>
 	void AddVar(const std::string& name, AnimationVar<T>&& var);
 
-	const std::unordered_map<std::string, LocalPose>& GetLocalPoses() const { return m_Animation->GetLocalPoses(); }
 	void SetCompletionTime(float fraction) { m_CompletionTime = fraction * m_Animation->GetDuration(); }
+
+	//! A completed state with nowhere to go holds its final pose indefinitely
+	bool IsFrozen() const { return !m_ShouldLoop && !m_OnCompleteTransition && m_AnimationTime >= m_CompletionTime; }
 	
 	void SetOnCompleteTransition(Transition* transition) { m_OnCompleteTransition = transition; }
 	void AddTriggerTransition(std::string&& triggerName, Transition* transition);
 
-	void SetTrigger(const std::string& name);
+	//! The transition this state takes when the given trigger is set, if any
+	Transition* GetTriggerTransition(const std::string& name) const;
 	
+	//! Returns whether this changed the value of the variable
 	template <typename T>
-	void SetVar(const std::string& name, T value);
+	bool SetVar(const std::string& name, T value);
 
+private:
+	void ApplyVar(const AnimationVar<float>& var);
 private:
 	std::string m_Name;
 
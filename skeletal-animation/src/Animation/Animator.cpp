@@ -1,8 +1,16 @@
 #include "Animator.h"
 
-#include <glm/gtx/quaternion.hpp>
+#include "BlendHelper.h"
+#include "PoseHelper.h"
+#include "FrameArena.h"
+#include "MemoryReport.h"
+#include "AnimationRecording.h"
+#include "JointMask.h"
+#include "PoseCache.h"
+#include "AllocationTracker.h"
+#include "Profiler.h"
 
-Animator* Animator::s_Instance = new Animator();
+#include <chrono>
 
 Animator::Animator()
 {
@@ -13,48 +21,441 @@ Animator::Animator()
 	}
 }
 
-Animator::~Animator()
+//! Radius of a joint in model space
+static float GetJointExtent(const JointDirectory& skeleton, int jointId, const glm::mat4& transform)
 {
-	if (s_Instance)
+	// The joint radius is in joint space, so account for any scale on the way to model space
+	float maxScale = glm::max(glm::length(glm::vec3(transform[0])),
+							  glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+	return skeleton.GetJointRadius(jointId) * maxScale;
+}
+
+//! Box around the joints of the skeleton, each padded by its radius
+static BoundingBox GetJointBounds(const JointDirectory& skeleton, const std::vector<glm::mat4>& modelSpaceTransforms)
+{
+	const std::vector<FlatSkeletonNode>& nodes = skeleton.GetFlatNodes();
+
+	BoundingBox bounds;
+	bool isFirstJoint = true;
+	for (size_t i = 0; i < nodes.size(); i++)
 	{
-		delete s_Instance;
-		s_Instance = nullptr;
+		if (nodes[i].JointId < 0)
+			continue;
+
+		glm::vec3 extent(GetJointExtent(skeleton, nodes[i].JointId, modelSpaceTransforms[i]));
+		glm::vec3 position(modelSpaceTransforms[i][3]);
+
+		if (isFirstJoint)
+		{
+			bounds.Min = position - extent;
+			bounds.Max = position + extent;
+			isFirstJoint = false;
+		}
+		else
+		{
+			bounds.Min = glm::min(bounds.Min, position - extent);
+			bounds.Max = glm::max(bounds.Max, position + extent);
+		}
+	}
+	return bounds;
+}
+
+void Animator::SetDirectory(const std::shared_ptr<JointDirectory>& jointDirectory)
+{
+	m_JointDirectory = jointDirectory;
+	m_Bounds = BoundingBox();
+	m_MaxJointReach = 0.0f;
+	if (!jointDirectory || jointDirectory->GetFlatNodes().empty())
+		return;
+
+	const std::vector<FlatSkeletonNode>& nodes = jointDirectory->GetFlatNodes();
+	std::vector<glm::mat4> modelSpaceTransforms;
+	PoseHelper::LocalToModel(nodes, jointDirectory->GetDefaultPose(), modelSpaceTransforms);
+	m_Bounds = GetJointBounds(*jointDirectory, modelSpaceTransforms);
+
+	// Rotations can't take a joint further from the model's origin than the lengths of the bones leading to it; joints
+	// that animations translate further are allowed for by AnimationNode::GetExtraJointReach.
+	// Parents come before their children, so their chains are already measured.
+	std::vector<float> chainLengths(nodes.size(), 0.0f);
+	for (size_t i = 0; i < nodes.size(); i++)
+	{
+		int parent = nodes[i].ParentIndex;
+		glm::vec3 position(modelSpaceTransforms[i][3]);
+		chainLengths[i] = parent >= 0 ? chainLengths[parent] + glm::distance(position, glm::vec3(modelSpaceTransforms[parent][3]))
+									  : glm::length(position);
+
+		if (nodes[i].JointId >= 0)
+		{
+			float extent = GetJointExtent(*jointDirectory, nodes[i].JointId, modelSpaceTransforms[i]);
+			m_MaxJointReach = glm::max(m_MaxJointReach, chainLengths[i] + extent);
+		}
 	}
 }
 
 void Animator::Update(float deltaTime)
 {
+	S_PROFILE_SCOPE("Animator::Update");
+	S_ALLOCATION_SCOPE("Animator");
+
+	if (m_Recording)
+		m_Recording->AddEvent(AnimationEventType::Update, deltaTime);
+
+	if (IsSleeping())
+		return;
+
+	const AnimationLodTier& lod = GetLodTier();
+	AnimationLodStats* lodStats = m_LodSettings ? &m_LodSettings->GetStats(m_LodTierIndex) : nullptr;
+	if (lodStats)
+		lodStats->NumInstanceUpdates++;
+
+	// Cheaper LOD tiers only tick every few updates, catching up on the time that passed in one go
+	m_SkippedTime += deltaTime;
+	if (++m_NumSkippedUpdates < lod.UpdateInterval)
+		return;
+
+	float elapsedTime = m_SkippedTime;
+	m_SkippedTime = 0.0f;
+	m_NumSkippedUpdates = 0;
+
+	auto startTime = std::chrono::high_resolution_clock::now();
+	UpdatePose(elapsedTime);
+	m_IsSleeping = m_NumFrozenTicks >= FROZEN_TICKS_BEFORE_SLEEP;
+
+	if (lodStats)
+	{
+		std::chrono::duration<double, std::milli> updateTime = std::chrono::high_resolution_clock::now() - startTime;
+		lodStats->NumGraphUpdates++;
+		lodStats->UpdateMilliseconds += updateTime.count();
+	}
+}
+
+void Animator::UpdatePose(float deltaTime)
+{
+	S_PROFILE_SCOPE("Animator::UpdatePose");
+
+	if (!m_IsVisible)
+	{
+		// Nobody will see the pose, so just move the graph along
+		Simulate(deltaTime);
+		UpdateHiddenBounds();
+		return;
+	}
+
+	if (m_FixedTimeStep <= 0.0f)
+	{
+		AdvanceGraph(deltaTime);
+		if (!m_PoseCache || !UpdateFromPoseCache())
+		{
+			EvaluatePose(m_CurrentPose);
+			UpdateJointTransforms(m_CurrentPose);
+		}
+		return;
+	}
+
+	if (!m_HasSimulated)
+	{
+		// Nothing to interpolate from yet, so start off with two identical poses
+		Simulate(0.0f);
+		m_PreviousPose = m_CurrentPose;
+		m_HasSimulated = true;
+	}
+
+	m_TimeAccumulator += deltaTime;
+
+	int numUpdates = 0;
+	while (m_TimeAccumulator >= m_FixedTimeStep)
+	{
+		if (numUpdates == MAX_FIXED_UPDATES_PER_FRAME)
+		{
+			m_TimeAccumulator = fmod(m_TimeAccumulator, m_FixedTimeStep);
+			break;
+		}
+
+		std::swap(m_PreviousPose, m_CurrentPose);
+		Simulate(m_FixedTimeStep);
+		m_TimeAccumulator -= m_FixedTimeStep;
+		numUpdates++;
+	}
+
+	float alpha = m_TimeAccumulator / m_FixedTimeStep;
+	m_RenderPose.Resize(m_CurrentPose.Size());
+	BlendHelper::NlerpPoses(m_RenderPose.GetView(), m_PreviousPose.GetView(), m_CurrentPose.GetView(), alpha);
+	UpdateJointTransforms(m_RenderPose);
+}
+
+void Animator::SetFixedUpdateRate(float ticksPerSecond)
+{
+	S_ASSERT(ticksPerSecond >= 0.0f);
+	m_FixedTimeStep = ticksPerSecond > 0.0f ? 1.0f / ticksPerSecond : 0.0f;
+	m_TimeAccumulator = 0.0f;
+	m_HasSimulated = false;
+}
+
+void Animator::SetJointMask(const std::shared_ptr<JointMask>& mask)
+{
+	S_ASSERT(!mask || !m_JointDirectory || mask->GetNumSkeletonNodes() == m_JointDirectory->GetFlatNodes().size());
+	m_JointMask = mask;
+	WakeUp();
+}
+
+const glm::mat4& Animator::GetModelSpaceTransform(int nodeIndex) const
+{
+	S_ASSERT(nodeIndex >= 0 && nodeIndex < (int)m_ModelSpaceTransforms.size());
+	S_ASSERT(!m_JointMask || m_JointMask->Contains(nodeIndex));
+	return m_ModelSpaceTransforms[nodeIndex];
+}
+
+void Animator::SetVisible(bool isVisible)
+{
+	if (isVisible == m_IsVisible)
+		return;
+
+	if (m_Recording)
+		m_Recording->AddEvent(AnimationEventType::Visible, isVisible ? 1.0f : 0.0f);
+
+	// Poses captured before going off-screen are stale, so don't interpolate from them when coming back
+	if (isVisible)
+		m_HasSimulated = false;
+
+	m_IsVisible = isVisible;
+	if (!isVisible)
+		UpdateHiddenBounds();
+	WakeUp();
+}
+
+void Animator::SetPaused(bool isPaused)
+{
+	if (m_Recording)
+		m_Recording->AddEvent(AnimationEventType::Paused, isPaused ? 1.0f : 0.0f);
+
+	m_IsPaused = isPaused;
+	if (!isPaused)
+		WakeUp();
+}
+
+void Animator::WakeUp()
+{
+	m_QueryGeneration++;
+	m_IsSleeping = false;
+	m_NumFrozenTicks = 0;
+}
+
+void Animator::SetLodFromDistance(float distanceToCamera)
+{
+	if (m_LodSettings)
+		SetLodTierIndex(m_LodSettings->SelectTierByDistance(distanceToCamera));
+}
+
+void Animator::SetLodFromImportance(float importance)
+{
+	if (m_LodSettings)
+		SetLodTierIndex(m_LodSettings->SelectTierByImportance(importance));
+}
+
+void Animator::SetLodTierIndex(int tierIndex)
+{
+	S_ASSERT(tierIndex >= 0 && (!m_LodSettings || tierIndex < m_LodSettings->GetNumTiers()));
+
+	if (tierIndex == m_LodTierIndex)
+		return;
+
+	if (m_Recording)
+		m_Recording->AddEvent(AnimationEventType::LodTier, (float)tierIndex);
+
+	m_LodTierIndex = tierIndex;
+	WakeUp();
+}
+
+const AnimationLodTier& Animator::GetLodTier() const
+{
+	// Without any LOD settings, everything is animated at full detail
+	static const AnimationLodTier fullDetail;
+	return m_LodSettings ? m_LodSettings->GetTier(m_LodTierIndex) : fullDetail;
+}
+
+void Animator::Simulate(float deltaTime)
+{
+	S_PROFILE_SCOPE("Animator::Simulate");
+
+	AdvanceGraph(deltaTime);
+	if (ShouldSamplePoses())
+		EvaluatePose(m_CurrentPose);
+}
+
+void Animator::AdvanceGraph(float deltaTime)
+{
+	m_QueryGeneration++;
+
 	if (m_CurrentTransition)
-		m_CurrentTransition->Update(deltaTime);
+		m_CurrentTransition->Update(*this, deltaTime);
 	if (m_CurrentState)
-		m_CurrentState->Update(deltaTime);
+		m_CurrentState->Update(*this, deltaTime);
+
+	if (!m_CurrentTransition && m_CurrentState && m_CurrentState->IsFrozen())
+		m_NumFrozenTicks++;
+	else
+		m_NumFrozenTicks = 0;
+}
+
+bool Animator::UpdateFromPoseCache()
+{
+	S_PROFILE_SCOPE("Animator::UpdateFromPoseCache");
+
+	// Blend trees and transitions depend on more than a clip and a time, so only plain clip states can share poses
+	if (m_CurrentTransition || !m_CurrentState || m_JointMask)
+		return false;
+
+	AnimationClip* clip = dynamic_cast<AnimationClip*>(m_CurrentState->GetAnimation());
+	if (!clip)
+		return false;
+
+	PoseCache::Key key;
+	key.Clip = clip;
+	key.Skeleton = m_JointDirectory.get();
+	key.Lod = &GetLodTier();
+	key.Bucket = m_PoseCache->GetBucket(*clip, m_CurrentState->GetAnimationTime());
+
+	PoseCache::Entry* entry;
+	if (m_PoseCache->Acquire(key, entry))
+	{
+		m_CurrentPose = entry->Pose;
+		m_ModelSpaceTransforms = entry->ModelSpaceTransforms;
+		m_SkinningMatrices = entry->SkinningMatrices;
+		m_Bounds = entry->Bounds;
+		m_PaletteVersion++;
+		return true;
+	}
+
+	// Sampled at the start of the bucket rather than our own time, so it's the same pose whoever fills the entry
+	m_CurrentPose.Resize(m_JointDirectory->GetFlatNodes().size());
+	{
+		FrameArena& arena = FrameArena::Get();
+		FrameArena::Scope scratchScope(arena);
+		EvaluationContext context = { *m_JointDirectory, GetLodTier(), arena };
+		clip->Evaluate(m_PoseCache->GetBucketTime(*clip, key.Bucket), context, m_CurrentPose.GetView());
+	}
+	UpdateJointTransforms(m_CurrentPose);
+
+	entry->Pose = m_CurrentPose;
+	entry->ModelSpaceTransforms = m_ModelSpaceTransforms;
+	entry->SkinningMatrices = m_SkinningMatrices;
+	entry->Bounds = m_Bounds;
+	return true;
+}
+
+void Animator::EvaluatePose(PoseBuffer& pose)
+{
+	S_PROFILE_SCOPE("Animator::EvaluatePose");
+
+	pose.Resize(m_JointDirectory->GetFlatNodes().size());
+
+	// Intermediate poses of the graph live in the arena, so only the final pose is written to a PoseBuffer
+	FrameArena& arena = FrameArena::Get();
+	FrameArena::Scope scratchScope(arena);
+	EvaluationContext context = { *m_JointDirectory, GetLodTier(), arena, m_JointMask.get() };
+	EvaluateGraph(context, pose.GetView());
+}
+
+void Animator::EvaluateGraph(const EvaluationContext& context, PoseView pose)
+{
+	if (m_CurrentTransition)
+	{
+		m_CurrentTransition->Evaluate(context, pose);
+	}
+	else if (m_CurrentState)
+	{
+		m_CurrentState->Evaluate(context, pose);
+	}
+	else
+	{
+		S_ASSERT(false); // Animator has neither state nor transition set
+		PoseHelper::CopyPose(pose, m_JointDirectory->GetDefaultPose());
+	}
+}
+
+const glm::mat4& Animator::QueryModelSpaceTransform(int nodeIndex)
+{
+	S_PROFILE_SCOPE("Animator::QueryModelSpaceTransform");
+	S_ALLOCATION_SCOPE("Animator");
+
+	const std::vector<FlatSkeletonNode>& nodes = m_JointDirectory->GetFlatNodes();
+	S_ASSERT(nodeIndex >= 0 && nodeIndex < (int)nodes.size());
+
+	if (m_QueryGenerations.size() != nodes.size())
+	{
+		m_QueryTransforms.assign(nodes.size(), glm::mat4(1.0f));
+		m_QueryGenerations.assign(nodes.size(), 0);
+		m_QueryChain.reserve(nodes.size());
+		m_QueryMask = JointMask(nodes.size());
+	}
+
+	if (m_QueryGenerations[nodeIndex] == m_QueryGeneration)
+		return m_QueryTransforms[nodeIndex];
 
-	UpdateSkinningMatrices(m_JointDirectory->GetRootNode(), glm::mat4(1.0f));
+	// Walk up until we reach an ancestor an earlier query has already worked out
+	m_QueryChain.clear();
+	for (int node = nodeIndex; node >= 0 && m_QueryGenerations[node] != m_QueryGeneration; node = nodes[node].ParentIndex)
+		m_QueryChain.push_back(node);
+
+	m_QueryMask.Clear();
+	for (auto it = m_QueryChain.rbegin(); it != m_QueryChain.rend(); ++it)
+		m_QueryMask.AddNode(*it);
+
+	FrameArena& arena = FrameArena::Get();
+	FrameArena::Scope scratchScope(arena);
+	PoseView pose = PoseHelper::AllocatePose(arena, nodes.size());
+	EvaluationContext context = { *m_JointDirectory, GetLodTier(), arena, &m_QueryMask };
+	EvaluateGraph(context, pose);
+
+	for (int node : m_QueryMask.GetNodeIndices())
+	{
+		glm::mat4 localTransform = PoseHelper::GetLocalTransform(pose.Translations[node], pose.Rotations[node], pose.Scales[node]);
+		int parentIndex = nodes[node].ParentIndex;
+		m_QueryTransforms[node] = parentIndex >= 0 ? m_QueryTransforms[parentIndex] * localTransform : localTransform;
+		m_QueryGenerations[node] = m_QueryGeneration;
+	}
+	return m_QueryTransforms[nodeIndex];
+}
+
+const AnimationNode* Animator::GetMainAnimation() const
+{
+	if (m_CurrentTransition)
+		return m_CurrentTransition->GetSourceState()->GetAnimation();
+	return m_CurrentState ? m_CurrentState->GetAnimation() : nullptr;
 }
 
 void Animator::SetTrigger(const std::string& name)
 {
-	if (m_CurrentState)
-		m_CurrentState->SetTrigger(name);
+	if (!m_CurrentState)
+		return;
+
+	Transition* transition = m_CurrentState->GetTriggerTransition(name);
+	if (!transition)
+		return;
+
+	if (m_Recording)
+		m_Recording->AddEvent(AnimationEventType::Trigger, name);
+	OnStateFinished(m_CurrentState, transition);
 }
 
 void Animator::SetFloat(const std::string& name, float value)
 {
-	if (m_CurrentState)
-		m_CurrentState->SetVar<float>(name, value);
+	if (!m_CurrentState || !m_CurrentState->SetVar<float>(name, value))
+		return;
+
+	if (m_Recording)
+		m_Recording->AddEvent(AnimationEventType::Float, name, value);
+	WakeUp();
 }
 
 void Animator::OnStateFinished(const AnimationState* state, Transition* nextTransition)
 {
-	std::cout << "State " << state->GetName() << " completed" << std::endl;
-
 	S_ASSERT(state == m_CurrentState);
 	S_ASSERT(!m_CurrentTransition);
 
-	std::cout << "Transitioning to state " << nextTransition->GetTargetState()->GetName() << std::endl;
-
 	m_CurrentState = nullptr;
 	m_CurrentTransition = nextTransition;
+	WakeUp();
 }
 
 void Animator::OnTransitionFinished(const Transition* transition)
@@ -62,52 +463,91 @@ void Animator::OnTransitionFinished(const Transition* transition)
 	S_ASSERT(transition == m_CurrentTransition);
 	S_ASSERT(!m_CurrentState);
 
-	std::cout << "In state " << transition->GetTargetState()->GetName() << std::endl;
-
 	m_CurrentTransition = nullptr;
 	transition->GetSourceState()->Reset();
 	m_CurrentState = transition->GetTargetState();
 }
 
-void Animator::UpdateSkinningMatrices(const SkeletonNode& node, const glm::mat4& parentTransform)
+void Animator::UpdateJointTransforms(const PoseBuffer& pose)
 {
-	// Default value if this node is not animated
-	glm::mat4 localTransform = node.Transform;
-
-	const std::unordered_map<std::string, LocalPose>& localPoses = GetLocalPoses();
-	if (localPoses.find(node.Name) != localPoses.end())
+	if (m_JointMask)
 	{
-		// This joint is animated, so use its animated pose instead
-		const LocalPose& localPose = localPoses.at(node.Name);
-
-		localTransform = glm::translate(glm::mat4(1.0f), localPose.Translation)
-			* glm::toMat4(localPose.Rotation)
-			* glm::scale(glm::mat4(1.0f), localPose.Scale);
+		// Nothing gets rendered, so the masked model space transforms are all we need
+		S_PROFILE_SCOPE("Animator::UpdateJointTransforms");
+		PoseHelper::LocalToModel(m_JointDirectory->GetFlatNodes(), pose, *m_JointMask, m_ModelSpaceTransforms);
+		return;
 	}
 
-	glm::mat4 modelSpaceTransform = parentTransform * localTransform;
+	UpdateSkinningMatrices(pose);
+	UpdateBounds();
+}
 
-	// If this is a joint (i.e. is bound to a vertex), update its skinning matrix
-	if (m_JointDirectory->ContainsJoint(node.Name))
+void Animator::UpdateSkinningMatrices(const PoseBuffer& pose)
+{
+	S_PROFILE_SCOPE("Animator::UpdateSkinningMatrices");
+	S_ALLOCATION_SCOPE("Skinning");
+
+	const std::vector<FlatSkeletonNode>& nodes = m_JointDirectory->GetFlatNodes();
+
+	// Skeletons may have more joints than the shader supports (e.g. generated ones); only the first MAX_TOTAL_JOINTS get rendered
+	if ((int)m_SkinningMatrices.size() < m_JointDirectory->GetNumJoints())
+		m_SkinningMatrices.resize(m_JointDirectory->GetNumJoints(), glm::mat4(1.0f));
+
+	PoseHelper::LocalToModel(nodes, pose, m_ModelSpaceTransforms);
+	PoseHelper::BuildSkinningMatrices(nodes, m_ModelSpaceTransforms, m_SkinningMatrices);
+	m_PaletteVersion++;
+}
+
+const std::vector<float>& Animator::GetPalette()
+{
+	if (m_PackedPaletteVersion != m_PaletteVersion)
 	{
-		const Joint& joint = m_JointDirectory->GetJoint(node.Name);
-		glm::mat4 skinningMatrix = modelSpaceTransform * joint.InverseBindPose;
-		if (skinningMatrix != glm::mat4(1.0f))
-			m_SkinningMatrices[joint.Id] = skinningMatrix;
+		S_PROFILE_SCOPE("Animator::GetPalette");
+		S_ALLOCATION_SCOPE("Skinning");
+
+		size_t numJoints = glm::min((size_t)m_JointDirectory->GetNumJoints(), m_SkinningMatrices.size());
+		m_Palette.resize(numJoints * PaletteHelper::GetFloatsPerJoint(m_PaletteFormat));
+		PaletteHelper::Pack(m_PaletteFormat, m_SkinningMatrices.data(), numJoints, m_Palette.data());
+		m_PackedPaletteVersion = m_PaletteVersion;
 	}
+	return m_Palette;
+}
 
-	// Recursively update skinning matrices of node's children
-	for (uint32_t i = 0; i < node.Children.size(); i++)
-		UpdateSkinningMatrices(node.Children[i], modelSpaceTransform);
+void Animator::UpdateBounds()
+{
+	S_PROFILE_SCOPE("Animator::UpdateBounds");
+	m_Bounds = GetJointBounds(*m_JointDirectory, m_ModelSpaceTransforms);
 }
 
-const std::unordered_map<std::string, LocalPose>& Animator::GetLocalPoses() const
+void Animator::UpdateHiddenBounds()
 {
+	// Poses aren't sampled while hidden, so fit any pose the playing animations can reach
+	float extraReach = 0.0f;
 	if (m_CurrentTransition)
-		return m_CurrentTransition->GetLocalPoses();
+	{
+		extraReach = glm::max(m_CurrentTransition->GetSourceState()->GetAnimation()->GetExtraJointReach(),
+							  m_CurrentTransition->GetTargetState()->GetAnimation()->GetExtraJointReach());
+	}
 	else if (m_CurrentState)
-		return m_CurrentState->GetLocalPoses();
-	
-	S_ASSERT(false); // Animator has neither state nor transition set
-	return std::unordered_map<std::string, LocalPose>();
+	{
+		extraReach = m_CurrentState->GetAnimation()->GetExtraJointReach();
+	}
+
+	float reach = m_MaxJointReach + extraReach;
+	m_Bounds.Min = glm::min(m_Bounds.Min, glm::vec3(-reach));
+	m_Bounds.Max = glm::max(m_Bounds.Max, glm::vec3(reach));
+}
+
+void Animator::ReportMemory(MemoryReport& report, const std::string& name) const
+{
+	size_t bytes = sizeof(*this) + MemoryHelper::GetVectorBytes(m_ModelSpaceTransforms) + MemoryHelper::GetVectorBytes(m_SkinningMatrices)
+		+ MemoryHelper::GetVectorBytes(m_Palette) + MemoryHelper::GetVectorBytes(m_QueryTransforms) + MemoryHelper::GetVectorBytes(m_QueryGenerations)
+		+ MemoryHelper::GetVectorBytes(m_QueryChain);
+	for (const PoseBuffer* pose : { &m_PreviousPose, &m_CurrentPose, &m_RenderPose })
+	{
+		bytes += MemoryHelper::GetVectorBytes(pose->Translations) + MemoryHelper::GetVectorBytes(pose->Rotations)
+			+ MemoryHelper::GetVectorBytes(pose->Scales);
+	}
+
+	report.Add("Animators", name, bytes);
 }
\ No newline at end of file
@@ -2,21 +2,70 @@
 
 #include "AnimationState.h"
 #include "AnimationClip.h"
+#include "PoseBuffer.h"
+#include "AnimationLod.h"
+#include "BoundingBox.h"
+#include "JointMask.h"
+#include "PaletteFormat.h"
 
-#include "../Core.h"
+#include "Core.h"
 
+class MemoryReport;
+class AnimationRecording;
+class PoseCache;
+
+//! Drives the animation graph of a single character instance
 class Animator
 {
-protected:
-	Animator();
 public:
-	~Animator();
+	Animator();
 
-	void SetDirectory(const std::shared_ptr<JointDirectory>& jointDirectory) { m_JointDirectory = jointDirectory; }
-	void SetState(AnimationState* state) { S_ASSERT(!m_CurrentState); m_CurrentState = state; }
+	//! Also starts the bounds off around the skeleton's default pose, so it can be culled before its first update
+	void SetDirectory(const std::shared_ptr<JointDirectory>& jointDirectory);
+	void SetState(AnimationState* state) { S_ASSERT(!m_CurrentState); m_CurrentState = state; WakeUp(); }
 
 	void Update(float deltaTime);
 
+	//! Tick the animation graph at a fixed rate (e.g. 30 Hz) instead of once per Update, and
+	//! produce the rendered pose by interpolating between the two most recent ticks.
+	//! A rate of 0 disables this, so the graph is ticked with each Update's delta time.
+	void SetFixedUpdateRate(float ticksPerSecond);
+
+	void SetLodSettings(const std::shared_ptr<AnimationLodSettings>& lodSettings) { m_LodSettings = lodSettings; m_LodTierIndex = 0; WakeUp(); }
+	//! Pick this instance's LOD tier from its distance to the camera (see Camera::GetPosition)...
+	void SetLodFromDistance(float distanceToCamera);
+	//! ...or from an explicit importance in range [0, 1]
+	void SetLodFromImportance(float importance);
+	//! ...or set the tier directly (e.g. when replaying a recording)
+	void SetLodTierIndex(int tierIndex);
+
+	int GetLodTierIndex() const { return m_LodTierIndex; }
+	const AnimationLodTier& GetLodTier() const;
+
+	//! Off-screen animators only advance the time of their states and transitions; they don't sample
+	//! poses or build skinning matrices. Their bounds grow to a box around the model's origin that fits any
+	//! pose the playing animations can reach (see AnimationNode::GetExtraJointReach).
+	void SetVisible(bool isVisible);
+	bool IsVisible() const { return m_IsVisible; }
+
+	//! Whether the animation graph should produce poses this update, or just move time forward
+	bool ShouldSamplePoses() const { return m_IsVisible; }
+
+	//! A paused animator keeps its current pose, and its time does not advance
+	void SetPaused(bool isPaused);
+
+	//! Sleeping animators skip their updates entirely, because nothing that affects their pose has changed:
+	//! they are paused, or have been holding a frozen state (see AnimationState::IsFrozen) since their last update.
+	//! Triggers that start a transition, changed parameters, visibility or LOD tier wake them up again.
+	bool IsSleeping() const { return m_IsPaused || m_IsSleeping; }
+
+	//! Incremented whenever the skinning matrices change, so renderers can skip re-uploading an unchanged palette
+	uint32_t GetPaletteVersion() const { return m_PaletteVersion; }
+
+	//! Model space bounds of the skinned mesh, from the joint positions of the last sampled pose, or the default
+	//! pose before the first one. Conservative while the animator isn't visible (see SetVisible).
+	const BoundingBox& GetBounds() const { return m_Bounds; }
+
 	void SetTrigger(const std::string& name);
 	void SetFloat(const std::string& name, float value);
 
@@ -25,22 +74,125 @@ public:
 
 	bool IsTransitioning() const { return m_CurrentTransition; }
 
+	//! The animation whose data this animator's next update reads the most of: its current state's, or the source
+	//! state's during a transition. AnimationScheduler groups animators by it.
+	const AnimationNode* GetMainAnimation() const;
+
+	//! Adds every input this animator receives from now on to the recording, until it's set to nullptr
+	void SetRecording(AnimationRecording* recording) { m_Recording = recording; }
+
 	//! Describes each joint's offset from its bind pose
 	const std::vector<glm::mat4>& GetSkinningMatrices() const { return m_SkinningMatrices; }
-	
-	static Animator* GetInstance() { S_ASSERT(s_Instance); return s_Instance; }
+
+	//! Format GetPalette packs the skinning matrices into, e.g. to upload a quarter or half less per character
+	void SetPaletteFormat(PaletteFormat format) { m_PaletteFormat = format; m_PackedPaletteVersion = UINT32_MAX; }
+	PaletteFormat GetPaletteFormat() const { return m_PaletteFormat; }
+
+	//! The skinning matrices of every joint in the palette format, packed when first asked for after they change
+	const std::vector<float>& GetPalette();
+
+	//! Headless mode for servers, which only need a few joints for hitboxes and attachments: only the mask's nodes are
+	//! sampled and transformed to model space, and no skinning matrices or bounds are built. nullptr animates everything.
+	void SetJointMask(const std::shared_ptr<JointMask>& mask);
+	const JointMask* GetJointMask() const { return m_JointMask.get(); }
+
+	//! Model space transform of a node in the last sampled pose, indexed like JointDirectory::GetFlatNodes.
+	//! With a joint mask, only the mask's nodes are up to date.
+	const glm::mat4& GetModelSpaceTransform(int nodeIndex) const;
+
+	//! Shares sampled poses and palettes with other animators playing the same clip at nearly the same time, at the cost
+	//! of lagging up to the cache's quantum behind (see PoseCache). Only used while in a state that plays a clip directly,
+	//! without a joint mask or fixed update rate. nullptr samples every pose.
+	void SetPoseCache(const std::shared_ptr<PoseCache>& poseCache) { m_PoseCache = poseCache; }
+
+	//! Model space transform of a single node in the graph's current pose, found by sampling just the node and its
+	//! ancestors (e.g. for attachment points, hitboxes and IK targets). Results are kept until the graph moves on, so
+	//! later queries only sample ancestors no earlier query has needed. In fixed update mode this is the latest tick,
+	//! not the pose interpolated for rendering.
+	const glm::mat4& QueryModelSpaceTransform(int nodeIndex);
+
+	//! Adds this instance's own memory (not its shared clips and skeleton) to the report's "Animators"
+	void ReportMemory(MemoryReport& report, const std::string& name) const;
 private:
-	void UpdateSkinningMatrices(const SkeletonNode& node, const glm::mat4& parentTransform);
-	const std::unordered_map<std::string, LocalPose>& GetLocalPoses() const;
+	void WakeUp();
+	void UpdatePose(float deltaTime);
+	void Simulate(float deltaTime);
+	void AdvanceGraph(float deltaTime);
+	bool UpdateFromPoseCache();
+	void EvaluatePose(PoseBuffer& pose);
+	void EvaluateGraph(const EvaluationContext& context, PoseView pose);
+	void UpdateJointTransforms(const PoseBuffer& pose);
+	void UpdateSkinningMatrices(const PoseBuffer& pose);
+	void UpdateBounds();
+	void UpdateHiddenBounds();
 private:
 	static constexpr int MAX_TOTAL_JOINTS = 100;
-	static Animator* s_Instance;
+
+	//! If we fall further behind than this many fixed ticks, drop the extra time rather than spiral
+	static constexpr int MAX_FIXED_UPDATES_PER_FRAME = 4;
+
+	//! Two, so both poses we interpolate between in fixed update mode are frozen before we stop updating
+	static constexpr int FROZEN_TICKS_BEFORE_SLEEP = 2;
 
 	std::shared_ptr<JointDirectory> m_JointDirectory;
 
-	AnimationState* m_CurrentState;
-	Transition* m_CurrentTransition;
+	AnimationState* m_CurrentState = nullptr;
+	Transition* m_CurrentTransition = nullptr;
+
+	bool m_IsVisible = true;
+
+	bool m_IsPaused = false;
+	bool m_IsSleeping = false;
+	int m_NumFrozenTicks = 0;
+	uint32_t m_PaletteVersion = 0;
+
+	BoundingBox m_Bounds;
+
+	//! Furthest any joint's extent can get from the model's origin, with bones at their default lengths and every
+	//! joint rotated as far out as it goes
+	float m_MaxJointReach = 0.0f;
+
+	AnimationRecording* m_Recording = nullptr;
+
+	std::shared_ptr<JointMask> m_JointMask;
+	std::shared_ptr<PoseCache> m_PoseCache;
+
+	std::shared_ptr<AnimationLodSettings> m_LodSettings;
+	int m_LodTierIndex = 0;
+
+	//! Updates skipped due to the LOD tier's update interval, and the time that passed during them
+	int m_NumSkippedUpdates = 0;
+	float m_SkippedTime = 0.0f;
+
+	//! Seconds per fixed tick, or 0 if the graph is ticked once per Update
+	float m_FixedTimeStep = 0.0f;
+	float m_TimeAccumulator = 0.0f;
+	bool m_HasSimulated = false;
+
+	//! The two most recently simulated poses, and the pose interpolated between them for rendering
+	PoseBuffer m_PreviousPose;
+	PoseBuffer m_CurrentPose;
+	PoseBuffer m_RenderPose;
+
+	//! Scratch storage for each skeleton node's model space transform, indexed like PoseBuffer
+	std::vector<glm::mat4> m_ModelSpaceTransforms;
 
 	//! Final matrix describes each joint's offset from its bind pose
 	std::vector<glm::mat4> m_SkinningMatrices;
+
+	PaletteFormat m_PaletteFormat = PaletteFormat::Matrix4x4;
+	std::vector<float> m_Palette;
+
+	//! m_PaletteVersion when m_Palette was last packed
+	uint32_t m_PackedPaletteVersion = UINT32_MAX;
+
+	//! Model space transforms worked out by QueryModelSpaceTransform, each valid if its node's entry in m_QueryGenerations
+	//! matches m_QueryGeneration, which moves on whenever the pose may have changed
+	std::vector<glm::mat4> m_QueryTransforms;
+	std::vector<uint32_t> m_QueryGenerations;
+	uint32_t m_QueryGeneration = 1;
+
+	//! Scratch for the nodes a query still has to sample, from the queried node up
+	std::vector<int> m_QueryChain;
+	JointMask m_QueryMask;
 };
\ No newline at end of file
@@ -0,0 +1,113 @@
+// Everything that depends on Assimp to load skeletons and animation clips from model files lives here,
+// so the rest of the animation runtime can be built without it.
+
+#include "AnimationClip.h"
+#include "JointClip.h"
+#include "JointDirectory.h"
+
+#include "Core.h"
+#include "AssimpHelper.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+JointClip::JointClip(const std::string& name, const aiNodeAnim* channel)
+	: m_Name(name)
+{
+	m_IsDetailJoint = AnimationLodSettings::IsDetailJoint(name);
+
+	uint32_t numPositions = channel->mNumPositionKeys;
+	m_PositionKeys.reserve(numPositions);
+	for (uint32_t i = 0; i < numPositions; i++)
+	{
+		aiVector3D& pos = channel->mPositionKeys[i].mValue;
+		float timestamp = channel->mPositionKeys[i].mTime;
+
+		PositionKeyFrame posKey = { glm::vec3(pos.x, pos.y, pos.z), timestamp};
+		m_PositionKeys.push_back(posKey);
+	}
+
+	m_RotationKeys.reserve(channel->mNumRotationKeys);
+	for (uint32_t i = 0; i < channel->mNumRotationKeys; i++)
+	{
+		aiQuaternion& rot = channel->mRotationKeys[i].mValue;
+		float timestamp = channel->mRotationKeys[i].mTime;
+
+		RotationKeyFrame rotKey = { glm::quat(rot.w, rot.x, rot.y, rot.z), timestamp };
+		m_RotationKeys.push_back(rotKey);
+	}
+
+	m_ScaleKeys.reserve(channel->mNumScalingKeys);
+	for (uint32_t i = 0; i < channel->mNumScalingKeys; i++)
+	{
+		aiVector3D& scale = channel->mScalingKeys[i].mValue;
+		float timestamp = channel->mScalingKeys[i].mTime;
+
+		ScaleKeyFrame scaleKey = { glm::vec3(scale.x, scale.y, scale.z), timestamp };
+		m_ScaleKeys.push_back(scaleKey);
+	}
+}
+
+void JointDirectory::ParseRootNode(const aiNode* rootNode)
+{
+	// TODO: Verify that it's indeed safe to only parse the skeleton once for all animations of the same model
+	if (m_RootNode.Children.empty())
+	{
+		ReadNode(m_RootNode, rootNode);
+		FlattenNode(m_RootNode, -1);
+	}
+}
+
+void JointDirectory::ReadNode(SkeletonNode& dstNode, const aiNode* srcNode)
+{
+	S_ASSERT(srcNode);
+
+	dstNode.Name = std::string(srcNode->mName.C_Str());
+	dstNode.Transform = AssimpHelper::AssimpToGlmMatrix(srcNode->mTransformation);
+
+	for (uint32_t i = 0; i < srcNode->mNumChildren; i++)
+	{
+		SkeletonNode childNode;
+		ReadNode(childNode, srcNode->mChildren[i]);
+		dstNode.Children.push_back(childNode);
+	}
+}
+
+AnimationClip::AnimationClip(const std::string& filePath, const std::shared_ptr<JointDirectory>& jointDirectory,
+							 bool shouldExtractRootMotion, bool useLocalTime)
+	: m_UsesLocalTime(useLocalTime), m_JointDirectory(jointDirectory)
+{
+	m_Name = filePath.substr(filePath.find_last_of('/') + 1);
+
+	Assimp::Importer importer;
+	const aiScene* scene = importer.ReadFile(filePath, aiProcess_Triangulate);
+	S_ASSERT(scene && scene->mRootNode);
+
+	// TODO: Let's not hardcode just grabbing the first animation
+	aiAnimation* animation = scene->mAnimations[0];
+	m_LocalDuration = animation->mDuration;
+	m_LocalTicksPerSecond = animation->mTicksPerSecond;
+
+	m_JointDirectory->ParseRootNode(scene->mRootNode);
+	CreateJointClips(animation);
+	BindSkeleton(*m_JointDirectory);
+
+	if (shouldExtractRootMotion)
+		ExtractRootMotion(*m_JointDirectory);
+}
+
+void AnimationClip::CreateJointClips(const aiAnimation* animation)
+{
+	// Note: There may be joints here that were not present when we parsed the mesh
+	// i.e. joints that are not bound to vertices, but which still move and affect
+	// the transforms of their child joints
+	for (uint32_t i = 0; i < animation->mNumChannels; i++)
+	{
+		aiNodeAnim* channel = animation->mChannels[i];
+
+		std::string jointName = std::string(channel->mNodeName.C_Str());
+
+		AddJointClip(JointClip(jointName, channel));
+	}
+}
\ No newline at end of file
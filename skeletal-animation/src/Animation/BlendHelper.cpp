@@ -1,26 +1,83 @@
 #include "BlendHelper.h"
 
-#include "../Core.h"
+#include "Core.h"
+#include "AllocationTracker.h"
+#include "Profiler.h"
 #include <glm/gtc/quaternion.hpp>
 
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define BLEND_HELPER_USE_SSE2
+#endif
+
 namespace BlendHelper
 {
-	void BlendPoses(std::unordered_map<std::string, LocalPose>& blendedPoses,
-					const std::unordered_map<std::string, LocalPose>& sourcePoses,
-					const std::unordered_map<std::string, LocalPose>& targetPoses,
-					float t)
+#ifdef BLEND_HELPER_USE_SSE2
+	//! Sum of all four lanes of v, broadcast to every lane
+	static inline __m128 HorizontalSum(__m128 v)
 	{
-		S_ASSERT(sourcePoses.size() == targetPoses.size());
+		__m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+		__m128 sums = _mm_add_ps(v, shuffled);
+		shuffled = _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 0, 3, 2));
+		return _mm_add_ps(sums, shuffled);
+	}
+#endif
+
+	static void NlerpRotations(glm::quat* blended, const glm::quat* source, const glm::quat* target, size_t count, float t)
+	{
+#ifdef BLEND_HELPER_USE_SSE2
+		const __m128 weight = _mm_set1_ps(t);
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		for (size_t i = 0; i < count; i++)
+		{
+			__m128 a = _mm_loadu_ps(reinterpret_cast<const float*>(source + i));
+			__m128 b = _mm_loadu_ps(reinterpret_cast<const float*>(target + i));
 
-		for (auto& [name, sourcePose] : sourcePoses)
+			// Negate the target if the two rotations lie in opposite hemispheres, so we take the short way round
+			__m128 cosTheta = HorizontalSum(_mm_mul_ps(a, b));
+			b = _mm_xor_ps(b, _mm_and_ps(cosTheta, signMask));
+
+			__m128 q = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), weight));
+			q = _mm_div_ps(q, _mm_sqrt_ps(HorizontalSum(_mm_mul_ps(q, q))));
+			_mm_storeu_ps(reinterpret_cast<float*>(blended + i), q);
+		}
+#else
+		for (size_t i = 0; i < count; i++)
 		{
-			const LocalPose& targetPose = targetPoses.at(name);
+			glm::quat b = glm::dot(source[i], target[i]) < 0.0f ? -target[i] : target[i];
+			blended[i] = glm::normalize(source[i] * (1.0f - t) + b * t);
+		}
+#endif
+	}
 
-			glm::vec3 translation = glm::mix(sourcePose.Translation, targetPose.Translation, t);
-			glm::quat rotation = glm::slerp(sourcePose.Rotation, targetPose.Rotation, t);
-			glm::vec3 scale = glm::mix(sourcePose.Scale, targetPose.Scale, t);
+	void BlendPoses(PoseView blendedPose, PoseView sourcePose, PoseView targetPose, float t)
+	{
+		S_PROFILE_SCOPE("BlendHelper::BlendPoses");
+		S_ALLOCATION_SCOPE("Blending");
 
-			blendedPoses[name] = { sourcePose.JointName, translation, rotation, scale };
+		S_ASSERT(sourcePose.Size == targetPose.Size && blendedPose.Size == sourcePose.Size);
+
+		for (size_t i = 0; i < sourcePose.Size; i++)
+		{
+			blendedPose.Translations[i] = glm::mix(sourcePose.Translations[i], targetPose.Translations[i], t);
+			blendedPose.Rotations[i] = glm::slerp(sourcePose.Rotations[i], targetPose.Rotations[i], t);
+			blendedPose.Scales[i] = glm::mix(sourcePose.Scales[i], targetPose.Scales[i], t);
+		}
+	}
+
+	void NlerpPoses(PoseView blendedPose, PoseView sourcePose, PoseView targetPose, float t)
+	{
+		S_PROFILE_SCOPE("BlendHelper::NlerpPoses");
+		S_ALLOCATION_SCOPE("Blending");
+
+		S_ASSERT(sourcePose.Size == targetPose.Size && blendedPose.Size == sourcePose.Size);
+
+		size_t numNodes = sourcePose.Size;
+		for (size_t i = 0; i < numNodes; i++)
+		{
+			blendedPose.Translations[i] = glm::mix(sourcePose.Translations[i], targetPose.Translations[i], t);
+			blendedPose.Scales[i] = glm::mix(sourcePose.Scales[i], targetPose.Scales[i], t);
 		}
+		NlerpRotations(blendedPose.Rotations, sourcePose.Rotations, targetPose.Rotations, numNodes, t);
 	}
 }
\ No newline at end of file
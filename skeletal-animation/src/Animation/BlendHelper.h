@@ -1,11 +1,14 @@
 #pragma once
 
 #include "AnimationNode.h"
+#include "PoseBuffer.h"
 
 namespace BlendHelper
 {
-	void BlendPoses(std::unordered_map<std::string, LocalPose>& blendedPoses,
-					const std::unordered_map<std::string, LocalPose>& sourcePoses,
-					const std::unordered_map<std::string, LocalPose>& targetPoses,
-					float t);
+	//! Slerps rotations, for blending between different animations. blendedPose may be the same as either input.
+	void BlendPoses(PoseView blendedPose, PoseView sourcePose, PoseView targetPose, float t);
+
+	//! Normalised lerp between two flat poses. Cheaper than slerp and accurate for the small
+	//! angular differences between consecutive poses of the same animation. blendedPose may be the same as either input.
+	void NlerpPoses(PoseView blendedPose, PoseView sourcePose, PoseView targetPose, float t);
 }
\ No newline at end of file
@@ -1,13 +1,17 @@
 #include "BlendNode.h"
 
 #include "BlendHelper.h"
-#include "../Core.h"
+#include "PoseHelper.h"
+#include "FrameArena.h"
+#include "Core.h"
+#include "Profiler.h"
 
 BlendNode::BlendNode(AnimationNode* sourceNode, AnimationNode* targetNode)
 	: m_SourceNode(sourceNode), m_TargetNode(targetNode)
 {
 	m_Duration = 1.0f;
 	m_SourceTpsScale = m_TargetNode->GetDuration() / m_SourceNode->GetDuration();
+	SetTargetWeight(0.0f);
 }
 
 void BlendNode::SetTargetWeight(float targetWeight)
@@ -19,10 +23,28 @@ void BlendNode::SetTargetWeight(float targetWeight)
 	m_TicksPerSecond = glm::mix(30.0f / m_SourceNode->GetDuration(), 30.0f / m_TargetNode->GetDuration(), targetWeight);
 }
 
-void BlendNode::UpdateLocalPoses(float animationTime)
+float BlendNode::GetExtraJointReach() const
 {
-	m_SourceNode->UpdateLocalPoses(animationTime);
-	m_TargetNode->UpdateLocalPoses(animationTime);
+	return glm::max(m_SourceNode->GetExtraJointReach(), m_TargetNode->GetExtraJointReach());
+}
+
+void BlendNode::Evaluate(float animationTime, const EvaluationContext& context, PoseView pose)
+{
+	S_PROFILE_SCOPE("BlendNode::Evaluate");
+
+	if (context.Lod.PruneBlendBranches)
+	{
+		AnimationNode* dominantNode = m_TargetWeight < 0.5f ? m_SourceNode : m_TargetNode;
+		dominantNode->Evaluate(animationTime, context, pose);
+		return;
+	}
+
+	// The source is evaluated straight into the output, so only the target needs scratch space
+	FrameArena::Scope scratchScope(context.Arena);
+	PoseView targetPose = PoseHelper::AllocatePose(context.Arena, pose.Size);
+
+	m_SourceNode->Evaluate(animationTime, context, pose);
+	m_TargetNode->Evaluate(animationTime, context, targetPose);
 
-	BlendHelper::BlendPoses(m_LocalPoses, m_SourceNode->GetLocalPoses(), m_TargetNode->GetLocalPoses(), m_TargetWeight);
+	BlendHelper::BlendPoses(pose, pose, targetPose, m_TargetWeight);
 }
\ No newline at end of file
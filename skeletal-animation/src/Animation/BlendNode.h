@@ -9,15 +9,14 @@ public:
 
 	void SetTargetWeight(float targetWeight);
 
-	void UpdateLocalPoses(float animationTime) override;
-	const std::unordered_map<std::string, LocalPose>& GetLocalPoses() const override { return m_LocalPoses; };
+	void Evaluate(float animationTime, const EvaluationContext& context, PoseView pose) override;
 
 	float GetTicksPerSecond() const override { return m_TicksPerSecond; }
 	float GetDuration() const override { return m_Duration; }
+	float GetExtraJointReach() const override;
 private:
 	AnimationNode* m_SourceNode;
 	AnimationNode* m_TargetNode;
-	std::unordered_map<std::string, LocalPose> m_LocalPoses;
 
 	float m_TargetWeight;
 	float m_Duration;
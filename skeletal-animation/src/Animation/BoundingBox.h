@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+struct BoundingBox
+{
+	glm::vec3 Min = glm::vec3(0.0f);
+	glm::vec3 Max = glm::vec3(0.0f);
+
+	//! Smallest axis-aligned box containing this box after it has been transformed by the given matrix
+	BoundingBox Transformed(const glm::mat4& transform) const
+	{
+		// Arvo's method: each axis of the new box only depends on the signs of the matrix entries
+		BoundingBox box;
+		box.Min = box.Max = glm::vec3(transform[3]);
+		for (int col = 0; col < 3; col++)
+		{
+			for (int row = 0; row < 3; row++)
+			{
+				float a = transform[col][row] * Min[col];
+				float b = transform[col][row] * Max[col];
+				box.Min[row] += glm::min(a, b);
+				box.Max[row] += glm::max(a, b);
+			}
+		}
+		return box;
+	}
+};
\ No newline at end of file
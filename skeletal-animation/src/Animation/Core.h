@@ -0,0 +1,9 @@
+#pragma once
+
+#if defined(_MSC_VER)
+	#define S_DEBUGBREAK() __debugbreak()
+#else
+	#define S_DEBUGBREAK() __builtin_trap()
+#endif
+
+#define S_ASSERT(x) { if (!(x)) S_DEBUGBREAK(); }
\ No newline at end of file
@@ -0,0 +1,259 @@
+#include "CpuSkinning.h"
+
+#include "AllocationTracker.h"
+#include "Core.h"
+#include "MemoryReport.h"
+#include "Profiler.h"
+
+#include <cmath>
+
+// AVX holds half a matrix per register, so blending takes half the instructions; it's only used when the compiler
+// targets it (e.g. -mavx or /arch:AVX), since the default x64 target only guarantees SSE2
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define CPU_SKINNING_USE_AVX
+#elif defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define CPU_SKINNING_USE_SSE2
+#endif
+
+static constexpr int MAX_INFLUENCES = CpuSkinningSource::MAX_INFLUENCES;
+
+template <typename T>
+static const T* GetAttribute(const T* first, size_t stride, size_t index)
+{
+	return reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(first) + stride * index);
+}
+
+static int CountInfluences(const CpuSkinningSource& source, size_t index)
+{
+	const int* jointIds = GetAttribute(source.JointIds, source.Stride, index);
+	int count = 0;
+	for (int i = 0; i < MAX_INFLUENCES; i++)
+	{
+		if (jointIds[i] >= 0)
+			count++;
+	}
+	return count;
+}
+
+#if defined(CPU_SKINNING_USE_AVX) || defined(CPU_SKINNING_USE_SSE2)
+//! Sum of all four lanes of v, broadcast to every lane
+static inline __m128 HorizontalSum(__m128 v)
+{
+	__m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+	__m128 sums = _mm_add_ps(v, shuffled);
+	shuffled = _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 0, 3, 2));
+	return _mm_add_ps(sums, shuffled);
+}
+
+//! v divided by its length, or v itself when it has none, so a degenerate normal doesn't become NaN
+static inline __m128 NormalizeOrKeep(__m128 v)
+{
+	__m128 lengthSquared = HorizontalSum(_mm_mul_ps(v, v));
+	__m128 hasLength = _mm_cmpgt_ps(lengthSquared, _mm_setzero_ps());
+	__m128 normalized = _mm_div_ps(v, _mm_sqrt_ps(lengthSquared));
+	return _mm_or_ps(_mm_and_ps(hasLength, normalized), _mm_andnot_ps(hasLength, v));
+}
+
+static inline void StoreVec3(glm::vec3& destination, __m128 v)
+{
+	alignas(16) float values[4];
+	_mm_store_ps(values, v);
+	destination = glm::vec3(values[0], values[1], values[2]);
+}
+#endif
+
+void CpuSkinning::Build(const CpuSkinningSource& source, const CpuSkinningSettings& settings)
+{
+	S_PROFILE_SCOPE("CpuSkinning::Build");
+	S_ALLOCATION_SCOPE("CpuSkinning");
+
+	S_ASSERT(source.Positions && source.Normals && source.JointIds && source.Weights && source.Stride > 0);
+	S_ASSERT(source.NumVertices <= UINT32_MAX && settings.ChunkSize > 0);
+	m_Settings = settings;
+
+	// Counting sort by influence count, keeping the mesh's order within each group
+	auto getGroup = [&](size_t index)
+	{
+		int numInfluences = CountInfluences(source, index);
+		return settings.GroupByInfluenceCount || numInfluences == 0 ? numInfluences : MAX_INFLUENCES;
+	};
+
+	size_t groupStarts[MAX_INFLUENCES + 1] = {};
+	for (size_t& groupEnd : m_GroupEnds)
+		groupEnd = 0;
+	for (size_t i = 0; i < source.NumVertices; i++)
+		m_GroupEnds[getGroup(i)]++;
+	for (int group = 1; group <= MAX_INFLUENCES; group++)
+	{
+		groupStarts[group] = m_GroupEnds[group - 1];
+		m_GroupEnds[group] += m_GroupEnds[group - 1];
+	}
+
+	m_Positions.resize(source.NumVertices);
+	m_Normals.resize(source.NumVertices);
+	m_JointIds.resize(source.NumVertices * MAX_INFLUENCES);
+	m_Weights.resize(source.NumVertices * MAX_INFLUENCES);
+	m_OriginalIndices.resize(source.NumVertices);
+	m_MaxJointId = -1;
+
+	for (size_t i = 0; i < source.NumVertices; i++)
+	{
+		size_t destination = groupStarts[getGroup(i)]++;
+		m_Positions[destination] = glm::vec4(*GetAttribute(source.Positions, source.Stride, i), 1.0f);
+		m_Normals[destination] = glm::vec4(*GetAttribute(source.Normals, source.Stride, i), 0.0f);
+		m_OriginalIndices[destination] = (uint32_t)i;
+
+		const int* jointIds = GetAttribute(source.JointIds, source.Stride, i);
+		const float* weights = GetAttribute(source.Weights, source.Stride, i);
+		int32_t* destinationIds = &m_JointIds[destination * MAX_INFLUENCES];
+		float* destinationWeights = &m_Weights[destination * MAX_INFLUENCES];
+		int numUsed = 0;
+		for (int influence = 0; influence < MAX_INFLUENCES; influence++)
+		{
+			if (jointIds[influence] < 0)
+				continue;
+
+			destinationIds[numUsed] = jointIds[influence];
+			destinationWeights[numUsed] = weights[influence];
+			m_MaxJointId = glm::max(m_MaxJointId, (int32_t)jointIds[influence]);
+			numUsed++;
+		}
+		for (; numUsed < MAX_INFLUENCES; numUsed++)
+		{
+			destinationIds[numUsed] = 0;
+			destinationWeights[numUsed] = 0.0f;
+		}
+	}
+}
+
+size_t CpuSkinning::GetNumVerticesWithInfluences(int numInfluences) const
+{
+	S_ASSERT(numInfluences >= 0 && numInfluences <= MAX_INFLUENCES);
+	return m_GroupEnds[numInfluences] - (numInfluences > 0 ? m_GroupEnds[numInfluences - 1] : 0);
+}
+
+uint32_t CpuSkinning::GetNumChunks() const
+{
+	return (uint32_t)((GetNumVertices() + m_Settings.ChunkSize - 1) / m_Settings.ChunkSize);
+}
+
+void CpuSkinning::Skin(const glm::mat4* skinningMatrices, size_t numJoints, glm::vec3* positions, glm::vec3* normals) const
+{
+	SkinChunks(skinningMatrices, numJoints, positions, normals, 0, GetNumChunks());
+}
+
+void CpuSkinning::SkinChunks(const glm::mat4* skinningMatrices, size_t numJoints, glm::vec3* positions, glm::vec3* normals,
+							 uint32_t firstChunk, uint32_t numChunks) const
+{
+	S_PROFILE_SCOPE("CpuSkinning::SkinChunks");
+	S_ASSERT(m_MaxJointId < (int64_t)numJoints && firstChunk + numChunks <= GetNumChunks());
+
+	size_t chunkBegin = (size_t)firstChunk * m_Settings.ChunkSize;
+	size_t chunkEnd = glm::min((size_t)(firstChunk + numChunks) * m_Settings.ChunkSize, GetNumVertices());
+
+	// Each group's part of the chunks goes through the loop for its influence count
+	for (int group = 0; group <= MAX_INFLUENCES; group++)
+	{
+		size_t begin = glm::max(chunkBegin, group > 0 ? m_GroupEnds[group - 1] : (size_t)0);
+		size_t end = glm::min(chunkEnd, m_GroupEnds[group]);
+		if (begin >= end)
+			continue;
+
+		switch (group)
+		{
+			case 0: SkinRange<0>(skinningMatrices, begin, end, positions, normals); break;
+			case 1: SkinRange<1>(skinningMatrices, begin, end, positions, normals); break;
+			case 2: SkinRange<2>(skinningMatrices, begin, end, positions, normals); break;
+			case 3: SkinRange<3>(skinningMatrices, begin, end, positions, normals); break;
+			default: SkinRange<MAX_INFLUENCES>(skinningMatrices, begin, end, positions, normals); break;
+		}
+	}
+}
+
+template <int NumInfluences>
+void CpuSkinning::SkinRange(const glm::mat4* skinningMatrices, size_t begin, size_t end, glm::vec3* positions,
+							glm::vec3* normals) const
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		glm::vec3& position = positions[m_OriginalIndices[i]];
+		glm::vec3& normal = normals[m_OriginalIndices[i]];
+
+		if constexpr (NumInfluences == 0)
+		{
+			position = glm::vec3(m_Positions[i]);
+			normal = glm::vec3(m_Normals[i]);
+			continue;
+		}
+
+		const int32_t* jointIds = &m_JointIds[i * MAX_INFLUENCES];
+		const float* weights = &m_Weights[i * MAX_INFLUENCES];
+		const glm::vec4& bindPosition = m_Positions[i];
+		const glm::vec4& bindNormal = m_Normals[i];
+
+#if defined(CPU_SKINNING_USE_AVX)
+		// Columns 0 and 1 of the blended matrix in one register, 2 and 3 in the other
+		__m256 low = _mm256_setzero_ps();
+		__m256 high = _mm256_setzero_ps();
+		for (int influence = 0; influence < NumInfluences; influence++)
+		{
+			const float* matrix = &skinningMatrices[jointIds[influence]][0][0];
+			__m256 weight = _mm256_set1_ps(weights[influence]);
+			low = _mm256_add_ps(low, _mm256_mul_ps(_mm256_loadu_ps(matrix), weight));
+			high = _mm256_add_ps(high, _mm256_mul_ps(_mm256_loadu_ps(matrix + 8), weight));
+		}
+
+		__m256 xy = _mm256_set_m128(_mm_set1_ps(bindPosition.y), _mm_set1_ps(bindPosition.x));
+		__m256 zw = _mm256_set_m128(_mm_set1_ps(1.0f), _mm_set1_ps(bindPosition.z));
+		__m256 sums = _mm256_add_ps(_mm256_mul_ps(low, xy), _mm256_mul_ps(high, zw));
+		__m128 skinnedPosition = _mm_add_ps(_mm256_castps256_ps128(sums), _mm256_extractf128_ps(sums, 1));
+
+		xy = _mm256_set_m128(_mm_set1_ps(bindNormal.y), _mm_set1_ps(bindNormal.x));
+		zw = _mm256_set_m128(_mm_setzero_ps(), _mm_set1_ps(bindNormal.z));
+		sums = _mm256_add_ps(_mm256_mul_ps(low, xy), _mm256_mul_ps(high, zw));
+		__m128 skinnedNormal = _mm_add_ps(_mm256_castps256_ps128(sums), _mm256_extractf128_ps(sums, 1));
+
+		StoreVec3(position, skinnedPosition);
+		StoreVec3(normal, NormalizeOrKeep(skinnedNormal));
+#elif defined(CPU_SKINNING_USE_SSE2)
+		__m128 columns[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+		for (int influence = 0; influence < NumInfluences; influence++)
+		{
+			const float* matrix = &skinningMatrices[jointIds[influence]][0][0];
+			__m128 weight = _mm_set1_ps(weights[influence]);
+			for (int column = 0; column < 4; column++)
+				columns[column] = _mm_add_ps(columns[column], _mm_mul_ps(_mm_loadu_ps(matrix + column * 4), weight));
+		}
+
+		__m128 skinnedPosition = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(columns[0], _mm_set1_ps(bindPosition.x)), _mm_mul_ps(columns[1], _mm_set1_ps(bindPosition.y))),
+			_mm_add_ps(_mm_mul_ps(columns[2], _mm_set1_ps(bindPosition.z)), columns[3]));
+		__m128 skinnedNormal = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(columns[0], _mm_set1_ps(bindNormal.x)), _mm_mul_ps(columns[1], _mm_set1_ps(bindNormal.y))),
+			_mm_mul_ps(columns[2], _mm_set1_ps(bindNormal.z)));
+
+		StoreVec3(position, skinnedPosition);
+		StoreVec3(normal, NormalizeOrKeep(skinnedNormal));
+#else
+		glm::mat4 blended(0.0f);
+		for (int influence = 0; influence < NumInfluences; influence++)
+			blended += skinningMatrices[jointIds[influence]] * weights[influence];
+
+		position = glm::vec3(blended * bindPosition);
+		normal = glm::vec3(blended * bindNormal);
+		float normalLength = glm::length(normal);
+		if (normalLength > 0.0f)
+			normal /= normalLength;
+#endif
+	}
+}
+
+void CpuSkinning::ReportMemory(MemoryReport& report, const std::string& name) const
+{
+	size_t bytes = sizeof(*this) + MemoryHelper::GetVectorBytes(m_Positions) + MemoryHelper::GetVectorBytes(m_Normals)
+		+ MemoryHelper::GetVectorBytes(m_JointIds) + MemoryHelper::GetVectorBytes(m_Weights)
+		+ MemoryHelper::GetVectorBytes(m_OriginalIndices);
+	report.Add("CpuSkinning", name, bytes);
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class MemoryReport;
+
+//! Where a mesh's skinning inputs are: interleaved vertex attributes, e.g. the members of the first Vertex of a mesh,
+//! with sizeof(Vertex) as the stride.
+struct CpuSkinningSource
+{
+	static constexpr int MAX_INFLUENCES = 4;
+
+	const glm::vec3* Positions = nullptr;
+	const glm::vec3* Normals = nullptr;
+
+	//! MAX_INFLUENCES joint IDs and weights per vertex; unused influences have an ID of -1
+	const int* JointIds = nullptr;
+	const float* Weights = nullptr;
+
+	size_t NumVertices = 0;
+
+	//! Bytes from one vertex's attributes to the next one's
+	size_t Stride = 0;
+};
+
+struct CpuSkinningSettings
+{
+	//! Sort vertices by how many joints influence them, so the ones with fewer influences blend fewer matrices.
+	//! Otherwise every vertex with any influences blends all four, with the unused ones weighted 0.
+	bool GroupByInfluenceCount = true;
+
+	//! Vertices per chunk (see SkinChunks)
+	uint32_t ChunkSize = 1024;
+};
+
+//! Skins a mesh on the CPU, for when the skinned vertices are needed outside the vertex shader: collision, picking,
+//! bounds, or checking a pose headlessly. Positions match the matrix paths of the skinning shaders (AnimVert.glsl with
+//! whole or 3x4 matrices, and the instanced and baked ones); dual quaternion palettes skin differently.
+//! The mesh's inputs are copied once, by Build, into a layout the SIMD loop can stream through. The output is in the
+//! mesh's own vertex order, so its index buffer still applies. Normals are blended with the same weights as positions,
+//! as the shaders do, and renormalised, which the shaders leave to the fragment shader. Vertices no joint influences
+//! keep their bind pose, on both sides.
+class CpuSkinning
+{
+public:
+	void Build(const CpuSkinningSource& source, const CpuSkinningSettings& settings = CpuSkinningSettings());
+
+	size_t GetNumVertices() const { return m_OriginalIndices.size(); }
+
+	//! Vertices influenced by 0 to 4 joints. Any influence counts as 4 when not grouping by influence count.
+	size_t GetNumVerticesWithInfluences(int numInfluences) const;
+
+	//! Chunks write disjoint sets of vertices, so a job system can spread them over threads
+	uint32_t GetNumChunks() const;
+
+	//! Skins every vertex. positions and normals need room for GetNumVertices each. numJoints is the size of the
+	//! palette, which must cover every joint the mesh is bound to.
+	void Skin(const glm::mat4* skinningMatrices, size_t numJoints, glm::vec3* positions, glm::vec3* normals) const;
+
+	//! Skins the vertices of chunks [firstChunk, firstChunk + numChunks). Safe to call from several threads at once
+	//! for different chunks.
+	void SkinChunks(const glm::mat4* skinningMatrices, size_t numJoints, glm::vec3* positions, glm::vec3* normals,
+					uint32_t firstChunk, uint32_t numChunks) const;
+
+	//! Adds the copied inputs to the report's "CpuSkinning"
+	void ReportMemory(MemoryReport& report, const std::string& name) const;
+private:
+	template <int NumInfluences>
+	void SkinRange(const glm::mat4* skinningMatrices, size_t begin, size_t end, glm::vec3* positions, glm::vec3* normals) const;
+private:
+	CpuSkinningSettings m_Settings;
+
+	//! In skinning order: grouped by influence count when the settings ask for it, otherwise the mesh's order.
+	//! Positions have a w of 1 and normals a w of 0, so both are whole SSE registers.
+	std::vector<glm::vec4> m_Positions;
+	std::vector<glm::vec4> m_Normals;
+
+	//! MAX_INFLUENCES per vertex, used ones first. Unused ones point at joint 0 with a weight of 0.
+	std::vector<int32_t> m_JointIds;
+	std::vector<float> m_Weights;
+
+	//! Index of each vertex in the mesh
+	std::vector<uint32_t> m_OriginalIndices;
+
+	//! Vertices influenced by fewer than i + 1 joints come before m_GroupEnds[i]
+	size_t m_GroupEnds[CpuSkinningSource::MAX_INFLUENCES + 1] = {};
+
+	int32_t m_MaxJointId = -1;
+};
\ No newline at end of file
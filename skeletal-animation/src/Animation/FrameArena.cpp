@@ -0,0 +1,102 @@
+#include "FrameArena.h"
+
+#include "AllocationTracker.h"
+#include "Core.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+FrameArena::FrameArena(size_t blockSize)
+	: m_BlockSize(blockSize)
+{
+	S_ASSERT(blockSize > 0);
+}
+
+FrameArena& FrameArena::Get()
+{
+	static thread_local FrameArena arena;
+	return arena;
+}
+
+uint8_t* FrameArena::AlignUp(uint8_t* pointer, size_t alignment)
+{
+	uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+	return reinterpret_cast<uint8_t*>((address + alignment - 1) & ~(uintptr_t)(alignment - 1));
+}
+
+bool FrameArena::TryAllocateFromBlock(size_t blockIndex, size_t offset, size_t size, size_t alignment, void*& allocation)
+{
+	Block& block = m_Blocks[blockIndex];
+	uint8_t* start = AlignUp(block.Memory.get() + offset, alignment);
+	size_t end = (start - block.Memory.get()) + size;
+	if (end > block.Size)
+		return false;
+
+	// Moving on to a later block counts whatever is left of the current one as used, so rewinding adds up
+	m_BytesInUse += (blockIndex == m_BlockIndex ? end - m_Offset : (m_Blocks[m_BlockIndex].Size - m_Offset) + end);
+	m_BlockIndex = blockIndex;
+	m_Offset = end;
+
+	m_FrameHighWaterMark = std::max(m_FrameHighWaterMark, m_BytesInUse);
+	m_PeakHighWaterMark = std::max(m_PeakHighWaterMark, m_BytesInUse);
+
+	allocation = start;
+	return true;
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	S_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	void* allocation = nullptr;
+	if (!m_Blocks.empty())
+	{
+		if (TryAllocateFromBlock(m_BlockIndex, m_Offset, size, alignment, allocation))
+			return allocation;
+
+		// Blocks after the current one are free, but may be too small for a large allocation
+		for (size_t i = m_BlockIndex + 1; i < m_Blocks.size(); i++)
+		{
+			if (TryAllocateFromBlock(i, 0, size, alignment, allocation))
+				return allocation;
+		}
+	}
+
+	S_ALLOCATION_SCOPE("FrameArena");
+
+	// new[] only guarantees alignment of the largest fundamental type, so leave room to align further
+	Block block;
+	block.Size = std::max(m_BlockSize, size + alignment);
+	block.Memory = std::make_unique<uint8_t[]>(block.Size);
+	m_Capacity += block.Size;
+	m_Blocks.push_back(std::move(block));
+
+	if (m_Blocks.size() == 1)
+	{
+		m_BlockIndex = 0;
+		m_Offset = 0;
+	}
+
+	bool hasAllocated = TryAllocateFromBlock(m_Blocks.size() - 1, 0, size, alignment, allocation);
+	S_ASSERT(hasAllocated);
+	return allocation;
+}
+
+void FrameArena::Rewind(const Marker& marker)
+{
+	S_ASSERT(marker.BytesInUse <= m_BytesInUse);
+	m_BlockIndex = marker.BlockIndex;
+	m_Offset = marker.Offset;
+	m_BytesInUse = marker.BytesInUse;
+}
+
+void FrameArena::BeginFrame()
+{
+	Rewind({ 0, 0, 0 });
+	m_FrameHighWaterMark = 0;
+}
+
+void FrameArena::EndFrame()
+{
+	S_PROFILE_COUNTER("FrameArena::HighWaterBytes", (int64_t)m_FrameHighWaterMark);
+}
\ No newline at end of file
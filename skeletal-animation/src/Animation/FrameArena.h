@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//! Bump allocator for scratch memory that lives no longer than a frame, such as the intermediate poses of a blend tree.
+//! Allocating is a pointer increment and memory is never freed individually: Scopes hand back everything allocated
+//! within them, and BeginFrame hands back everything. Blocks are kept once allocated, so a warmed up arena doesn't
+//! touch the heap. Not thread safe; every thread has its own (see Get).
+class FrameArena
+{
+public:
+	static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+	explicit FrameArena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	//! The calling thread's arena
+	static FrameArena& Get();
+
+	void* Allocate(size_t size, size_t alignment);
+
+	//! Uninitialised; only meant for trivially destructible types, since destructors are never run
+	template <typename T>
+	T* AllocateArray(size_t count) { return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T))); }
+
+	struct Marker
+	{
+		size_t BlockIndex;
+		size_t Offset;
+		size_t BytesInUse;
+	};
+
+	Marker GetMarker() const { return { m_BlockIndex, m_Offset, m_BytesInUse }; }
+	void Rewind(const Marker& marker);
+
+	//! Rewinds the arena to where it was when the scope was created
+	class Scope
+	{
+	public:
+		explicit Scope(FrameArena& arena) : m_Arena(arena), m_Marker(arena.GetMarker()) {}
+		~Scope() { m_Arena.Rewind(m_Marker); }
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	private:
+		FrameArena& m_Arena;
+		Marker m_Marker;
+	};
+
+	//! Hands back all memory, and starts tracking the high-water mark of a new frame
+	void BeginFrame();
+	//! Reports this frame's high-water mark to the profiler
+	void EndFrame();
+
+	size_t GetBytesInUse() const { return m_BytesInUse; }
+	size_t GetFrameHighWaterMark() const { return m_FrameHighWaterMark; }
+	size_t GetPeakHighWaterMark() const { return m_PeakHighWaterMark; }
+	//! Total size of all blocks, which the arena keeps hold of until it's destroyed
+	size_t GetCapacity() const { return m_Capacity; }
+private:
+	struct Block
+	{
+		std::unique_ptr<uint8_t[]> Memory;
+		size_t Size;
+	};
+
+	static uint8_t* AlignUp(uint8_t* pointer, size_t alignment);
+	bool TryAllocateFromBlock(size_t blockIndex, size_t offset, size_t size, size_t alignment, void*& allocation);
+private:
+	size_t m_BlockSize;
+	std::vector<Block> m_Blocks;
+
+	//! Next free byte is at m_Offset in block m_BlockIndex
+	size_t m_BlockIndex = 0;
+	size_t m_Offset = 0;
+
+	//! Including padding for alignment and the unused ends of blocks we moved on from
+	size_t m_BytesInUse = 0;
+	size_t m_FrameHighWaterMark = 0;
+	size_t m_PeakHighWaterMark = 0;
+	size_t m_Capacity = 0;
+};
\ No newline at end of file
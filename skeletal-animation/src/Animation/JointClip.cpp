@@ -1,50 +1,154 @@
 #include "JointClip.h"
 
-JointClip::JointClip(const std::string& name, const aiNodeAnim* channel, bool shouldFreezeTranslation)
-	: m_Name(name), m_ShouldFreezeTranslation(shouldFreezeTranslation)
+#include "Core.h"
+#include "MemoryReport.h"
+#include "RootMotionTrack.h"
+
+//! Keeps every other key, but always the last one so the clip still spans its full duration
+template <typename KeyFrame>
+static std::vector<KeyFrame> DropAlternateKeys(const std::vector<KeyFrame>& keys)
 {
-	m_LocalPose.JointName = name;
+	std::vector<KeyFrame> reducedKeys;
+	reducedKeys.reserve(keys.size() / 2 + 1);
+	for (size_t i = 0; i < keys.size(); i += 2)
+		reducedKeys.push_back(keys[i]);
 
-	uint32_t numPositions = /*shouldFreezeTranslation ? 1 :*/ channel->mNumPositionKeys;
-	m_PositionKeys.reserve(numPositions);
-	for (uint32_t i = 0; i < numPositions; i++)
-	{
-		aiVector3D& pos = channel->mPositionKeys[i].mValue;
-		float timestamp = channel->mPositionKeys[i].mTime;
+	if (keys.size() % 2 == 0 && !keys.empty())
+		reducedKeys.push_back(keys.back());
 
-		PositionKeyFrame posKey = { glm::vec3(pos.x, pos.y, pos.z), timestamp};
-		m_PositionKeys.push_back(posKey);
-	}
+	return reducedKeys;
+}
 
-	m_RotationKeys.reserve(channel->mNumRotationKeys);
-	for (uint32_t i = 0; i < channel->mNumRotationKeys; i++)
-	{
-		aiQuaternion& rot = channel->mRotationKeys[i].mValue;
-		float timestamp = channel->mRotationKeys[i].mTime;
+JointClip::JointClip(const std::string& name, std::vector<PositionKeyFrame>&& positionKeys, std::vector<RotationKeyFrame>&& rotationKeys,
+					 std::vector<ScaleKeyFrame>&& scaleKeys)
+	: m_PositionKeys(std::move(positionKeys)), m_RotationKeys(std::move(rotationKeys)), m_ScaleKeys(std::move(scaleKeys)), m_Name(name)
+{
+	S_ASSERT(!m_PositionKeys.empty() && !m_RotationKeys.empty() && !m_ScaleKeys.empty());
 
-		RotationKeyFrame rotKey = { glm::quat(rot.w, rot.x, rot.y, rot.z), timestamp };
-		m_RotationKeys.push_back(rotKey);
-	}
+	m_IsDetailJoint = AnimationLodSettings::IsDetailJoint(name);
+}
 
-	m_ScaleKeys.reserve(channel->mNumScalingKeys);
-	for (uint32_t i = 0; i < channel->mNumScalingKeys; i++)
+JointClip JointClip::CreateReduced() const
+{
+	JointClip reducedClip = *this;
+	reducedClip.m_PositionKeys = DropAlternateKeys(m_PositionKeys);
+	reducedClip.m_RotationKeys = DropAlternateKeys(m_RotationKeys);
+	reducedClip.m_ScaleKeys = DropAlternateKeys(m_ScaleKeys);
+	return reducedClip;
+}
+
+void JointClip::FreezeForwardTranslation()
+{
+	for (PositionKeyFrame& key : m_PositionKeys)
+		key.Position.z = 0.0f;
+}
+
+void JointClip::RemoveRootMotion(const RootMotionTrack& track, const glm::mat4& parentTransform, float ticksPerSecond)
+{
+	glm::mat4 inverseParentTransform = glm::inverse(parentTransform);
+	for (PositionKeyFrame& key : m_PositionKeys)
 	{
-		aiVector3D& scale = channel->mScalingKeys[i].mValue;
-		float timestamp = channel->mScalingKeys[i].mTime;
+		glm::mat4 inverseRootMotion = glm::inverse(track.GetTransform(key.Timestamp / ticksPerSecond));
+		key.Position = glm::vec3(inverseParentTransform * inverseRootMotion * parentTransform * glm::vec4(key.Position, 1.0f));
+	}
+
+	// Only the rotation part of the parent's transform matters here, so its scale is normalised away
+	glm::mat3 parentRotation = glm::mat3(parentTransform);
+	for (int axis = 0; axis < 3; axis++)
+		parentRotation[axis] = glm::normalize(parentRotation[axis]);
+	glm::quat parentQuat = glm::quat_cast(parentRotation);
 
-		ScaleKeyFrame scaleKey = { glm::vec3(scale.x, scale.y, scale.z), timestamp };
-		m_ScaleKeys.push_back(scaleKey);
+	for (RotationKeyFrame& key : m_RotationKeys)
+	{
+		glm::quat inverseRootMotion = glm::quat_cast(glm::mat3(glm::inverse(track.GetTransform(key.Timestamp / ticksPerSecond))));
+		key.Rotation = glm::normalize(glm::inverse(parentQuat) * inverseRootMotion * parentQuat * key.Rotation);
 	}
 }
 
-void JointClip::Update(float animationTime)
+float JointClip::GetMaxTranslationLength() const
+{
+	float maxLength = 0.0f;
+	for (const PositionKeyFrame& key : m_PositionKeys)
+		maxLength = glm::max(maxLength, glm::length(key.Position));
+	return maxLength;
+}
+
+size_t JointClip::GetMemoryUsage() const
+{
+	return MemoryHelper::GetVectorBytes(m_PositionKeys) + MemoryHelper::GetVectorBytes(m_RotationKeys)
+		+ MemoryHelper::GetVectorBytes(m_ScaleKeys) + MemoryHelper::GetStringBytes(m_Name);
+}
+
+LocalPose JointClip::Sample(float animationTime) const
 {
-	m_LocalPose.Translation = InterpolatePosition(animationTime);
-	if (m_ShouldFreezeTranslation)
-		m_LocalPose.Translation = glm::vec3(m_LocalPose.Translation.x, m_LocalPose.Translation.y, 0.0f);
+	LocalPose localPose;
+	localPose.Translation = InterpolatePosition(animationTime);
+
+	localPose.Rotation = InterpolateRotation(animationTime);
+	localPose.Scale = InterpolateScale(animationTime);
+	return localPose;
+}
+
+//! Same key GetPositionIndex and friends would find for the time, searching onwards from the key found for an earlier time
+template <typename KeyFrame>
+static int AdvanceKeyIndex(const std::vector<KeyFrame>& keys, int index, float animationTime)
+{
+	while (index < (int)keys.size() - 2 && animationTime >= keys[index + 1].Timestamp)
+		index++;
+	return index;
+}
 
-	m_LocalPose.Rotation = InterpolateRotation(animationTime);
-	m_LocalPose.Scale = InterpolateScale(animationTime);
+void JointClip::SampleSorted(const float* animationTimes, size_t count, LocalPose* localPoses) const
+{
+	// One channel at a time, so only that channel's keys need to be in cache
+	int keyIndex = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (m_PositionKeys.size() == 1)
+		{
+			localPoses[i].Translation = m_PositionKeys[0].Position;
+			continue;
+		}
+
+		S_ASSERT(i == 0 || animationTimes[i] >= animationTimes[i - 1]);
+		keyIndex = AdvanceKeyIndex(m_PositionKeys, keyIndex, animationTimes[i]);
+		const PositionKeyFrame& currentKey = m_PositionKeys[keyIndex];
+		const PositionKeyFrame& nextKey = m_PositionKeys[keyIndex + 1];
+		float t = GetLerpParam(currentKey.Timestamp, nextKey.Timestamp, animationTimes[i]);
+		localPoses[i].Translation = glm::mix(currentKey.Position, nextKey.Position, t);
+	}
+
+	keyIndex = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (m_RotationKeys.size() == 1)
+		{
+			localPoses[i].Rotation = glm::normalize(m_RotationKeys[0].Rotation);
+			continue;
+		}
+
+		keyIndex = AdvanceKeyIndex(m_RotationKeys, keyIndex, animationTimes[i]);
+		const RotationKeyFrame& currentKey = m_RotationKeys[keyIndex];
+		const RotationKeyFrame& nextKey = m_RotationKeys[keyIndex + 1];
+		float t = GetLerpParam(currentKey.Timestamp, nextKey.Timestamp, animationTimes[i]);
+		localPoses[i].Rotation = glm::normalize(glm::slerp(currentKey.Rotation, nextKey.Rotation, t));
+	}
+
+	keyIndex = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (m_ScaleKeys.size() == 1)
+		{
+			localPoses[i].Scale = m_ScaleKeys[0].Scale;
+			continue;
+		}
+
+		keyIndex = AdvanceKeyIndex(m_ScaleKeys, keyIndex, animationTimes[i]);
+		const ScaleKeyFrame& currentKey = m_ScaleKeys[keyIndex];
+		const ScaleKeyFrame& nextKey = m_ScaleKeys[keyIndex + 1];
+		float t = GetLerpParam(currentKey.Timestamp, nextKey.Timestamp, animationTimes[i]);
+		localPoses[i].Scale = glm::mix(currentKey.Scale, nextKey.Scale, t);
+	}
 }
 
 glm::vec3 JointClip::InterpolatePosition(float animationTime) const
@@ -97,8 +201,7 @@ glm::vec3 JointClip::InterpolateScale(float animationTime) const
 
 int JointClip::GetPositionIndex(float animationTime) const
 {
-	if (m_PositionKeys.size() == 0)
-		__debugbreak();
+	S_ASSERT(!m_PositionKeys.empty());
 	for (uint32_t i = 0; i < m_PositionKeys.size() - 1; i++)
 	{
 		// Assuming of course that key frames are sorted by ascending timestamps
@@ -1,11 +1,13 @@
 #pragma once
 
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
+#include <string>
+#include <vector>
 
 #include "AnimationNode.h"
 
+struct aiNodeAnim;
+class RootMotionTrack;
+
 struct PositionKeyFrame
 {
 	glm::vec3 Position;
@@ -29,14 +31,41 @@ struct ScaleKeyFrame
 class JointClip
 {
 public:
-	JointClip(const std::string& name, const aiNodeAnim* channel, bool shouldFreezeTranslation = false);
+	//! Defined in AssimpImport.cpp
+	JointClip(const std::string& name, const aiNodeAnim* channel);
+
+	//! For clips that don't come from a file (e.g. generated for tests and benchmarks)
+	JointClip(const std::string& name, std::vector<PositionKeyFrame>&& positionKeys, std::vector<RotationKeyFrame>&& rotationKeys,
+			  std::vector<ScaleKeyFrame>&& scaleKeys);
 	
 	//! Interpolates local pose of joint between key frames of animation according to animation time
-	void Update(float animationTime);
+	LocalPose Sample(float animationTime) const;
+
+	//! Same as calling Sample for each of the times, which must be in ascending order. Each channel's keys are walked
+	//! once for the whole batch, instead of being searched from the start for every time.
+	void SampleSorted(const float* animationTimes, size_t count, LocalPose* localPoses) const;
 
-	const LocalPose& GetLocalPose() const { return m_LocalPose; }
 	const std::string& GetName() const { return m_Name; }
 
+	//! See AnimationLodSettings::IsDetailJoint
+	bool IsDetailJoint() const { return m_IsDetailJoint; }
+
+	//! Copy of this clip with every other key frame dropped, for cheaper sampling at low levels of detail
+	JointClip CreateReduced() const;
+
+	//! Zeroes the local Z of every translation key (see AnimationClip::FreezeForwardTranslation)
+	void FreezeForwardTranslation();
+
+	//! Takes the track's motion out of this joint's keys, so it moves in place (see AnimationClip::ExtractRootMotion).
+	//! parentTransform is the model space transform of the joint's parent.
+	void RemoveRootMotion(const RootMotionTrack& track, const glm::mat4& parentTransform, float ticksPerSecond);
+
+	//! Longest of the position keys' translations, which no sampled translation can exceed
+	float GetMaxTranslationLength() const;
+
+	//! Heap memory held by this clip's key frames and name
+	size_t GetMemoryUsage() const;
+
 private:
 	glm::vec3 InterpolatePosition(float animationTime) const;
 	glm::quat InterpolateRotation(float animationTime) const;
@@ -49,12 +78,11 @@ private:
 	static float GetLerpParam(float prevKeyTime, float nextKeyTime, float currentTime);
 
 private:
-	bool m_ShouldFreezeTranslation;
+	bool m_IsDetailJoint;
 
 	std::vector<PositionKeyFrame> m_PositionKeys;
 	std::vector<RotationKeyFrame> m_RotationKeys;
 	std::vector<ScaleKeyFrame> m_ScaleKeys;
 
-	LocalPose m_LocalPose; // transform of joint relative to its parent
 	std::string m_Name;
 };
\ No newline at end of file
@@ -1,29 +1,54 @@
 #include "JointDirectory.h"
 
-#include "../AssimpHelper.h"
+#include "AnimationLod.h"
+#include "MemoryReport.h"
 
-void JointDirectory::ParseRootNode(const aiNode* rootNode)
+#include <glm/gtx/matrix_decompose.hpp>
+
+void JointDirectory::SetRootNode(const SkeletonNode& rootNode)
 {
-	// TODO: Verify that it's indeed safe to only parse the skeleton once for all animations of the same model
 	if (m_RootNode.Children.empty())
 	{
-		ReadNode(m_RootNode, rootNode);
+		m_RootNode = rootNode;
+		FlattenNode(m_RootNode, -1);
 	}
 }
 
-void JointDirectory::ReadNode(SkeletonNode& dstNode, const aiNode* srcNode)
+void JointDirectory::FlattenNode(const SkeletonNode& node, int parentIndex)
 {
-	S_ASSERT(srcNode);
+	FlatSkeletonNode flatNode;
+	flatNode.Name = node.Name;
+	flatNode.ParentIndex = parentIndex;
+	flatNode.IsDetailJoint = AnimationLodSettings::IsDetailJoint(node.Name);
 
-	dstNode.Name = std::string(srcNode->mName.C_Str());
-	dstNode.Transform = AssimpHelper::AssimpToGlmMatrix(srcNode->mTransformation);
+	glm::vec3 skew;
+	glm::vec4 perspective;
+	glm::decompose(node.Transform, flatNode.Scale, flatNode.Rotation, flatNode.Translation, skew, perspective);
 
-	for (uint32_t i = 0; i < srcNode->mNumChildren; i++)
+	// Joints may have been loaded from a mesh before the skeleton was parsed
+	if (ContainsJoint(node.Name))
 	{
-		SkeletonNode childNode;
-		ReadNode(childNode, srcNode->mChildren[i]);
-		dstNode.Children.push_back(childNode);
+		const Joint& joint = GetJoint(node.Name);
+		flatNode.JointId = joint.Id;
+		flatNode.InverseBindPose = joint.InverseBindPose;
 	}
+
+	int index = (int)m_FlatNodes.size();
+	m_FlatNodes.push_back(flatNode);
+	m_FlatNodeIndices[node.Name] = index;
+
+	m_DefaultPose.Translations.push_back(flatNode.Translation);
+	m_DefaultPose.Rotations.push_back(flatNode.Rotation);
+	m_DefaultPose.Scales.push_back(flatNode.Scale);
+
+	for (uint32_t i = 0; i < node.Children.size(); i++)
+		FlattenNode(node.Children[i], index);
+}
+
+int JointDirectory::GetFlatNodeIndex(const std::string& name) const
+{
+	auto it = m_FlatNodeIndices.find(name);
+	return it != m_FlatNodeIndices.end() ? it->second : -1;
 }
 
 int JointDirectory::AppendJoint(const std::string& name, const glm::mat4& inverseBindPose)
@@ -37,6 +62,44 @@ int JointDirectory::AppendJoint(const std::string& name, const glm::mat4& invers
 
 		m_Directory[name] = joint;
 		m_NumJointsLoaded++;
+
+		// ...or the skeleton may have been parsed before the mesh containing this joint
+		if (m_FlatNodeIndices.find(name) != m_FlatNodeIndices.end())
+		{
+			FlatSkeletonNode& flatNode = m_FlatNodes[m_FlatNodeIndices.at(name)];
+			flatNode.JointId = joint.Id;
+			flatNode.InverseBindPose = inverseBindPose;
+		}
 	}
 	return m_Directory.at(name).Id;
+}
+
+void JointDirectory::ExpandJointRadius(int jointId, float radius)
+{
+	S_ASSERT(jointId >= 0 && jointId < m_NumJointsLoaded);
+	if (jointId >= (int)m_JointRadii.size())
+		m_JointRadii.resize(jointId + 1, 0.0f);
+
+	m_JointRadii[jointId] = glm::max(m_JointRadii[jointId], radius);
+}
+
+void JointDirectory::ReportMemory(MemoryReport& report, const std::string& name) const
+{
+	size_t bytes = sizeof(*this) + MemoryHelper::GetStringMapBytes(m_Directory) + GetNodeMemoryUsage(m_RootNode)
+		+ MemoryHelper::GetVectorBytes(m_JointRadii) + MemoryHelper::GetVectorBytes(m_FlatNodes)
+		+ MemoryHelper::GetStringMapBytes(m_FlatNodeIndices) + MemoryHelper::GetVectorBytes(m_DefaultPose.Translations)
+		+ MemoryHelper::GetVectorBytes(m_DefaultPose.Rotations) + MemoryHelper::GetVectorBytes(m_DefaultPose.Scales);
+	for (const FlatSkeletonNode& flatNode : m_FlatNodes)
+		bytes += MemoryHelper::GetStringBytes(flatNode.Name);
+
+	report.Add("Skeletons", name, bytes);
+}
+
+size_t JointDirectory::GetNodeMemoryUsage(const SkeletonNode& node)
+{
+	// The node itself is counted by whoever holds it
+	size_t bytes = MemoryHelper::GetStringBytes(node.Name) + MemoryHelper::GetVectorBytes(node.Children);
+	for (const SkeletonNode& child : node.Children)
+		bytes += GetNodeMemoryUsage(child);
+	return bytes;
 }
\ No newline at end of file
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <unordered_map>
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
+#include <string>
+#include <vector>
 
-#include "../Core.h"
+#include "Core.h"
+#include "PoseBuffer.h"
+
+struct aiNode;
+class MemoryReport;
 
 struct Joint
 {
@@ -29,6 +33,28 @@ struct SkeletonNode
 	std::vector<SkeletonNode> Children;
 };
 
+//! A SkeletonNode in the flattened hierarchy, where every node is stored after its parent
+//! so the hierarchy can be walked with a single forward loop instead of recursion.
+struct FlatSkeletonNode
+{
+	std::string Name;
+
+	//! Index of the parent in the flattened hierarchy, -1 for the root node
+	int ParentIndex;
+
+	//! See AnimationLodSettings::IsDetailJoint
+	bool IsDetailJoint;
+
+	//! -1 if this node is not a joint (i.e. not bound to any vertices)
+	int JointId = -1;
+	glm::mat4 InverseBindPose = glm::mat4(1.0f);
+
+	//! Default transform relative to parent, decomposed so it can be blended with animated poses
+	glm::vec3 Translation;
+	glm::quat Rotation;
+	glm::vec3 Scale;
+};
+
 //! The same joint may be described multiple times in different meshes belonging to the same model.
 //! We keep track of which joints we've already loaded (keyed by joint name) to ensure we can refer
 //! to a previously loaded joint if we encounter one in a different mesh.
@@ -38,15 +64,41 @@ public:
 	bool ContainsJoint(const std::string& jointName) const { return m_Directory.find(jointName) != m_Directory.end(); }
 	const Joint& GetJoint(const std::string& name) const { S_ASSERT(ContainsJoint(name)); return m_Directory.at(name); }
 	int AppendJoint(const std::string& name, const glm::mat4& inverseBindPose);
+
+	//! Radius (in joint space) of a sphere around the joint enclosing every vertex it influences
+	void ExpandJointRadius(int jointId, float radius);
+	float GetJointRadius(int jointId) const { return jointId < (int)m_JointRadii.size() ? m_JointRadii[jointId] : 0.0f; }
+	//! Defined in AssimpImport.cpp
 	void ParseRootNode(const aiNode* rootNode);
+
+	//! For skeletons that don't come from a file (e.g. generated for tests and benchmarks)
+	void SetRootNode(const SkeletonNode& rootNode);
 	const SkeletonNode& GetRootNode() const { S_ASSERT(!m_RootNode.Children.empty()) return m_RootNode; }
+	const std::vector<FlatSkeletonNode>& GetFlatNodes() const { return m_FlatNodes; }
+	//! Index into GetFlatNodes of the node with the given name, or -1 if there's no such node
+	int GetFlatNodeIndex(const std::string& name) const;
+	//! Every node in its default transform, for nodes that aren't animated
+	const PoseBuffer& GetDefaultPose() const { return m_DefaultPose; }
+	int GetNumJoints() const { return m_NumJointsLoaded; }
+
+	//! Adds this skeleton to the report's "Skeletons" under the given name
+	void ReportMemory(MemoryReport& report, const std::string& name) const;
 private:
 	void ReadNode(SkeletonNode& dstNode, const aiNode* srcNode);
+	void FlattenNode(const SkeletonNode& node, int parentIndex);
+	static size_t GetNodeMemoryUsage(const SkeletonNode& node);
 private:
 	std::unordered_map<std::string, Joint> m_Directory;
 
 	SkeletonNode m_RootNode;
 
+	//! Indexed by joint ID
+	std::vector<float> m_JointRadii;
+
+	std::vector<FlatSkeletonNode> m_FlatNodes;
+	std::unordered_map<std::string, int> m_FlatNodeIndices;
+	PoseBuffer m_DefaultPose;
+
 	//! Used to generate the internal ID of a joint
 	int m_NumJointsLoaded = 0;
 };
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "JointMask.h"
+
+#include "JointDirectory.h"
+#include "Core.h"
+
+JointMask::JointMask(const JointDirectory& skeleton, const std::vector<std::string>& jointNames)
+{
+	const std::vector<FlatSkeletonNode>& nodes = skeleton.GetFlatNodes();
+	m_IsIncluded.assign(nodes.size(), 0);
+
+	// Walk up from each joint until we reach a node that's already included, so shared ancestors are only visited once
+	for (const std::string& jointName : jointNames)
+	{
+		int nodeIndex = skeleton.GetFlatNodeIndex(jointName);
+		S_ASSERT(nodeIndex >= 0);
+		m_JointNodeIndices.push_back(nodeIndex);
+
+		for (int ancestor = nodeIndex; ancestor >= 0 && !m_IsIncluded[ancestor]; ancestor = nodes[ancestor].ParentIndex)
+			m_IsIncluded[ancestor] = 1;
+	}
+
+	for (size_t i = 0; i < nodes.size(); i++)
+	{
+		if (m_IsIncluded[i])
+			m_NodeIndices.push_back((int)i);
+	}
+}
+
+JointMask::JointMask(size_t numSkeletonNodes)
+	: m_IsIncluded(numSkeletonNodes, 0)
+{
+}
+
+void JointMask::AddNode(int nodeIndex)
+{
+	S_ASSERT(nodeIndex >= 0 && nodeIndex < (int)m_IsIncluded.size());
+	S_ASSERT(m_NodeIndices.empty() || nodeIndex > m_NodeIndices.back());
+
+	m_IsIncluded[nodeIndex] = 1;
+	m_NodeIndices.push_back(nodeIndex);
+}
+
+void JointMask::Clear()
+{
+	for (int nodeIndex : m_NodeIndices)
+		m_IsIncluded[nodeIndex] = 0;
+	m_NodeIndices.clear();
+	m_JointNodeIndices.clear();
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class JointDirectory;
+
+//! The nodes of a skeleton that a few gameplay joints depend on (e.g. root, hips, head and hands for hitboxes and
+//! attachments on a dedicated server): the joints themselves and all of their ancestors. Animators with a mask only
+//! sample and transform these nodes (see Animator::SetJointMask).
+class JointMask
+{
+public:
+	JointMask() = default;
+
+	//! Every name must be a node of the skeleton
+	JointMask(const JointDirectory& skeleton, const std::vector<std::string>& jointNames);
+
+	//! Empty mask, to be filled in with AddNode
+	explicit JointMask(size_t numSkeletonNodes);
+
+	//! Adds a single node, without its ancestors. Nodes must be added in ascending order, so parents come first.
+	void AddNode(int nodeIndex);
+
+	void Clear();
+
+	bool Contains(int nodeIndex) const { return m_IsIncluded[nodeIndex] != 0; }
+
+	//! Indices into JointDirectory::GetFlatNodes of the included nodes, in ascending order, so parents come first.
+	//! Masks created from joint names include every ancestor of the joints.
+	const std::vector<int>& GetNodeIndices() const { return m_NodeIndices; }
+
+	//! Node index of each of the joints the mask was created with, in the same order
+	const std::vector<int>& GetJointNodeIndices() const { return m_JointNodeIndices; }
+
+	//! Number of nodes in the skeleton the mask was created for
+	size_t GetNumSkeletonNodes() const { return m_IsIncluded.size(); }
+private:
+	//! One per skeleton node, rather than std::vector<bool>, so lookups don't have to pick out bits
+	std::vector<uint8_t> m_IsIncluded;
+	std::vector<int> m_NodeIndices;
+	std::vector<int> m_JointNodeIndices;
+};
\ No newline at end of file
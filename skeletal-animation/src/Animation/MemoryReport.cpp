@@ -0,0 +1,78 @@
+#include "MemoryReport.h"
+
+#include <algorithm>
+#include <iomanip>
+
+void MemoryReport::Add(const std::string& subsystem, const std::string& asset, size_t cpuBytes, size_t gpuBytes)
+{
+	for (Entry& entry : m_Entries)
+	{
+		if (entry.Subsystem == subsystem && entry.Asset == asset)
+		{
+			entry.CpuBytes += cpuBytes;
+			entry.GpuBytes += gpuBytes;
+			return;
+		}
+	}
+
+	Entry entry;
+	entry.Subsystem = subsystem;
+	entry.Asset = asset;
+	entry.CpuBytes = cpuBytes;
+	entry.GpuBytes = gpuBytes;
+	m_Entries.push_back(entry);
+}
+
+size_t MemoryReport::GetTotalCpuBytes() const
+{
+	size_t bytes = 0;
+	for (const Entry& entry : m_Entries)
+		bytes += entry.CpuBytes;
+	return bytes;
+}
+
+size_t MemoryReport::GetTotalGpuBytes() const
+{
+	size_t bytes = 0;
+	for (const Entry& entry : m_Entries)
+		bytes += entry.GpuBytes;
+	return bytes;
+}
+
+static void WriteRow(std::ostream& stream, const std::string& name, size_t cpuBytes, size_t gpuBytes)
+{
+	stream << std::left << std::setw(40) << name << std::right
+		<< std::setw(14) << cpuBytes << std::setw(14) << gpuBytes << "\n";
+}
+
+void MemoryReport::Write(std::ostream& stream) const
+{
+	std::vector<Entry> subsystems;
+	for (const Entry& entry : m_Entries)
+	{
+		auto it = std::find_if(subsystems.begin(), subsystems.end(),
+							   [&entry](const Entry& subsystem) { return subsystem.Subsystem == entry.Subsystem; });
+		if (it == subsystems.end())
+		{
+			subsystems.push_back(entry);
+			continue;
+		}
+		it->CpuBytes += entry.CpuBytes;
+		it->GpuBytes += entry.GpuBytes;
+	}
+
+	stream << std::left << std::setw(40) << "Subsystem" << std::right
+		<< std::setw(14) << "CPU bytes" << std::setw(14) << "GPU bytes" << "\n";
+	for (const Entry& subsystem : subsystems)
+		WriteRow(stream, subsystem.Subsystem, subsystem.CpuBytes, subsystem.GpuBytes);
+	WriteRow(stream, "Total", GetTotalCpuBytes(), GetTotalGpuBytes());
+
+	std::vector<Entry> assets = m_Entries;
+	std::sort(assets.begin(), assets.end(),
+			  [](const Entry& a, const Entry& b) { return a.CpuBytes + a.GpuBytes > b.CpuBytes + b.GpuBytes; });
+
+	stream << "\n" << std::left << std::setw(40) << "Asset" << std::right
+		<< std::setw(14) << "CPU bytes" << std::setw(14) << "GPU bytes" << "\n";
+	for (const Entry& asset : assets)
+		WriteRow(stream, asset.Subsystem + ": " + asset.Asset, asset.CpuBytes, asset.GpuBytes);
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//! Memory held by loaded assets and animation instances, per asset and per subsystem (e.g. "Clips", "Meshes").
+//! Assets add themselves through their ReportMemory functions. GPU sizes are estimates, since drivers don't tell us
+//! how they actually lay out buffers and textures.
+class MemoryReport
+{
+public:
+	struct Entry
+	{
+		std::string Subsystem;
+		std::string Asset;
+		size_t CpuBytes = 0;
+		size_t GpuBytes = 0;
+	};
+
+	//! Adding the same asset to the same subsystem again adds to its existing entry
+	void Add(const std::string& subsystem, const std::string& asset, size_t cpuBytes, size_t gpuBytes = 0);
+
+	const std::vector<Entry>& GetEntries() const { return m_Entries; }
+	size_t GetTotalCpuBytes() const;
+	size_t GetTotalGpuBytes() const;
+
+	//! Totals per subsystem, followed by every asset from most to least expensive
+	void Write(std::ostream& stream) const;
+private:
+	std::vector<Entry> m_Entries;
+};
+
+//! Estimates of the heap memory held by standard containers, for use in ReportMemory functions
+namespace MemoryHelper
+{
+	template <typename T>
+	size_t GetVectorBytes(const std::vector<T>& vector) { return vector.capacity() * sizeof(T); }
+
+	//! Only counts the heap buffer, which short strings don't have
+	inline size_t GetStringBytes(const std::string& string)
+	{
+		static const size_t smallStringCapacity = std::string().capacity();
+		return string.capacity() > smallStringCapacity ? string.capacity() + 1 : 0;
+	}
+
+	//! Nodes and buckets, but not whatever the keys and values themselves point to
+	template <typename Key, typename Value>
+	size_t GetHashMapBytes(const std::unordered_map<Key, Value>& map)
+	{
+		// Every node holds a next pointer and, for most key types, the cached hash
+		size_t nodeBytes = sizeof(void*) + sizeof(size_t) + sizeof(std::pair<const Key, Value>);
+		return map.size() * nodeBytes + map.bucket_count() * sizeof(void*);
+	}
+
+	//! Same as GetHashMapBytes, plus the heap buffers of string keys
+	template <typename Value>
+	size_t GetStringMapBytes(const std::unordered_map<std::string, Value>& map)
+	{
+		size_t bytes = GetHashMapBytes(map);
+		for (const auto& [key, value] : map)
+			bytes += GetStringBytes(key);
+		return bytes;
+	}
+}
\ No newline at end of file
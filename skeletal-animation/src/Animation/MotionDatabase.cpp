@@ -0,0 +1,437 @@
+#include "MotionDatabase.h"
+
+#include "AnimationClip.h"
+#include "AllocationTracker.h"
+#include "Core.h"
+#include "FrameArena.h"
+#include "MemoryReport.h"
+#include "PoseHelper.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define MOTION_DATABASE_USE_SSE2
+#endif
+
+//! Squared distance between two feature vectors of `stride` floats, a multiple of four
+static inline float SquaredDistance(const float* a, const float* b, int stride)
+{
+#ifdef MOTION_DATABASE_USE_SSE2
+	__m128 sum = _mm_setzero_ps();
+	for (int i = 0; i < stride; i += 4)
+	{
+		__m128 difference = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+		sum = _mm_add_ps(sum, _mm_mul_ps(difference, difference));
+	}
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(sum);
+#else
+	float sum = 0.0f;
+	for (int i = 0; i < stride; i++)
+		sum += (a[i] - b[i]) * (a[i] - b[i]);
+	return sum;
+#endif
+}
+
+//! Squared distance from the query to the nearest point of a bounding box, which no frame inside the box can beat
+static inline float BoxDistance(const float* query, const float* boxMin, const float* boxMax, int stride)
+{
+#ifdef MOTION_DATABASE_USE_SSE2
+	__m128 sum = _mm_setzero_ps();
+	for (int i = 0; i < stride; i += 4)
+	{
+		__m128 q = _mm_loadu_ps(query + i);
+		__m128 nearest = _mm_min_ps(_mm_max_ps(q, _mm_loadu_ps(boxMin + i)), _mm_loadu_ps(boxMax + i));
+		__m128 difference = _mm_sub_ps(q, nearest);
+		sum = _mm_add_ps(sum, _mm_mul_ps(difference, difference));
+	}
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(sum);
+#else
+	float sum = 0.0f;
+	for (int i = 0; i < stride; i++)
+	{
+		float difference = query[i] - glm::clamp(query[i], boxMin[i], boxMax[i]);
+		sum += difference * difference;
+	}
+	return sum;
+#endif
+}
+
+//! Where the character stands and which way it faces, on the ground plane
+struct GroundFrame
+{
+	glm::vec3 Position;
+	glm::vec3 Forward;
+
+	glm::vec3 ToLocalDirection(const glm::vec3& direction) const
+	{
+		glm::vec3 right(Forward.z, 0.0f, -Forward.x);
+		return glm::vec3(glm::dot(direction, right), direction.y, glm::dot(direction, Forward));
+	}
+
+	glm::vec3 ToLocalPosition(const glm::vec3& position) const { return ToLocalDirection(position - Position); }
+};
+
+void MotionDatabase::AddClip(AnimationClip* clip)
+{
+	S_ASSERT(clip);
+	m_Clips.push_back({ clip, 0, 0, 0, 0 });
+}
+
+void MotionDatabase::Build(const JointDirectory& skeleton, const MotionFeatureSettings& settings)
+{
+	S_PROFILE_SCOPE("MotionDatabase::Build");
+	S_ALLOCATION_SCOPE("MotionMatching");
+
+	S_ASSERT(settings.SampleRate > 0.0f && !settings.TrajectoryTimes.empty());
+	m_Settings = settings;
+
+	const std::vector<FlatSkeletonNode>& nodes = skeleton.GetFlatNodes();
+	int rootIndex = skeleton.GetFlatNodeIndex(settings.RootJoint);
+	S_ASSERT(rootIndex >= 0);
+
+	std::vector<int> featureNodes;
+	for (const std::string& jointName : settings.FeatureJoints)
+	{
+		featureNodes.push_back(skeleton.GetFlatNodeIndex(jointName));
+		S_ASSERT(featureNodes.back() >= 0);
+	}
+
+	int numJoints = (int)featureNodes.size();
+	int numTrajectoryPoints = (int)settings.TrajectoryTimes.size();
+	m_VelocityOffset = 3 * numJoints;
+	m_TrajectoryPositionOffset = m_VelocityOffset + 3 * numJoints;
+	m_TrajectoryDirectionOffset = m_TrajectoryPositionOffset + 2 * numTrajectoryPoints;
+	m_NumFeatures = m_TrajectoryDirectionOffset + 2 * numTrajectoryPoints;
+	m_FeatureStride = (m_NumFeatures + 3) & ~3;
+
+	// Frames whose trajectory would run past the end of their clip can't tell us where the clip goes.
+	// Clips shorter than the trajectory can still be started from their first frame.
+	float trajectorySeconds = *std::max_element(settings.TrajectoryTimes.begin(), settings.TrajectoryTimes.end());
+	int trajectoryFrames = (int)std::lround(trajectorySeconds * settings.SampleRate);
+
+	m_NumFrames = 0;
+	m_NumSearchableFrames = 0;
+	for (ClipRange& range : m_Clips)
+	{
+		float seconds = range.Clip->GetDuration() / range.Clip->GetTicksPerSecond();
+		range.NumFrames = (int)(seconds * settings.SampleRate) + 1;
+		range.NumSearchableFrames = glm::max(range.NumFrames - trajectoryFrames, 1);
+		range.FirstFrame = m_NumSearchableFrames;
+
+		m_NumFrames += range.NumFrames;
+		m_NumSearchableFrames += range.NumSearchableFrames;
+	}
+
+	m_Frames.resize(m_NumFrames);
+	int firstUnsearchableFrame = m_NumSearchableFrames;
+	for (int clipIndex = 0; clipIndex < GetNumClips(); clipIndex++)
+	{
+		ClipRange& range = m_Clips[clipIndex];
+		range.FirstUnsearchableFrame = firstUnsearchableFrame;
+		firstUnsearchableFrame += range.NumFrames - range.NumSearchableFrames;
+
+		for (int clipFrame = 0; clipFrame < range.NumFrames; clipFrame++)
+			m_Frames[GetFrameIndex(clipIndex, clipFrame)] = { clipIndex, clipFrame };
+	}
+
+	// Padding stays 0 in both frames and queries, so it doesn't add to distances
+	m_Features.assign((size_t)m_NumFrames * m_FeatureStride, 0.0f);
+
+	FrameArena arena;
+	AnimationLodTier fullDetail;
+	EvaluationContext context = { skeleton, fullDetail, arena };
+	PoseBuffer pose = skeleton.GetDefaultPose();
+	std::vector<glm::mat4> modelSpaceTransforms;
+
+	// Velocities and trajectories look at other frames, so a whole clip is sampled before its features are worked out
+	std::vector<GroundFrame> groundFrames;
+	std::vector<glm::vec3> jointPositions;
+	for (int clipIndex = 0; clipIndex < GetNumClips(); clipIndex++)
+	{
+		const ClipRange& range = m_Clips[clipIndex];
+		float seconds = range.Clip->GetDuration() / range.Clip->GetTicksPerSecond();
+		groundFrames.resize(range.NumFrames);
+		jointPositions.resize((size_t)range.NumFrames * numJoints);
+
+		for (int frame = 0; frame < range.NumFrames; frame++)
+		{
+			float time = glm::min(frame / settings.SampleRate, seconds);
+			range.Clip->Evaluate(range.Clip->ToClipTime(time), context, pose.GetView());
+			PoseHelper::LocalToModel(nodes, pose, modelSpaceTransforms);
+
+			// Clips that play in place still travel, so their root motion is put back before matching
+			const glm::mat4 rootMotion = range.Clip->HasRootMotion() ? range.Clip->GetRootMotion().GetTransform(time) : glm::mat4(1.0f);
+			const glm::mat4 rootTransform = rootMotion * modelSpaceTransforms[rootIndex];
+			glm::vec3 forward = glm::vec3(rootTransform * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f));
+			forward.y = 0.0f;
+			float forwardLength = glm::length(forward);
+
+			GroundFrame& groundFrame = groundFrames[frame];
+			groundFrame.Position = glm::vec3(rootTransform[3].x, 0.0f, rootTransform[3].z);
+			groundFrame.Forward = forwardLength > 1e-6f ? forward / forwardLength : glm::vec3(0.0f, 0.0f, 1.0f);
+
+			for (int joint = 0; joint < numJoints; joint++)
+				jointPositions[(size_t)frame * numJoints + joint] = glm::vec3(rootMotion * modelSpaceTransforms[featureNodes[joint]][3]);
+		}
+
+		for (int frame = 0; frame < range.NumFrames; frame++)
+		{
+			const GroundFrame& groundFrame = groundFrames[frame];
+			float* features = m_Features.data() + (size_t)GetFrameIndex(clipIndex, frame) * m_FeatureStride;
+
+			// Forward differences, except for the last frame which has nothing after it
+			int nextFrame = glm::min(frame + 1, range.NumFrames - 1);
+			int previousFrame = nextFrame - 1;
+
+			for (int joint = 0; joint < numJoints; joint++)
+			{
+				glm::vec3 position = groundFrame.ToLocalPosition(jointPositions[(size_t)frame * numJoints + joint]);
+				glm::vec3 velocity(0.0f);
+				if (previousFrame >= 0)
+				{
+					velocity = (jointPositions[(size_t)nextFrame * numJoints + joint]
+								- jointPositions[(size_t)previousFrame * numJoints + joint]) * settings.SampleRate;
+				}
+				velocity = groundFrame.ToLocalDirection(velocity);
+
+				for (int axis = 0; axis < 3; axis++)
+				{
+					features[3 * joint + axis] = position[axis];
+					features[m_VelocityOffset + 3 * joint + axis] = velocity[axis];
+				}
+			}
+
+			// Past the end of the clip, the character is taken to stay where it ends up
+			for (int point = 0; point < numTrajectoryPoints; point++)
+			{
+				int futureFrame = frame + (int)std::lround(settings.TrajectoryTimes[point] * settings.SampleRate);
+				const GroundFrame& future = groundFrames[glm::min(futureFrame, range.NumFrames - 1)];
+
+				glm::vec3 position = groundFrame.ToLocalPosition(future.Position);
+				glm::vec3 direction = groundFrame.ToLocalDirection(future.Forward);
+				features[m_TrajectoryPositionOffset + 2 * point] = position.x;
+				features[m_TrajectoryPositionOffset + 2 * point + 1] = position.z;
+				features[m_TrajectoryDirectionOffset + 2 * point] = direction.x;
+				features[m_TrajectoryDirectionOffset + 2 * point + 1] = direction.z;
+			}
+		}
+	}
+
+	Normalise();
+	BuildBoundingBoxes(LARGE_BOX_FRAMES, m_LargeBoxMins, m_LargeBoxMaxs);
+	BuildBoundingBoxes(SMALL_BOX_FRAMES, m_SmallBoxMins, m_SmallBoxMaxs);
+}
+
+void MotionDatabase::Normalise()
+{
+	m_FeatureOffsets.assign(m_FeatureStride, 0.0f);
+	m_FeatureScales.assign(m_FeatureStride, 0.0f);
+	if (m_NumFrames == 0)
+		return;
+
+	std::vector<double> means(m_NumFeatures, 0.0);
+	std::vector<double> variances(m_NumFeatures, 0.0);
+	for (int frame = 0; frame < m_NumFrames; frame++)
+	{
+		const float* features = GetFeatures(frame);
+		for (int i = 0; i < m_NumFeatures; i++)
+			means[i] += features[i];
+	}
+	for (double& mean : means)
+		mean /= m_NumFrames;
+
+	for (int frame = 0; frame < m_NumFrames; frame++)
+	{
+		const float* features = GetFeatures(frame);
+		for (int i = 0; i < m_NumFeatures; i++)
+			variances[i] += (features[i] - means[i]) * (features[i] - means[i]);
+	}
+
+	// Features of the same kind (e.g. the three axes of a joint's position) share a scale, so their relative sizes are kept
+	auto normaliseGroup = [&](int first, int count, float weight)
+	{
+		double deviation = 0.0;
+		for (int i = first; i < first + count; i++)
+			deviation += std::sqrt(variances[i] / m_NumFrames);
+		deviation /= count;
+
+		float scale = deviation > 1e-8 ? (float)(weight / deviation) : weight;
+		for (int i = first; i < first + count; i++)
+		{
+			m_FeatureOffsets[i] = (float)means[i];
+			m_FeatureScales[i] = scale;
+		}
+	};
+
+	int numJoints = m_VelocityOffset / 3;
+	for (int joint = 0; joint < numJoints; joint++)
+	{
+		normaliseGroup(3 * joint, 3, m_Settings.PositionWeight);
+		normaliseGroup(m_VelocityOffset + 3 * joint, 3, m_Settings.VelocityWeight);
+	}
+	int numTrajectoryFeatures = m_TrajectoryDirectionOffset - m_TrajectoryPositionOffset;
+	normaliseGroup(m_TrajectoryPositionOffset, numTrajectoryFeatures, m_Settings.TrajectoryPositionWeight);
+	normaliseGroup(m_TrajectoryDirectionOffset, numTrajectoryFeatures, m_Settings.TrajectoryDirectionWeight);
+
+	for (int frame = 0; frame < m_NumFrames; frame++)
+	{
+		float* features = m_Features.data() + (size_t)frame * m_FeatureStride;
+		for (int i = 0; i < m_NumFeatures; i++)
+			features[i] = (features[i] - m_FeatureOffsets[i]) * m_FeatureScales[i];
+	}
+}
+
+void MotionDatabase::BuildBoundingBoxes(int framesPerBox, std::vector<float>& boxMins, std::vector<float>& boxMaxs) const
+{
+	int numBoxes = (m_NumSearchableFrames + framesPerBox - 1) / framesPerBox;
+	boxMins.assign((size_t)numBoxes * m_FeatureStride, FLT_MAX);
+	boxMaxs.assign((size_t)numBoxes * m_FeatureStride, -FLT_MAX);
+
+	for (int frame = 0; frame < m_NumSearchableFrames; frame++)
+	{
+		const float* features = GetFeatures(frame);
+		size_t box = (size_t)(frame / framesPerBox) * m_FeatureStride;
+		for (int i = 0; i < m_FeatureStride; i++)
+		{
+			boxMins[box + i] = std::min(boxMins[box + i], features[i]);
+			boxMaxs[box + i] = std::max(boxMaxs[box + i], features[i]);
+		}
+	}
+}
+
+int MotionDatabase::GetFrameIndex(int clipIndex, float time) const
+{
+	const ClipRange& range = m_Clips[clipIndex];
+	int clipFrame = (int)std::lround(time * m_Settings.SampleRate);
+	return GetFrameIndex(clipIndex, glm::clamp(clipFrame, 0, range.NumFrames - 1));
+}
+
+int MotionDatabase::GetFrameIndex(int clipIndex, int clipFrame) const
+{
+	const ClipRange& range = m_Clips[clipIndex];
+	S_ASSERT(clipFrame >= 0 && clipFrame < range.NumFrames);
+
+	if (clipFrame < range.NumSearchableFrames)
+		return range.FirstFrame + clipFrame;
+	return range.FirstUnsearchableFrame + clipFrame - range.NumSearchableFrames;
+}
+
+MotionMatch MotionDatabase::GetFrame(int frameIndex) const
+{
+	S_ASSERT(frameIndex >= 0 && frameIndex < m_NumFrames);
+
+	const FrameInfo& frame = m_Frames[frameIndex];
+	const AnimationClip* clip = m_Clips[frame.ClipIndex].Clip;
+
+	MotionMatch match;
+	match.FrameIndex = frameIndex;
+	match.ClipIndex = frame.ClipIndex;
+	match.Time = glm::min(frame.ClipFrame / m_Settings.SampleRate, clip->GetDuration() / clip->GetTicksPerSecond());
+	return match;
+}
+
+void MotionDatabase::BuildQuery(int frameIndex, const MotionTrajectory& trajectory, float* query) const
+{
+	int numTrajectoryPoints = (int)m_Settings.TrajectoryTimes.size();
+	S_ASSERT((int)trajectory.Positions.size() == numTrajectoryPoints && (int)trajectory.Directions.size() == numTrajectoryPoints);
+
+	std::copy(GetFeatures(frameIndex), GetFeatures(frameIndex) + m_FeatureStride, query);
+
+	for (int point = 0; point < numTrajectoryPoints; point++)
+	{
+		for (int axis = 0; axis < 2; axis++)
+		{
+			int position = m_TrajectoryPositionOffset + 2 * point + axis;
+			query[position] = (trajectory.Positions[point][axis] - m_FeatureOffsets[position]) * m_FeatureScales[position];
+
+			int direction = m_TrajectoryDirectionOffset + 2 * point + axis;
+			query[direction] = (trajectory.Directions[point][axis] - m_FeatureOffsets[direction]) * m_FeatureScales[direction];
+		}
+	}
+}
+
+MotionMatch MotionDatabase::Search(const float* query, MotionSearchMode mode) const
+{
+	S_PROFILE_SCOPE("MotionDatabase::Search");
+
+	MotionMatch match = mode == MotionSearchMode::BruteForce ? SearchBruteForce(query) : SearchBoundingBoxes(query);
+	if (match.FrameIndex < 0)
+		return match;
+
+	float cost = match.Cost;
+	match = GetFrame(match.FrameIndex);
+	match.Cost = cost;
+	return match;
+}
+
+float MotionDatabase::GetCost(const float* query, int frameIndex) const
+{
+	S_ASSERT(frameIndex >= 0 && frameIndex < m_NumFrames);
+	return SquaredDistance(query, GetFeatures(frameIndex), m_FeatureStride);
+}
+
+MotionMatch MotionDatabase::SearchBruteForce(const float* query) const
+{
+	MotionMatch best;
+	const float* features = m_Features.data();
+	for (int frame = 0; frame < m_NumSearchableFrames; frame++, features += m_FeatureStride)
+	{
+		float cost = SquaredDistance(query, features, m_FeatureStride);
+		if (cost < best.Cost)
+		{
+			best.Cost = cost;
+			best.FrameIndex = frame;
+		}
+	}
+	return best;
+}
+
+MotionMatch MotionDatabase::SearchBoundingBoxes(const float* query) const
+{
+	MotionMatch best;
+	int numLargeBoxes = (m_NumSearchableFrames + LARGE_BOX_FRAMES - 1) / LARGE_BOX_FRAMES;
+	for (int largeBox = 0; largeBox < numLargeBoxes; largeBox++)
+	{
+		size_t largeBoxOffset = (size_t)largeBox * m_FeatureStride;
+		if (BoxDistance(query, &m_LargeBoxMins[largeBoxOffset], &m_LargeBoxMaxs[largeBoxOffset], m_FeatureStride) >= best.Cost)
+			continue;
+
+		int firstFrame = largeBox * LARGE_BOX_FRAMES;
+		int endFrame = std::min(firstFrame + LARGE_BOX_FRAMES, m_NumSearchableFrames);
+		for (int smallBoxStart = firstFrame; smallBoxStart < endFrame; smallBoxStart += SMALL_BOX_FRAMES)
+		{
+			size_t smallBoxOffset = (size_t)(smallBoxStart / SMALL_BOX_FRAMES) * m_FeatureStride;
+			if (BoxDistance(query, &m_SmallBoxMins[smallBoxOffset], &m_SmallBoxMaxs[smallBoxOffset], m_FeatureStride) >= best.Cost)
+				continue;
+
+			int smallBoxEnd = std::min(smallBoxStart + SMALL_BOX_FRAMES, endFrame);
+			for (int frame = smallBoxStart; frame < smallBoxEnd; frame++)
+			{
+				float cost = SquaredDistance(query, GetFeatures(frame), m_FeatureStride);
+				if (cost < best.Cost)
+				{
+					best.Cost = cost;
+					best.FrameIndex = frame;
+				}
+			}
+		}
+	}
+	return best;
+}
+
+void MotionDatabase::ReportMemory(MemoryReport& report, const std::string& name) const
+{
+	size_t bytes = sizeof(*this) + MemoryHelper::GetVectorBytes(m_Clips) + MemoryHelper::GetVectorBytes(m_Frames)
+		+ MemoryHelper::GetVectorBytes(m_Features) + MemoryHelper::GetVectorBytes(m_FeatureOffsets)
+		+ MemoryHelper::GetVectorBytes(m_FeatureScales) + MemoryHelper::GetVectorBytes(m_LargeBoxMins)
+		+ MemoryHelper::GetVectorBytes(m_LargeBoxMaxs) + MemoryHelper::GetVectorBytes(m_SmallBoxMins)
+		+ MemoryHelper::GetVectorBytes(m_SmallBoxMaxs);
+	report.Add("MotionDatabases", name, bytes);
+}
\ No newline at end of file
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cfloat>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class AnimationClip;
+class JointDirectory;
+class MemoryReport;
+
+//! What MotionDatabase describes each frame of animation by
+struct MotionFeatureSettings
+{
+	//! Joints whose position and velocity (relative to the root) are matched, e.g. the feet and hips
+	std::vector<std::string> FeatureJoints;
+
+	//! Joint whose projection onto the ground defines the character's position and facing, e.g. "mixamorig:Hips"
+	std::string RootJoint;
+
+	//! Seconds into the future at which the root's position and facing are matched
+	std::vector<float> TrajectoryTimes = { 0.33f, 0.66f, 1.0f };
+
+	//! How many frames per second of each clip go into the database
+	float SampleRate = 30.0f;
+
+	//! How much each kind of feature counts towards the cost of a match, after normalisation
+	float PositionWeight = 1.0f;
+	float VelocityWeight = 1.0f;
+	float TrajectoryPositionWeight = 1.0f;
+	float TrajectoryDirectionWeight = 1.0f;
+};
+
+//! Where gameplay wants the character to be at each of MotionFeatureSettings::TrajectoryTimes,
+//! on the ground plane (X, Z) relative to the character's current position and facing
+struct MotionTrajectory
+{
+	std::vector<glm::vec2> Positions;
+	std::vector<glm::vec2> Directions;
+};
+
+enum class MotionSearchMode
+{
+	//! Compares the query with every frame
+	BruteForce,
+
+	//! Skips groups of frames whose bounding box is further from the query than the best match so far
+	BoundingBoxes
+};
+
+struct MotionMatch
+{
+	int FrameIndex = -1;
+	int ClipIndex = -1;
+
+	//! Time of the frame in its clip, in seconds
+	float Time = 0.0f;
+
+	//! Squared distance between the query and the frame's features
+	float Cost = FLT_MAX;
+};
+
+//! Describes every frame of a set of clips by the features of MotionFeatureSettings (joint positions and velocities,
+//! future trajectory), so the frame that best continues the current motion towards a desired trajectory can be found.
+//! Features are normalised so each kind counts as much as its weight says, regardless of its units.
+//! The last frames of a clip, whose future trajectory would run past its end, can be played but aren't searched.
+class MotionDatabase
+{
+public:
+	//! The clip must outlive the database
+	void AddClip(AnimationClip* clip);
+
+	//! Samples every added clip at the settings' sample rate and builds the search structures
+	void Build(const JointDirectory& skeleton, const MotionFeatureSettings& settings);
+
+	int GetNumFrames() const { return m_NumFrames; }
+	int GetNumSearchableFrames() const { return m_NumSearchableFrames; }
+	int GetNumClips() const { return (int)m_Clips.size(); }
+	AnimationClip* GetClip(int clipIndex) const { return m_Clips[clipIndex].Clip; }
+	const MotionFeatureSettings& GetSettings() const { return m_Settings; }
+
+	//! Floats per frame, padded to a multiple of four so features can be compared four at a time. Queries need this many too.
+	int GetFeatureStride() const { return m_FeatureStride; }
+
+	//! Normalised features of a frame
+	const float* GetFeatures(int frameIndex) const { return m_Features.data() + (size_t)frameIndex * m_FeatureStride; }
+
+	//! The database frame closest to the given time of a clip
+	int GetFrameIndex(int clipIndex, float time) const;
+	int GetFrameIndex(int clipIndex, int clipFrame) const;
+	MotionMatch GetFrame(int frameIndex) const;
+
+	//! Starts a query from the pose features of a frame, with its trajectory replaced by the desired one
+	void BuildQuery(int frameIndex, const MotionTrajectory& trajectory, float* query) const;
+
+	//! Frame whose features are closest to the (normalised) query
+	MotionMatch Search(const float* query, MotionSearchMode mode = MotionSearchMode::BoundingBoxes) const;
+
+	//! Squared distance between the query and a frame's features, e.g. to compare the current frame with the best match
+	float GetCost(const float* query, int frameIndex) const;
+
+	//! Adds the features and search structures to the report's "MotionDatabases"
+	void ReportMemory(MemoryReport& report, const std::string& name) const;
+private:
+	struct ClipRange
+	{
+		AnimationClip* Clip;
+		int NumFrames;
+
+		//! Searchable frames of all clips come first, followed by the rest of each clip
+		int FirstFrame;
+		int NumSearchableFrames;
+		int FirstUnsearchableFrame;
+	};
+
+	struct FrameInfo
+	{
+		int ClipIndex;
+
+		//! Index of the frame within its clip
+		int ClipFrame;
+	};
+
+	void Normalise();
+	void BuildBoundingBoxes(int framesPerBox, std::vector<float>& boxMins, std::vector<float>& boxMaxs) const;
+
+	MotionMatch SearchBruteForce(const float* query) const;
+	MotionMatch SearchBoundingBoxes(const float* query) const;
+private:
+	//! Frames per box in the two levels of bounding boxes: large ones to skip most of the database, small ones within them
+	static constexpr int LARGE_BOX_FRAMES = 64;
+	static constexpr int SMALL_BOX_FRAMES = 16;
+
+	MotionFeatureSettings m_Settings;
+
+	std::vector<ClipRange> m_Clips;
+	std::vector<FrameInfo> m_Frames;
+	int m_NumFrames = 0;
+	int m_NumSearchableFrames = 0;
+
+	//! Where each kind of feature starts in a frame's features
+	int m_VelocityOffset = 0;
+	int m_TrajectoryPositionOffset = 0;
+	int m_TrajectoryDirectionOffset = 0;
+	int m_NumFeatures = 0;
+	int m_FeatureStride = 0;
+
+	//! Frame after frame, m_FeatureStride floats each
+	std::vector<float> m_Features;
+
+	//! Normalised feature = (feature - offset) * scale
+	std::vector<float> m_FeatureOffsets;
+	std::vector<float> m_FeatureScales;
+
+	//! m_FeatureStride floats per box, for the minimum and maximum of every feature over the box's frames
+	std::vector<float> m_LargeBoxMins;
+	std::vector<float> m_LargeBoxMaxs;
+	std::vector<float> m_SmallBoxMins;
+	std::vector<float> m_SmallBoxMaxs;
+};
\ No newline at end of file
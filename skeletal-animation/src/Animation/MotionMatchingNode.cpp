@@ -0,0 +1,129 @@
+#include "MotionMatchingNode.h"
+
+#include "AnimationClip.h"
+#include "BlendHelper.h"
+#include "Core.h"
+#include "FrameArena.h"
+#include "PoseHelper.h"
+#include "Profiler.h"
+
+#include <algorithm>
+
+MotionMatchingNode::MotionMatchingNode(const MotionDatabase& database, MotionSearchMode searchMode)
+	: m_Database(database), m_SearchMode(searchMode)
+{
+	// Standing still and facing forward until told otherwise
+	size_t numTrajectoryPoints = database.GetSettings().TrajectoryTimes.size();
+	m_DesiredTrajectory.Positions.assign(numTrajectoryPoints, glm::vec2(0.0f));
+	m_DesiredTrajectory.Directions.assign(numTrajectoryPoints, glm::vec2(0.0f, 1.0f));
+}
+
+void MotionMatchingNode::SetDesiredTrajectory(const MotionTrajectory& trajectory)
+{
+	S_ASSERT(trajectory.Positions.size() == m_DesiredTrajectory.Positions.size()
+			 && trajectory.Directions.size() == m_DesiredTrajectory.Directions.size());
+
+	// Copied element by element, so the vectors keep their storage
+	std::copy(trajectory.Positions.begin(), trajectory.Positions.end(), m_DesiredTrajectory.Positions.begin());
+	std::copy(trajectory.Directions.begin(), trajectory.Directions.end(), m_DesiredTrajectory.Directions.begin());
+}
+
+float MotionMatchingNode::GetExtraJointReach() const
+{
+	float reach = 0.0f;
+	for (int i = 0; i < m_Database.GetNumClips(); i++)
+		reach = glm::max(reach, m_Database.GetClip(i)->GetExtraJointReach());
+	return reach;
+}
+
+void MotionMatchingNode::Evaluate(float animationTime, const EvaluationContext& context, PoseView pose)
+{
+	S_PROFILE_SCOPE("MotionMatchingNode::Evaluate");
+	S_ASSERT(m_Database.GetNumFrames() > 0);
+
+	// The time only goes backwards when our state has been reset
+	float deltaTime = animationTime >= m_LastAnimationTime ? animationTime - m_LastAnimationTime : animationTime;
+	m_LastAnimationTime = animationTime;
+	Advance(deltaTime);
+
+	AnimationClip* clip = m_Database.GetClip(m_ClipIndex);
+	clip->Evaluate(clip->ToClipTime(m_ClipTime), context, pose);
+
+	if (m_BlendTimeLeft <= 0.0f || context.Lod.PruneBlendBranches)
+		return;
+
+	FrameArena::Scope scratchScope(context.Arena);
+	PoseView previousPose = PoseHelper::AllocatePose(context.Arena, pose.Size);
+
+	AnimationClip* previousClip = m_Database.GetClip(m_PreviousClipIndex);
+	previousClip->Evaluate(previousClip->ToClipTime(m_PreviousClipTime), context, previousPose);
+
+	BlendHelper::BlendPoses(pose, previousPose, pose, 1.0f - m_BlendTimeLeft / m_BlendDuration);
+}
+
+MotionMatch MotionMatchingNode::GetCurrentFrame() const
+{
+	return m_Database.GetFrame(m_Database.GetFrameIndex(m_ClipIndex, m_ClipTime));
+}
+
+void MotionMatchingNode::Advance(float deltaTime)
+{
+	if (m_BlendTimeLeft > 0.0f)
+	{
+		m_BlendTimeLeft -= deltaTime;
+		m_PreviousClipTime = glm::min(m_PreviousClipTime + deltaTime, GetClipSeconds(m_PreviousClipIndex));
+	}
+
+	float clipSeconds = GetClipSeconds(m_ClipIndex);
+	m_ClipTime += deltaTime;
+	bool hasReachedEnd = m_ClipTime >= clipSeconds;
+	if (hasReachedEnd)
+		m_ClipTime = clipSeconds;
+
+	m_TimeSinceSearch += deltaTime;
+	if (m_TimeSinceSearch >= m_SearchInterval || hasReachedEnd)
+		Search(hasReachedEnd);
+}
+
+void MotionMatchingNode::Search(bool hasReachedEnd)
+{
+	m_TimeSinceSearch = 0.0f;
+
+	// Sized here rather than on construction, since the database may be built after the node is made
+	m_Query.resize(m_Database.GetFeatureStride());
+	int currentFrame = m_Database.GetFrameIndex(m_ClipIndex, m_ClipTime);
+	m_Database.BuildQuery(currentFrame, m_DesiredTrajectory, m_Query.data());
+
+	MotionMatch match = m_Database.Search(m_Query.data(), m_SearchMode);
+	bool isContinuation = match.ClipIndex == m_ClipIndex && glm::abs(match.Time - m_ClipTime) < CONTINUATION_THRESHOLD;
+
+	if (hasReachedEnd)
+	{
+		// Nothing better to go on with than the clip that just ended, so play it again
+		if (isContinuation)
+			JumpTo(m_ClipIndex, 0.0f);
+		else
+			JumpTo(match.ClipIndex, match.Time);
+	}
+	else if (!isContinuation && match.Cost < m_Database.GetCost(m_Query.data(), currentFrame) * JUMP_COST_RATIO)
+	{
+		JumpTo(match.ClipIndex, match.Time);
+	}
+}
+
+void MotionMatchingNode::JumpTo(int clipIndex, float time)
+{
+	m_PreviousClipIndex = m_ClipIndex;
+	m_PreviousClipTime = m_ClipTime;
+	m_BlendTimeLeft = m_BlendDuration;
+
+	m_ClipIndex = clipIndex;
+	m_ClipTime = time;
+	m_NumJumps++;
+}
+
+float MotionMatchingNode::GetClipSeconds(int clipIndex) const
+{
+	const AnimationClip* clip = m_Database.GetClip(clipIndex);
+	return clip->GetDuration() / clip->GetTicksPerSecond();
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cfloat>
+#include <vector>
+
+#include "AnimationNode.h"
+#include "MotionDatabase.h"
+
+//! Plays whichever frame of a MotionDatabase best continues the current motion towards the trajectory gameplay asks for.
+//! The database is searched every few frames, and the node crossfades to the best match unless that's just the next
+//! bit of the clip it's already playing. Keeps its own playback position, so every character needs its own node,
+//! while the database can be shared.
+class MotionMatchingNode : public AnimationNode
+{
+public:
+	MotionMatchingNode(const MotionDatabase& database, MotionSearchMode searchMode = MotionSearchMode::BoundingBoxes);
+
+	//! Where the character should go; see MotionTrajectory
+	void SetDesiredTrajectory(const MotionTrajectory& trajectory);
+
+	void SetSearchInterval(float seconds) { m_SearchInterval = seconds; }
+	void SetBlendDuration(float seconds) { m_BlendDuration = seconds; }
+
+	void Evaluate(float animationTime, const EvaluationContext& context, PoseView pose) override;
+
+	//! The node takes its time in seconds since its state started, and never finishes by itself
+	float GetTicksPerSecond() const override { return 1.0f; }
+	float GetDuration() const override { return FLT_MAX; }
+
+	//! The most of any of the database's clips, since the node can jump to any of them
+	float GetExtraJointReach() const override;
+
+	//! The frame being played, and how many times the node has jumped to a different one so far
+	MotionMatch GetCurrentFrame() const;
+	int GetNumJumps() const { return m_NumJumps; }
+private:
+	void Advance(float deltaTime);
+	void Search(bool hasReachedEnd);
+	void JumpTo(int clipIndex, float time);
+	float GetClipSeconds(int clipIndex) const;
+private:
+	//! Matches this close (in seconds) to where the current clip is playing don't count as a jump
+	static constexpr float CONTINUATION_THRESHOLD = 0.2f;
+
+	//! Only jump when the best match costs less than this fraction of carrying on with the current clip,
+	//! so we don't keep jumping between frames that are about as good as each other
+	static constexpr float JUMP_COST_RATIO = 0.9f;
+
+	const MotionDatabase& m_Database;
+	MotionSearchMode m_SearchMode;
+
+	MotionTrajectory m_DesiredTrajectory;
+	std::vector<float> m_Query;
+
+	float m_SearchInterval = 0.1f;
+	float m_TimeSinceSearch = 0.0f;
+	float m_LastAnimationTime = 0.0f;
+
+	//! Clip being played and the time in it, in seconds
+	int m_ClipIndex = 0;
+	float m_ClipTime = 0.0f;
+
+	//! The clip we jumped away from, which is faded out over m_BlendDuration
+	int m_PreviousClipIndex = -1;
+	float m_PreviousClipTime = 0.0f;
+	float m_BlendDuration = 0.2f;
+	float m_BlendTimeLeft = 0.0f;
+
+	int m_NumJumps = 0;
+};
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "PaletteAtlas.h"
+
+#include "AnimationClip.h"
+#include "AllocationTracker.h"
+#include "Core.h"
+#include "FrameArena.h"
+#include "MemoryReport.h"
+#include "PaletteFormat.h"
+#include "PoseHelper.h"
+#include "Profiler.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <cmath>
+
+void PaletteAtlas::AddClip(AnimationClip* clip)
+{
+	S_ASSERT(clip);
+
+	ClipInfo info;
+	info.Clip = clip;
+	m_Clips.push_back(info);
+}
+
+void PaletteAtlas::Build(const JointDirectory& skeleton, const PaletteAtlasSettings& settings)
+{
+	S_PROFILE_SCOPE("PaletteAtlas::Build");
+	S_ALLOCATION_SCOPE("PaletteAtlases");
+
+	S_ASSERT(settings.FrameRate > 0.0f && skeleton.GetNumJoints() > 0);
+	m_Settings = settings;
+	m_NumJoints = skeleton.GetNumJoints();
+
+	// Frames are spread evenly over each clip, so its last one lands exactly on its end
+	m_NumRows = 0;
+	for (ClipInfo& info : m_Clips)
+	{
+		info.Duration = info.Clip->GetDuration() / info.Clip->GetTicksPerSecond();
+		int numIntervals = glm::max((int)std::lround(info.Duration * settings.FrameRate), 1);
+		info.FirstRow = m_NumRows;
+		info.NumFrames = numIntervals + 1;
+		info.FrameDuration = info.Duration / numIntervals;
+		m_NumRows += info.NumFrames;
+	}
+
+	size_t numFloats = (size_t)GetWidth() * m_NumRows * 4;
+	m_FloatTexels.clear();
+	m_HalfTexels.clear();
+	if (settings.UseHalfFloats)
+		m_HalfTexels.resize(numFloats);
+	else
+		m_FloatTexels.resize(numFloats);
+
+	FrameArena arena;
+	AnimationLodTier fullDetail;
+	EvaluationContext context = { skeleton, fullDetail, arena };
+	const std::vector<FlatSkeletonNode>& nodes = skeleton.GetFlatNodes();
+	PoseBuffer pose = skeleton.GetDefaultPose();
+	std::vector<glm::mat4> modelSpaceTransforms;
+	std::vector<glm::mat4> skinningMatrices(m_NumJoints, glm::mat4(1.0f));
+	std::vector<glm::vec4> affineRows((size_t)m_NumJoints * TEXELS_PER_JOINT);
+
+	for (const ClipInfo& info : m_Clips)
+	{
+		for (int frame = 0; frame < info.NumFrames; frame++)
+		{
+			float time = glm::min(frame * info.FrameDuration, info.Duration);
+			info.Clip->Evaluate(info.Clip->ToClipTime(time), context, pose.GetView());
+			PoseHelper::LocalToModel(nodes, pose, modelSpaceTransforms);
+			PoseHelper::BuildSkinningMatrices(nodes, modelSpaceTransforms, skinningMatrices);
+
+			PaletteHelper::Pack(PaletteFormat::Affine3x4, skinningMatrices.data(), m_NumJoints, &affineRows[0].x);
+			for (int column = 0; column < GetWidth(); column++)
+				SetTexel(info.FirstRow + frame, column, affineRows[column]);
+		}
+	}
+}
+
+const void* PaletteAtlas::GetTexels() const
+{
+	return m_Settings.UseHalfFloats ? (const void*)m_HalfTexels.data() : (const void*)m_FloatTexels.data();
+}
+
+size_t PaletteAtlas::GetTexelBytes() const
+{
+	return m_Settings.UseHalfFloats ? m_HalfTexels.size() * sizeof(uint16_t) : m_FloatTexels.size() * sizeof(float);
+}
+
+void PaletteAtlas::SamplePalette(int clipIndex, float seconds, glm::mat4* skinningMatrices) const
+{
+	const ClipInfo& info = m_Clips[clipIndex];
+
+	// Same steps as BakedAnimVert.glsl, which blends the matrices of the two frames either side of the time
+	float clipTime = seconds - info.Duration * std::floor(seconds / info.Duration);
+	float framePosition = clipTime / info.FrameDuration;
+	int frame = glm::min((int)framePosition, info.NumFrames - 2);
+	float blend = glm::clamp(framePosition - frame, 0.0f, 1.0f);
+	int row = info.FirstRow + frame;
+
+	for (int joint = 0; joint < m_NumJoints; joint++)
+	{
+		glm::vec4 rows[TEXELS_PER_JOINT];
+		for (int i = 0; i < TEXELS_PER_JOINT; i++)
+		{
+			int column = joint * TEXELS_PER_JOINT + i;
+			rows[i] = glm::mix(GetTexel(row, column), GetTexel(row + 1, column), blend);
+		}
+		skinningMatrices[joint] = PaletteHelper::Unpack(PaletteFormat::Affine3x4, &rows[0].x);
+	}
+}
+
+glm::vec4 PaletteAtlas::GetTexel(int row, int column) const
+{
+	size_t offset = ((size_t)row * GetWidth() + column) * 4;
+	if (!m_Settings.UseHalfFloats)
+		return glm::vec4(m_FloatTexels[offset], m_FloatTexels[offset + 1], m_FloatTexels[offset + 2], m_FloatTexels[offset + 3]);
+
+	return glm::vec4(glm::unpackHalf1x16(m_HalfTexels[offset]), glm::unpackHalf1x16(m_HalfTexels[offset + 1]),
+					 glm::unpackHalf1x16(m_HalfTexels[offset + 2]), glm::unpackHalf1x16(m_HalfTexels[offset + 3]));
+}
+
+void PaletteAtlas::SetTexel(int row, int column, const glm::vec4& texel)
+{
+	size_t offset = ((size_t)row * GetWidth() + column) * 4;
+	for (int i = 0; i < 4; i++)
+	{
+		if (m_Settings.UseHalfFloats)
+			m_HalfTexels[offset + i] = glm::packHalf1x16(texel[i]);
+		else
+			m_FloatTexels[offset + i] = texel[i];
+	}
+}
+
+void PaletteAtlas::ReportMemory(MemoryReport& report, const std::string& name) const
+{
+	size_t bytes = sizeof(*this) + MemoryHelper::GetVectorBytes(m_Clips) + MemoryHelper::GetVectorBytes(m_FloatTexels)
+		+ MemoryHelper::GetVectorBytes(m_HalfTexels);
+	report.Add("PaletteAtlases", name, bytes, GetTexelBytes());
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class AnimationClip;
+class JointDirectory;
+class MemoryReport;
+
+struct PaletteAtlasSettings
+{
+	//! Frames baked per second of each clip; playback interpolates between the two nearest ones
+	float FrameRate = 30.0f;
+
+	//! Store texels as 16 bit floats (RGBA16F) instead of 32 bit ones (RGBA32F), halving the atlas at the cost of precision
+	bool UseHalfFloats = false;
+};
+
+//! Skinning palettes of whole clips, sampled ahead of time at a fixed rate and packed into a texture, so crowds can be
+//! played back by the vertex shader (see BakedAnimVert.glsl) without the CPU doing any animation work.
+//! Each row holds one frame: every joint's skinning matrix in PaletteFormat::Affine3x4, one RGBA texel per matrix row.
+//! Clips are stacked one after another, and played back as loops.
+class PaletteAtlas
+{
+public:
+	static constexpr int TEXELS_PER_JOINT = 3;
+
+	struct ClipInfo
+	{
+		AnimationClip* Clip;
+
+		int FirstRow = 0;
+		int NumFrames = 0;
+
+		//! Seconds between frames, and in the whole clip. The last frame is the clip's end, so a loop ends where it began.
+		float FrameDuration = 0.0f;
+		float Duration = 0.0f;
+	};
+
+	//! The clip must outlive the atlas
+	void AddClip(AnimationClip* clip);
+
+	//! Samples every added clip at the settings' frame rate and packs the palettes
+	void Build(const JointDirectory& skeleton, const PaletteAtlasSettings& settings = PaletteAtlasSettings());
+
+	int GetNumClips() const { return (int)m_Clips.size(); }
+	const ClipInfo& GetClip(int clipIndex) const { return m_Clips[clipIndex]; }
+	int GetNumJoints() const { return m_NumJoints; }
+
+	//! Size of the texture, in texels
+	int GetWidth() const { return m_NumJoints * TEXELS_PER_JOINT; }
+	int GetHeight() const { return m_NumRows; }
+
+	bool UsesHalfFloats() const { return m_Settings.UseHalfFloats; }
+
+	//! Four floats or halves per texel (see UsesHalfFloats), row after row, ready to upload
+	const void* GetTexels() const;
+	size_t GetTexelBytes() const;
+
+	//! Palette of a clip at a time in seconds, worked out from the stored texels exactly as the vertex shader does it,
+	//! so playback can be checked without a GPU. skinningMatrices must have room for GetNumJoints matrices.
+	void SamplePalette(int clipIndex, float seconds, glm::mat4* skinningMatrices) const;
+
+	//! Adds the texels to the report's "PaletteAtlases", with the texture's size on the GPU
+	void ReportMemory(MemoryReport& report, const std::string& name) const;
+private:
+	glm::vec4 GetTexel(int row, int column) const;
+	void SetTexel(int row, int column, const glm::vec4& texel);
+private:
+	PaletteAtlasSettings m_Settings;
+
+	std::vector<ClipInfo> m_Clips;
+	int m_NumJoints = 0;
+	int m_NumRows = 0;
+
+	//! Only the one matching m_Settings.UseHalfFloats is filled
+	std::vector<float> m_FloatTexels;
+	std::vector<uint16_t> m_HalfTexels;
+};
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "PaletteFormat.h"
+
+#include "Core.h"
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+#include <initializer_list>
+
+namespace PaletteHelper
+{
+	//! Unit dual quaternion of a matrix's rotation and translation, ignoring any scale
+	static void ToDualQuaternion(const glm::mat4& matrix, glm::quat& real, glm::quat& dual)
+	{
+		glm::mat3 rotation(glm::normalize(glm::vec3(matrix[0])), glm::normalize(glm::vec3(matrix[1])),
+						   glm::normalize(glm::vec3(matrix[2])));
+		real = glm::normalize(glm::quat_cast(rotation));
+
+		glm::vec3 translation(matrix[3]);
+		dual = 0.5f * (glm::quat(0.0f, translation.x, translation.y, translation.z) * real);
+	}
+
+	int GetFloatsPerJoint(PaletteFormat format)
+	{
+		switch (format)
+		{
+			case PaletteFormat::Matrix4x4:
+				return 16;
+			case PaletteFormat::Affine3x4:
+				return 12;
+			case PaletteFormat::DualQuaternion:
+				return 8;
+		}
+		S_ASSERT(false);
+		return 16;
+	}
+
+	void Pack(PaletteFormat format, const glm::mat4* skinningMatrices, size_t count, float* palette)
+	{
+		switch (format)
+		{
+			case PaletteFormat::Matrix4x4:
+				std::memcpy(palette, skinningMatrices, count * sizeof(glm::mat4));
+				break;
+			case PaletteFormat::Affine3x4:
+				for (size_t i = 0; i < count; i++)
+				{
+					const glm::mat4& matrix = skinningMatrices[i];
+					for (int row = 0; row < 3; row++)
+					{
+						for (int column = 0; column < 4; column++)
+							*palette++ = matrix[column][row];
+					}
+				}
+				break;
+			case PaletteFormat::DualQuaternion:
+				for (size_t i = 0; i < count; i++)
+				{
+					glm::quat real, dual;
+					ToDualQuaternion(skinningMatrices[i], real, dual);
+					for (const glm::quat& part : { real, dual })
+					{
+						*palette++ = part.x;
+						*palette++ = part.y;
+						*palette++ = part.z;
+						*palette++ = part.w;
+					}
+				}
+				break;
+		}
+	}
+
+	glm::mat4 Unpack(PaletteFormat format, const float* jointPalette)
+	{
+		switch (format)
+		{
+			case PaletteFormat::Affine3x4:
+			{
+				glm::mat4 matrix(1.0f);
+				for (int row = 0; row < 3; row++)
+				{
+					for (int column = 0; column < 4; column++)
+						matrix[column][row] = jointPalette[row * 4 + column];
+				}
+				return matrix;
+			}
+			case PaletteFormat::DualQuaternion:
+			{
+				glm::quat real(jointPalette[3], jointPalette[0], jointPalette[1], jointPalette[2]);
+				glm::quat dual(jointPalette[7], jointPalette[4], jointPalette[5], jointPalette[6]);
+				glm::quat translation = 2.0f * dual * glm::conjugate(real);
+
+				glm::mat4 matrix = glm::mat4_cast(real);
+				matrix[3] = glm::vec4(translation.x, translation.y, translation.z, 1.0f);
+				return matrix;
+			}
+			default:
+				return glm::make_mat4(jointPalette);
+		}
+	}
+
+	const char* GetName(PaletteFormat format)
+	{
+		switch (format)
+		{
+			case PaletteFormat::Affine3x4:
+				return "affine";
+			case PaletteFormat::DualQuaternion:
+				return "dual_quaternion";
+			default:
+				return "matrix";
+		}
+	}
+
+	bool ParseName(const char* name, PaletteFormat& format)
+	{
+		for (PaletteFormat candidate : { PaletteFormat::Matrix4x4, PaletteFormat::Affine3x4, PaletteFormat::DualQuaternion })
+		{
+			if (std::strcmp(name, GetName(candidate)) == 0)
+			{
+				format = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+//! How skinning matrices are laid out when they're sent to the GPU (see AnimVert.glsl)
+enum class PaletteFormat
+{
+	//! Whole column-major matrices, 16 floats per joint
+	Matrix4x4,
+
+	//! The top three rows of each matrix as three vec4s, since the fourth is always 0, 0, 0, 1. 12 floats per joint.
+	Affine3x4,
+
+	//! Rotation and translation as a unit dual quaternion: the real part, then the dual part, each as x, y, z, w.
+	//! 8 floats per joint. Scale is dropped, and blended vertices follow arcs rather than straight lines, so they
+	//! don't collapse around twisting joints (the candy wrapper artefact of blending matrices).
+	DualQuaternion
+};
+
+namespace PaletteHelper
+{
+	int GetFloatsPerJoint(PaletteFormat format);
+
+	//! palette must have room for count * GetFloatsPerJoint(format) floats
+	void Pack(PaletteFormat format, const glm::mat4* skinningMatrices, size_t count, float* palette);
+
+	//! The matrix a single joint's entry in a packed palette stands for, e.g. to measure what a format loses
+	glm::mat4 Unpack(PaletteFormat format, const float* jointPalette);
+
+	//! Name for command lines and reports: "matrix", "affine" or "dual_quaternion"
+	const char* GetName(PaletteFormat format);
+
+	//! Returns false, leaving format as it was, if the name isn't one of GetName's
+	bool ParseName(const char* name, PaletteFormat& format);
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+//! Local pose (relative to parent) of every node in a skeleton, as pointers into flat arrays owned by someone else
+//! (a PoseBuffer, or scratch memory from a FrameArena). Entry i belongs to JointDirectory::GetFlatNodes()[i].
+struct PoseView
+{
+	glm::vec3* Translations = nullptr;
+	glm::quat* Rotations = nullptr;
+	glm::vec3* Scales = nullptr;
+	size_t Size = 0;
+};
+
+//! Local pose (relative to parent) of every node in a skeleton, stored in flat arrays.
+//! Entry i belongs to JointDirectory::GetFlatNodes()[i], so parents always precede their children.
+struct PoseBuffer
+{
+	std::vector<glm::vec3> Translations;
+	std::vector<glm::quat> Rotations;
+	std::vector<glm::vec3> Scales;
+
+	void Resize(size_t numNodes)
+	{
+		Translations.resize(numNodes);
+		Rotations.resize(numNodes);
+		Scales.resize(numNodes);
+	}
+
+	size_t Size() const { return Rotations.size(); }
+
+	PoseView GetView() { return { Translations.data(), Rotations.data(), Scales.data(), Size() }; }
+};
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "PoseCache.h"
+
+#include "AnimationClip.h"
+#include "Core.h"
+#include "MemoryReport.h"
+
+#include <cmath>
+#include <functional>
+
+PoseCache::PoseCache(const PoseCacheSettings& settings)
+	: m_Settings(settings), m_Entries(settings.NumEntries)
+{
+	S_ASSERT(settings.QuantumSeconds > 0.0f && settings.NumEntries > 0);
+}
+
+int64_t PoseCache::GetBucket(const AnimationClip& clip, float animationTime) const
+{
+	float ticks = clip.UsesLocalTime() ? animationTime : animationTime * clip.GetDuration();
+	float seconds = ticks / clip.GetTicksPerSecond();
+	return (int64_t)std::floor(seconds / m_Settings.QuantumSeconds);
+}
+
+float PoseCache::GetBucketTime(const AnimationClip& clip, int64_t bucket) const
+{
+	float ticks = bucket * m_Settings.QuantumSeconds * clip.GetTicksPerSecond();
+	return clip.UsesLocalTime() ? ticks : ticks / clip.GetDuration();
+}
+
+bool PoseCache::Acquire(const Key& key, Entry*& entry)
+{
+	size_t hash = std::hash<const void*>()(key.Clip) ^ (std::hash<const void*>()(key.Lod) << 1)
+		^ (std::hash<int64_t>()(key.Bucket) * 0x9E3779B97F4A7C15ull);
+	entry = &m_Entries[hash % m_Entries.size()];
+
+	if (entry->IsValid && entry->EntryKey == key)
+	{
+		m_Stats.NumHits++;
+		return true;
+	}
+
+	m_Stats.NumMisses++;
+	entry->EntryKey = key;
+	entry->IsValid = true;
+	return false;
+}
+
+void PoseCache::Clear()
+{
+	for (Entry& entry : m_Entries)
+		entry.IsValid = false;
+}
+
+void PoseCache::ReportMemory(MemoryReport& report, const std::string& name) const
+{
+	size_t bytes = sizeof(*this) + MemoryHelper::GetVectorBytes(m_Entries);
+	for (const Entry& entry : m_Entries)
+	{
+		bytes += MemoryHelper::GetVectorBytes(entry.Pose.Translations) + MemoryHelper::GetVectorBytes(entry.Pose.Rotations)
+			+ MemoryHelper::GetVectorBytes(entry.Pose.Scales) + MemoryHelper::GetVectorBytes(entry.ModelSpaceTransforms)
+			+ MemoryHelper::GetVectorBytes(entry.SkinningMatrices);
+	}
+
+	report.Add("PoseCaches", name, bytes);
+}
\ No newline at end of file
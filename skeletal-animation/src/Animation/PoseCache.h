@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "PoseBuffer.h"
+#include "BoundingBox.h"
+
+class AnimationClip;
+class JointDirectory;
+class MemoryReport;
+struct AnimationLodTier;
+
+struct PoseCacheSettings
+{
+	//! Width of the time buckets, in seconds. Instances in the same bucket share a pose sampled at its start,
+	//! so this is also how far behind an instance's pose may lag.
+	float QuantumSeconds = 1.0f / 30.0f;
+
+	//! Buckets the cache holds at once; more of them means fewer clips and buckets evicting each other
+	int NumEntries = 256;
+};
+
+struct PoseCacheStats
+{
+	uint32_t NumHits = 0;
+	uint32_t NumMisses = 0;
+
+	float GetHitRate() const { return NumHits + NumMisses > 0 ? (float)NumHits / (NumHits + NumMisses) : 0.0f; }
+};
+
+//! Lets Animators playing the same clip at nearly the same time share one sampled pose and skinning palette
+//! (see Animator::SetPoseCache). Times are quantised into buckets, and each bucket is sampled once, at its start.
+//! Direct mapped, so looking up a bucket never allocates: a bucket that lands on an entry holding another one evicts it.
+class PoseCache
+{
+public:
+	struct Key
+	{
+		const AnimationClip* Clip = nullptr;
+		const JointDirectory* Skeleton = nullptr;
+		const AnimationLodTier* Lod = nullptr;
+		int64_t Bucket = 0;
+
+		bool operator==(const Key& other) const
+		{
+			return Clip == other.Clip && Skeleton == other.Skeleton && Lod == other.Lod && Bucket == other.Bucket;
+		}
+	};
+
+	//! Everything an Animator produces from a pose
+	struct Entry
+	{
+		Key EntryKey;
+		bool IsValid = false;
+
+		PoseBuffer Pose;
+		std::vector<glm::mat4> ModelSpaceTransforms;
+		std::vector<glm::mat4> SkinningMatrices;
+		BoundingBox Bounds;
+	};
+
+	explicit PoseCache(const PoseCacheSettings& settings = PoseCacheSettings());
+
+	//! Bucket of a time in the clip, in the units the clip is evaluated in (see AnimationClip::UsesLocalTime)
+	int64_t GetBucket(const AnimationClip& clip, float animationTime) const;
+
+	//! Start of a bucket, in the units the clip is evaluated in
+	float GetBucketTime(const AnimationClip& clip, int64_t bucket) const;
+
+	//! Entry for the key. Returns true if it already holds the key's pose; otherwise it has been handed over to the
+	//! key, and the caller must fill it in.
+	bool Acquire(const Key& key, Entry*& entry);
+
+	const PoseCacheSettings& GetSettings() const { return m_Settings; }
+
+	const PoseCacheStats& GetStats() const { return m_Stats; }
+	void ResetStats() { m_Stats = PoseCacheStats(); }
+
+	//! Drops every cached pose, e.g. after a clip has been changed
+	void Clear();
+
+	//! Adds the cached poses and palettes to the report's "PoseCaches"
+	void ReportMemory(MemoryReport& report, const std::string& name) const;
+private:
+	PoseCacheSettings m_Settings;
+	std::vector<Entry> m_Entries;
+	PoseCacheStats m_Stats;
+};
\ No newline at end of file
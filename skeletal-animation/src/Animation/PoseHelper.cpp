@@ -0,0 +1,93 @@
+#include "PoseHelper.h"
+
+#include "Core.h"
+#include "FrameArena.h"
+#include "Profiler.h"
+#include "JointMask.h"
+
+#include <glm/gtx/quaternion.hpp>
+#include <algorithm>
+
+namespace PoseHelper
+{
+	PoseView AllocatePose(FrameArena& arena, size_t numNodes)
+	{
+		PoseView pose;
+		pose.Translations = arena.AllocateArray<glm::vec3>(numNodes);
+		pose.Rotations = arena.AllocateArray<glm::quat>(numNodes);
+		pose.Scales = arena.AllocateArray<glm::vec3>(numNodes);
+		pose.Size = numNodes;
+		return pose;
+	}
+
+	void CopyPose(PoseView destination, const PoseBuffer& source)
+	{
+		S_ASSERT(destination.Size == source.Size());
+
+		std::copy(source.Translations.begin(), source.Translations.end(), destination.Translations);
+		std::copy(source.Rotations.begin(), source.Rotations.end(), destination.Rotations);
+		std::copy(source.Scales.begin(), source.Scales.end(), destination.Scales);
+	}
+
+	glm::mat4 GetLocalTransform(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
+	{
+		return glm::translate(glm::mat4(1.0f), translation) * glm::toMat4(rotation) * glm::scale(glm::mat4(1.0f), scale);
+	}
+
+	//! Model space transform of node i, whose parent's must already be in modelSpaceTransforms
+	static void NodeToModel(const std::vector<FlatSkeletonNode>& nodes, const PoseBuffer& pose, size_t i,
+							std::vector<glm::mat4>& modelSpaceTransforms)
+	{
+		glm::mat4 localTransform = GetLocalTransform(pose.Translations[i], pose.Rotations[i], pose.Scales[i]);
+
+		int parentIndex = nodes[i].ParentIndex;
+		if (parentIndex >= 0)
+			modelSpaceTransforms[i] = modelSpaceTransforms[parentIndex] * localTransform;
+		else
+			modelSpaceTransforms[i] = localTransform;
+	}
+
+	void LocalToModel(const std::vector<FlatSkeletonNode>& nodes, const PoseBuffer& pose,
+					  std::vector<glm::mat4>& modelSpaceTransforms)
+	{
+		S_PROFILE_SCOPE("PoseHelper::LocalToModel");
+
+		S_ASSERT(pose.Size() == nodes.size());
+		modelSpaceTransforms.resize(nodes.size());
+
+		// Parents are stored before their children, so each parent's model space transform is ready by the time we need it
+		for (size_t i = 0; i < nodes.size(); i++)
+			NodeToModel(nodes, pose, i, modelSpaceTransforms);
+	}
+
+	void LocalToModel(const std::vector<FlatSkeletonNode>& nodes, const PoseBuffer& pose, const JointMask& mask,
+					  std::vector<glm::mat4>& modelSpaceTransforms)
+	{
+		S_PROFILE_SCOPE("PoseHelper::LocalToModel");
+
+		S_ASSERT(pose.Size() == nodes.size() && mask.GetNumSkeletonNodes() == nodes.size());
+		modelSpaceTransforms.resize(nodes.size());
+
+		// Masks list their nodes parents first, like the skeleton
+		for (int i : mask.GetNodeIndices())
+			NodeToModel(nodes, pose, (size_t)i, modelSpaceTransforms);
+	}
+
+	void BuildSkinningMatrices(const std::vector<FlatSkeletonNode>& nodes, const std::vector<glm::mat4>& modelSpaceTransforms,
+							   std::vector<glm::mat4>& skinningMatrices)
+	{
+		S_PROFILE_SCOPE("PoseHelper::BuildSkinningMatrices");
+
+		S_ASSERT(modelSpaceTransforms.size() == nodes.size());
+
+		for (size_t i = 0; i < nodes.size(); i++)
+		{
+			const FlatSkeletonNode& node = nodes[i];
+			if (node.JointId < 0)
+				continue;
+
+			S_ASSERT(node.JointId < (int)skinningMatrices.size());
+			skinningMatrices[node.JointId] = modelSpaceTransforms[i] * node.InverseBindPose;
+		}
+	}
+}
\ No newline at end of file
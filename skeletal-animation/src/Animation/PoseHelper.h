@@ -0,0 +1,35 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+#include "JointDirectory.h"
+#include "PoseBuffer.h"
+
+class FrameArena;
+class JointMask;
+
+namespace PoseHelper
+{
+	//! Uninitialised scratch pose, valid until the arena is rewound past this point
+	PoseView AllocatePose(FrameArena& arena, size_t numNodes);
+
+	void CopyPose(PoseView destination, const PoseBuffer& source);
+
+	//! Transform of a node relative to its parent
+	glm::mat4 GetLocalTransform(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale);
+
+	//! Model space transform of every node, from the local poses of the node and all of its ancestors
+	void LocalToModel(const std::vector<FlatSkeletonNode>& nodes, const PoseBuffer& pose,
+					  std::vector<glm::mat4>& modelSpaceTransforms);
+
+	//! Same, but only for the mask's nodes. The other entries are left as they were, so the parents of any nodes
+	//! whose ancestors aren't in the mask must already be there.
+	void LocalToModel(const std::vector<FlatSkeletonNode>& nodes, const PoseBuffer& pose, const JointMask& mask,
+					  std::vector<glm::mat4>& modelSpaceTransforms);
+
+	//! Offset of every joint from its bind pose, indexed by joint ID. Nodes that aren't joints are skipped.
+	void BuildSkinningMatrices(const std::vector<FlatSkeletonNode>& nodes, const std::vector<glm::mat4>& modelSpaceTransforms,
+							   std::vector<glm::mat4>& skinningMatrices);
+}
\ No newline at end of file
@@ -0,0 +1,327 @@
+#include "Profiler.h"
+
+#include "AllocationTracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Profiler
+{
+	//! Only ever written by its own thread, so recording needs no locks. Readers see every event
+	//! up to NumEvents, which is published after the event itself is written.
+	struct ThreadEventBuffer
+	{
+		uint32_t ThreadIndex = 0;
+		std::vector<ProfileEvent> Events;
+		std::atomic<size_t> NumEvents{ 0 };
+		std::atomic<uint64_t> NumDropped{ 0 };
+	};
+
+	static std::atomic<bool> s_IsRecording{ false };
+	static Clock::time_point s_SessionStartTime;
+	static size_t s_MaxEventsPerThread = 0;
+
+	//! Guards creating buffers and starting sessions, never recording
+	static std::mutex s_BuffersMutex;
+	static std::vector<std::unique_ptr<ThreadEventBuffer>> s_Buffers;
+
+	//! Start of each frame in nanoseconds since the session started
+	static std::vector<int64_t> s_FrameStartTimes;
+
+	static thread_local ThreadEventBuffer* t_Buffer = nullptr;
+
+	static ThreadEventBuffer& GetThreadBuffer()
+	{
+		if (!t_Buffer)
+		{
+			std::lock_guard<std::mutex> lock(s_BuffersMutex);
+			s_Buffers.push_back(std::make_unique<ThreadEventBuffer>());
+			t_Buffer = s_Buffers.back().get();
+			t_Buffer->ThreadIndex = (uint32_t)s_Buffers.size() - 1;
+			t_Buffer->Events.resize(s_MaxEventsPerThread);
+		}
+		return *t_Buffer;
+	}
+
+	static int64_t ToSessionNanoseconds(Clock::time_point time)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time - s_SessionStartTime).count();
+	}
+
+	void BeginSession(size_t maxEventsPerThread)
+	{
+		std::lock_guard<std::mutex> lock(s_BuffersMutex);
+
+		s_MaxEventsPerThread = maxEventsPerThread;
+		for (std::unique_ptr<ThreadEventBuffer>& buffer : s_Buffers)
+		{
+			buffer->Events.resize(maxEventsPerThread);
+			buffer->NumEvents = 0;
+			buffer->NumDropped = 0;
+		}
+
+		s_FrameStartTimes.clear();
+		s_FrameStartTimes.reserve(1 << 16);
+
+		s_SessionStartTime = Clock::now();
+		s_IsRecording.store(true, std::memory_order_release);
+	}
+
+	void EndSession()
+	{
+		s_IsRecording.store(false, std::memory_order_release);
+	}
+
+	bool IsRecording()
+	{
+		return s_IsRecording.load(std::memory_order_relaxed);
+	}
+
+	void MarkFrame()
+	{
+		if (IsRecording())
+			s_FrameStartTimes.push_back(ToSessionNanoseconds(Clock::now()));
+	}
+
+	static void PushEvent(const ProfileEvent& event)
+	{
+		S_ALLOCATION_SCOPE("Profiler");
+
+		ThreadEventBuffer& buffer = GetThreadBuffer();
+
+		size_t index = buffer.NumEvents.load(std::memory_order_relaxed);
+		if (index >= buffer.Events.size())
+		{
+			buffer.NumDropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		buffer.Events[index] = event;
+		buffer.NumEvents.store(index + 1, std::memory_order_release);
+	}
+
+	void RecordEvent(const char* name, Clock::time_point startTime, Clock::time_point endTime)
+	{
+		int64_t durationNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+		PushEvent({ name, ToSessionNanoseconds(startTime), durationNanoseconds, false });
+	}
+
+	void RecordCounter(const char* name, int64_t value)
+	{
+		if (IsRecording())
+			PushEvent({ name, ToSessionNanoseconds(Clock::now()), value, true });
+	}
+
+	static uint64_t CountDroppedEvents()
+	{
+		uint64_t numDropped = 0;
+		for (const std::unique_ptr<ThreadEventBuffer>& buffer : s_Buffers)
+			numDropped += buffer->NumDropped.load(std::memory_order_relaxed);
+		return numDropped;
+	}
+
+	static void WriteJsonString(std::ostream& stream, const char* text)
+	{
+		stream << '"';
+		for (const char* c = text; *c; c++)
+		{
+			if (*c == '"' || *c == '\\')
+				stream << '\\';
+			stream << *c;
+		}
+		stream << '"';
+	}
+
+	bool WriteChromeTrace(const std::string& filePath)
+	{
+		std::ofstream stream(filePath);
+		if (!stream)
+			return false;
+
+		std::lock_guard<std::mutex> lock(s_BuffersMutex);
+
+		// Chrome traces are in microseconds
+		stream << std::fixed << std::setprecision(3);
+		stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+		bool isFirstEvent = true;
+		auto beginEvent = [&]()
+		{
+			if (!isFirstEvent)
+				stream << ",\n";
+			isFirstEvent = false;
+		};
+
+		for (const std::unique_ptr<ThreadEventBuffer>& buffer : s_Buffers)
+		{
+			beginEvent();
+			stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->ThreadIndex
+				<< ",\"args\":{\"name\":\"Thread " << buffer->ThreadIndex << "\"}}";
+
+			size_t numEvents = buffer->NumEvents.load(std::memory_order_acquire);
+			for (size_t i = 0; i < numEvents; i++)
+			{
+				const ProfileEvent& event = buffer->Events[i];
+				beginEvent();
+				stream << "{\"name\":";
+				WriteJsonString(stream, event.Name);
+				if (event.IsCounter)
+				{
+					stream << ",\"ph\":\"C\",\"pid\":1,\"tid\":" << buffer->ThreadIndex
+						<< ",\"ts\":" << event.StartNanoseconds / 1000.0
+						<< ",\"args\":{\"value\":" << event.Value << "}}";
+				}
+				else
+				{
+					stream << ",\"cat\":\"animation\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->ThreadIndex
+						<< ",\"ts\":" << event.StartNanoseconds / 1000.0
+						<< ",\"dur\":" << event.Value / 1000.0 << "}";
+				}
+			}
+		}
+
+		for (int64_t frameStartTime : s_FrameStartTimes)
+		{
+			beginEvent();
+			stream << "{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":" << frameStartTime / 1000.0 << "}";
+		}
+
+		stream << "\n]}\n";
+		return (bool)stream;
+	}
+
+	void WriteFrameSummary(std::ostream& stream)
+	{
+		struct ScopeSummary
+		{
+			uint64_t NumCalls = 0;
+			std::vector<int64_t> FrameNanoseconds;
+		};
+
+		struct CounterSummary
+		{
+			//! Highest value in each frame, or -1 if it wasn't recorded in that frame
+			std::vector<int64_t> FrameMaxValues;
+		};
+
+		std::lock_guard<std::mutex> lock(s_BuffersMutex);
+
+		// Without frame markers, the whole session counts as a single frame
+		std::vector<int64_t> frameStartTimes = s_FrameStartTimes;
+		bool hasFrames = !frameStartTimes.empty();
+		if (!hasFrames)
+			frameStartTimes.push_back(0);
+		size_t numFrames = frameStartTimes.size();
+
+		std::map<std::string, ScopeSummary> scopes;
+		std::map<std::string, CounterSummary> counters;
+		for (const std::unique_ptr<ThreadEventBuffer>& buffer : s_Buffers)
+		{
+			size_t numEvents = buffer->NumEvents.load(std::memory_order_acquire);
+			for (size_t i = 0; i < numEvents; i++)
+			{
+				const ProfileEvent& event = buffer->Events[i];
+				auto frameIt = std::upper_bound(frameStartTimes.begin(), frameStartTimes.end(), event.StartNanoseconds);
+				if (frameIt == frameStartTimes.begin())
+					continue;
+				size_t frameIndex = frameIt - frameStartTimes.begin() - 1;
+
+				if (event.IsCounter)
+				{
+					CounterSummary& counter = counters[event.Name];
+					if (counter.FrameMaxValues.empty())
+						counter.FrameMaxValues.resize(numFrames, -1);
+
+					counter.FrameMaxValues[frameIndex] = std::max(counter.FrameMaxValues[frameIndex], event.Value);
+					continue;
+				}
+
+				ScopeSummary& scope = scopes[event.Name];
+				if (scope.FrameNanoseconds.empty())
+					scope.FrameNanoseconds.resize(numFrames);
+
+				scope.NumCalls++;
+				scope.FrameNanoseconds[frameIndex] += event.Value;
+			}
+		}
+
+		struct SummaryRow
+		{
+			const std::string* Name;
+			double CallsPerFrame;
+			double AverageMilliseconds;
+			double MaxMilliseconds;
+		};
+
+		std::vector<SummaryRow> rows;
+		for (const auto& [name, scope] : scopes)
+		{
+			int64_t totalNanoseconds = 0;
+			int64_t maxNanoseconds = 0;
+			for (int64_t frameNanoseconds : scope.FrameNanoseconds)
+			{
+				totalNanoseconds += frameNanoseconds;
+				maxNanoseconds = std::max(maxNanoseconds, frameNanoseconds);
+			}
+			rows.push_back({ &name, (double)scope.NumCalls / numFrames, totalNanoseconds / 1e6 / numFrames, maxNanoseconds / 1e6 });
+		}
+		std::sort(rows.begin(), rows.end(),
+				  [](const SummaryRow& a, const SummaryRow& b) { return a.AverageMilliseconds > b.AverageMilliseconds; });
+
+		// Times include nested scopes
+		if (hasFrames)
+			stream << "Profile of " << numFrames << " frame(s)\n";
+		else
+			stream << "Profile of the whole session (no frames were marked)\n";
+		stream << std::left << std::setw(40) << "Scope" << std::right
+			<< std::setw(14) << "Calls/frame" << std::setw(14) << "Avg ms/frame" << std::setw(14) << "Max ms/frame" << "\n";
+		stream << std::fixed;
+		for (const SummaryRow& row : rows)
+		{
+			stream << std::left << std::setw(40) << *row.Name << std::right
+				<< std::setprecision(1) << std::setw(14) << row.CallsPerFrame
+				<< std::setprecision(4) << std::setw(14) << row.AverageMilliseconds
+				<< std::setw(14) << row.MaxMilliseconds << "\n";
+		}
+
+		if (!counters.empty())
+		{
+			stream << std::left << std::setw(40) << "Counter" << std::right
+				<< std::setw(14) << "Frames" << std::setw(14) << "Avg max" << std::setw(14) << "Max" << "\n";
+			for (const auto& [name, counter] : counters)
+			{
+				int numRecordedFrames = 0;
+				double total = 0.0;
+				int64_t maxValue = 0;
+				for (int64_t frameMaxValue : counter.FrameMaxValues)
+				{
+					if (frameMaxValue < 0)
+						continue;
+					numRecordedFrames++;
+					total += frameMaxValue;
+					maxValue = std::max(maxValue, frameMaxValue);
+				}
+				stream << std::left << std::setw(40) << name << std::right
+					<< std::setw(14) << numRecordedFrames
+					<< std::setprecision(1) << std::setw(14) << total / std::max(numRecordedFrames, 1)
+					<< std::setw(14) << maxValue << "\n";
+			}
+		}
+		stream << std::defaultfloat;
+
+		if (uint64_t numDropped = CountDroppedEvents())
+			stream << numDropped << " event(s) were dropped because their thread's buffer was full\n";
+	}
+
+	uint64_t GetNumDroppedEvents()
+	{
+		std::lock_guard<std::mutex> lock(s_BuffersMutex);
+		return CountDroppedEvents();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+//! Lightweight scoped timers for finding out where frame time goes.
+//! Events are only recorded between Profiler::BeginSession and Profiler::EndSession, into a buffer per thread
+//! that is written without locks. Recorded sessions can be opened in chrome://tracing or ui.perfetto.dev,
+//! or summarised per frame.
+//! Building without S_ENABLE_PROFILER removes all S_PROFILE_* macros entirely.
+namespace Profiler
+{
+	using Clock = std::chrono::steady_clock;
+
+	struct ProfileEvent
+	{
+		//! Must outlive the session; the macros only take string literals
+		const char* Name;
+		int64_t StartNanoseconds;
+
+		//! Duration of a scope, or the value of a counter
+		int64_t Value;
+		bool IsCounter;
+	};
+
+	//! Starts recording, discarding any previously recorded events. Each thread records up to
+	//! maxEventsPerThread events, after which further events are dropped rather than allocating.
+	//! No thread may be inside a profiled scope while a session begins or ends.
+	void BeginSession(size_t maxEventsPerThread = 1 << 20);
+	void EndSession();
+	bool IsRecording();
+
+	//! Marks the start of a new frame, so events can be summarised per frame
+	void MarkFrame();
+
+	void RecordEvent(const char* name, Clock::time_point startTime, Clock::time_point endTime);
+
+	//! Samples a non-negative value that changes over time, such as memory use
+	void RecordCounter(const char* name, int64_t value);
+
+	//! Chrome trace event format JSON, also understood by Perfetto. Returns false if the file couldn't be written.
+	bool WriteChromeTrace(const std::string& filePath);
+
+	//! Per scope call count, and average and worst time per frame over all frames marked in the session.
+	//! Counters are summarised by the average and largest of their highest value in each frame.
+	void WriteFrameSummary(std::ostream& stream);
+
+	//! Events that didn't fit in their thread's buffer
+	uint64_t GetNumDroppedEvents();
+
+	class ProfileScope
+	{
+	public:
+		explicit ProfileScope(const char* name)
+			: m_Name(IsRecording() ? name : nullptr)
+		{
+			if (m_Name)
+				m_StartTime = Clock::now();
+		}
+
+		~ProfileScope()
+		{
+			if (m_Name)
+				RecordEvent(m_Name, m_StartTime, Clock::now());
+		}
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+	private:
+		const char* m_Name;
+		Clock::time_point m_StartTime;
+	};
+}
+
+#define S_PROFILE_CONCAT_IMPL(a, b) a##b
+#define S_PROFILE_CONCAT(a, b) S_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef S_ENABLE_PROFILER
+	#define S_PROFILE_SCOPE(name) ::Profiler::ProfileScope S_PROFILE_CONCAT(profileScope, __LINE__)(name)
+	#define S_PROFILE_FRAME() ::Profiler::MarkFrame()
+	#define S_PROFILE_COUNTER(name, value) ::Profiler::RecordCounter(name, value)
+#else
+	#define S_PROFILE_SCOPE(name)
+	#define S_PROFILE_FRAME()
+	#define S_PROFILE_COUNTER(name, value)
+#endif
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "RootMotionTrack.h"
+
+#include "JointClip.h"
+#include "MemoryReport.h"
+#include "Core.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+
+//! Rotates a vector on the ground plane by the given heading
+static glm::vec3 RotateHeading(const glm::vec3& vector, float heading)
+{
+	float cosine = glm::cos(heading);
+	float sine = glm::sin(heading);
+	return glm::vec3(vector.x * cosine + vector.z * sine, 0.0f, vector.z * cosine - vector.x * sine);
+}
+
+RootMotionDelta RootMotionDelta::Then(const RootMotionDelta& next) const
+{
+	RootMotionDelta combined;
+	combined.Translation = Translation + RotateHeading(next.Translation, Rotation);
+	combined.Rotation = Rotation + next.Rotation;
+	return combined;
+}
+
+RootMotionDelta RootMotionDelta::Inverse() const
+{
+	RootMotionDelta inverse;
+	inverse.Translation = -RotateHeading(Translation, -Rotation);
+	inverse.Rotation = -Rotation;
+	return inverse;
+}
+
+RootMotionTrack RootMotionTrack::Extract(const JointClip& joint, const glm::mat4& parentTransform, float duration,
+										 float ticksPerSecond)
+{
+	RootMotionTrack track;
+	track.m_Duration = duration / ticksPerSecond;
+
+	glm::mat3 parentRotation = glm::mat3(parentTransform);
+	for (int axis = 0; axis < 3; axis++)
+		parentRotation[axis] = glm::normalize(parentRotation[axis]);
+
+	int numKeys = (int)std::ceil(track.m_Duration * SAMPLES_PER_SECOND) + 1;
+	track.m_Keys.resize(numKeys);
+
+	glm::vec3 startPosition;
+	glm::mat3 previousRotation;
+	int headingAxis = -1;
+	float headingOffset = 0.0f;
+	float previousHeading = 0.0f;
+	for (int i = 0; i < numKeys; i++)
+	{
+		float seconds = glm::min(i / SAMPLES_PER_SECOND, track.m_Duration);
+		LocalPose pose = joint.Sample(seconds * ticksPerSecond);
+
+		glm::vec3 position = glm::vec3(parentTransform * glm::vec4(pose.Translation, 1.0f));
+		glm::mat3 rotation = parentRotation * glm::mat3_cast(pose.Rotation);
+		if (i == 0)
+		{
+			startPosition = glm::vec3(position.x, 0.0f, position.z);
+			previousRotation = rotation;
+		}
+
+		// Heading follows whichever of the joint's axes lies flattest, so it's never read from an axis near vertical,
+		// where it would jump by half a turn. When a different axis gets flatter, the heading carries on from how far
+		// that axis turned since the last sample, so it stays continuous.
+		int flattestAxis = 0;
+		for (int axis = 1; axis < 3; axis++)
+		{
+			if (glm::abs(rotation[axis].y) < glm::abs(rotation[flattestAxis].y))
+				flattestAxis = axis;
+		}
+		if (flattestAxis != headingAxis)
+		{
+			const glm::vec3& previousDirection = previousRotation[flattestAxis];
+			headingOffset = previousHeading - std::atan2(previousDirection.x, previousDirection.z);
+			headingAxis = flattestAxis;
+		}
+		previousRotation = rotation;
+
+		const glm::vec3& direction = rotation[headingAxis];
+		float heading = std::atan2(direction.x, direction.z) + headingOffset;
+
+		// Unwrapped, so a character turning round and round keeps adding up its turns
+		heading += glm::two_pi<float>() * std::round((previousHeading - heading) / glm::two_pi<float>());
+		previousHeading = heading;
+
+		// The character turns about its origin, so the root's start position swings round with it
+		glm::vec3 groundPosition(position.x, 0.0f, position.z);
+		glm::vec3 origin = groundPosition - RotateHeading(startPosition, heading);
+
+		track.m_Keys[i] = { glm::vec2(origin.x, origin.z), heading };
+	}
+
+	track.m_Total = ToDelta(track.m_Keys.back());
+	return track;
+}
+
+RootMotionTrack::Key RootMotionTrack::Sample(float seconds) const
+{
+	S_ASSERT(!m_Keys.empty());
+
+	float position = glm::clamp(seconds, 0.0f, m_Duration) * SAMPLES_PER_SECOND;
+	int index = glm::min((int)position, (int)m_Keys.size() - 1);
+	int nextIndex = glm::min(index + 1, (int)m_Keys.size() - 1);
+
+	// The last key may be closer than a full sample after the one before it
+	float keySpacing = glm::min(1.0f, m_Duration * SAMPLES_PER_SECOND - index);
+	float t = keySpacing > 0.0f ? glm::min((position - index) / keySpacing, 1.0f) : 0.0f;
+
+	const Key& key = m_Keys[index];
+	const Key& nextKey = m_Keys[nextIndex];
+	return { glm::mix(key.Position, nextKey.Position, t), glm::mix(key.Heading, nextKey.Heading, t) };
+}
+
+RootMotionDelta RootMotionTrack::ToDelta(const Key& key)
+{
+	RootMotionDelta delta;
+	delta.Translation = glm::vec3(key.Position.x, 0.0f, key.Position.y);
+	delta.Rotation = key.Heading;
+	return delta;
+}
+
+RootMotionDelta RootMotionTrack::Repeat(const RootMotionDelta& delta, int count)
+{
+	// Square and multiply, so far off times don't cost a step per loop
+	RootMotionDelta result;
+	RootMotionDelta power = count < 0 ? delta.Inverse() : delta;
+	for (int remaining = glm::abs(count); remaining > 0; remaining >>= 1)
+	{
+		if (remaining & 1)
+			result = result.Then(power);
+		power = power.Then(power);
+	}
+	return result;
+}
+
+RootMotionDelta RootMotionTrack::GetMotion(float seconds, bool isLooping) const
+{
+	if (!isLooping || m_Duration <= 0.0f)
+		return ToDelta(Sample(seconds));
+
+	float numLoops = std::floor(seconds / m_Duration);
+	if (numLoops == 0.0f)
+		return ToDelta(Sample(seconds));
+	return Repeat(m_Total, (int)numLoops).Then(ToDelta(Sample(seconds - numLoops * m_Duration)));
+}
+
+RootMotionDelta RootMotionTrack::GetDelta(float startSeconds, float endSeconds, bool isLooping) const
+{
+	return GetMotion(startSeconds, isLooping).Inverse().Then(GetMotion(endSeconds, isLooping));
+}
+
+void RootMotionTrack::GetTrajectory(float seconds, const float* futureSeconds, size_t count, glm::vec2* positions,
+									glm::vec2* directions, bool isLooping) const
+{
+	RootMotionDelta toStart = GetMotion(seconds, isLooping).Inverse();
+	for (size_t i = 0; i < count; i++)
+	{
+		RootMotionDelta delta = toStart.Then(GetMotion(seconds + futureSeconds[i], isLooping));
+		positions[i] = glm::vec2(delta.Translation.x, delta.Translation.z);
+		directions[i] = glm::vec2(glm::sin(delta.Rotation), glm::cos(delta.Rotation));
+	}
+}
+
+glm::mat4 RootMotionTrack::GetTransform(float seconds) const
+{
+	Key key = Sample(seconds);
+	glm::mat4 translation = glm::translate(glm::mat4(1.0f), glm::vec3(key.Position.x, 0.0f, key.Position.y));
+	return glm::rotate(translation, key.Heading, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+size_t RootMotionTrack::GetMemoryUsage() const
+{
+	return MemoryHelper::GetVectorBytes(m_Keys);
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class JointClip;
+
+//! Movement of the character as a whole: a translation on the ground plane followed by a turn about the Y axis
+struct RootMotionDelta
+{
+	//! Relative to where the character faced at the start of the motion; Y is always 0
+	glm::vec3 Translation = glm::vec3(0.0f);
+
+	//! Radians about the Y axis; positive turns +Z towards +X
+	float Rotation = 0.0f;
+
+	//! This motion followed by the next one, which is relative to where this one ends up
+	RootMotionDelta Then(const RootMotionDelta& next) const;
+
+	RootMotionDelta Inverse() const;
+};
+
+//! The ground projection and heading of a clip's root joint over time, extracted at import so the clip's pose can move
+//! in place while gameplay moves the character. Stored as a handful of floats per sample at a fixed rate, so queries
+//! are a lookup and a lerp rather than a key frame search, and never need the skeleton or a pose.
+class RootMotionTrack
+{
+public:
+	static constexpr float SAMPLES_PER_SECOND = 30.0f;
+
+	//! Follows the joint through a clip of the given duration (in ticks). parentTransform is the model space transform
+	//! of the joint's parent, which mustn't be animated itself.
+	static RootMotionTrack Extract(const JointClip& joint, const glm::mat4& parentTransform, float duration, float ticksPerSecond);
+
+	bool IsEmpty() const { return m_Keys.empty(); }
+
+	//! In seconds, like every time below
+	float GetDuration() const { return m_Duration; }
+
+	//! Motion from the start of the clip up to the given time
+	RootMotionDelta GetMotion(float seconds, bool isLooping = false) const;
+
+	//! Motion from startSeconds to endSeconds, relative to where the character faces at startSeconds. Looping clips
+	//! wrap around as often as it takes, so endSeconds may lie any number of loops ahead; other clips clamp to their ends.
+	RootMotionDelta GetDelta(float startSeconds, float endSeconds, bool isLooping = false) const;
+
+	//! Where the character will be and which way it will face at each of futureSeconds from now, on the ground plane
+	//! (X, Z) relative to its current position and facing (the same convention as MotionTrajectory)
+	void GetTrajectory(float seconds, const float* futureSeconds, size_t count, glm::vec2* positions, glm::vec2* directions,
+					   bool isLooping = false) const;
+
+	//! Motion over the whole clip
+	const RootMotionDelta& GetTotal() const { return m_Total; }
+
+	//! Model space transform that takes the clip's in-place pose at the given time to where the original clip had it
+	glm::mat4 GetTransform(float seconds) const;
+
+	//! Heap memory held by the samples
+	size_t GetMemoryUsage() const;
+private:
+	struct Key
+	{
+		//! Where the character's origin has moved to on the ground plane (X, Z)
+		glm::vec2 Position;
+		float Heading;
+	};
+
+	Key Sample(float seconds) const;
+	static RootMotionDelta ToDelta(const Key& key);
+	static RootMotionDelta Repeat(const RootMotionDelta& delta, int count);
+private:
+	std::vector<Key> m_Keys;
+	float m_Duration = 0.0f;
+	RootMotionDelta m_Total;
+};
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "SyntheticRigHelper.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+
+namespace SyntheticRigHelper
+{
+	//! As long as Mixamo's joint names (e.g. "mixamorig:LeftHandIndex2"), so they don't fit in a small string buffer either
+	static std::string GetJointName(int index)
+	{
+		return "syntheticrig:Joint" + std::to_string(index);
+	}
+
+	static void CreateNode(SkeletonNode& node, int index, const std::vector<std::vector<int>>& children, float boneLength)
+	{
+		node.Name = GetJointName(index);
+		node.Transform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, index > 0 ? boneLength : 0.0f, 0.0f));
+
+		node.Children.resize(children[index].size());
+		for (size_t i = 0; i < children[index].size(); i++)
+			CreateNode(node.Children[i], children[index][i], children, boneLength);
+	}
+
+	//! Where a root moving forward at a constant speed while turning at a constant rate has got to after some time
+	static glm::vec3 GetRootOffset(float speed, float turnRate, float seconds)
+	{
+		if (glm::abs(turnRate) < 1e-6f)
+			return glm::vec3(0.0f, 0.0f, speed * seconds);
+
+		float heading = turnRate * seconds;
+		return glm::vec3(1.0f - glm::cos(heading), 0.0f, glm::sin(heading)) * (speed / turnRate);
+	}
+
+	std::shared_ptr<JointDirectory> CreateSkeleton(const SyntheticSkeletonSettings& settings)
+	{
+		S_ASSERT(settings.NumJoints >= 1 && settings.Branching >= 1 && settings.ChainLength >= 1);
+
+		// Grow chains breadth first from the root and from the end of every chain, until there are enough joints
+		std::vector<std::vector<int>> children(settings.NumJoints);
+		std::vector<int> branchingJoints = { 0 };
+		int numJoints = 1;
+		for (size_t i = 0; i < branchingJoints.size() && numJoints < settings.NumJoints; i++)
+		{
+			for (int chain = 0; chain < settings.Branching && numJoints < settings.NumJoints; chain++)
+			{
+				int parent = branchingJoints[i];
+				for (int link = 0; link < settings.ChainLength && numJoints < settings.NumJoints; link++)
+				{
+					children[parent].push_back(numJoints);
+					parent = numJoints++;
+				}
+				branchingJoints.push_back(parent);
+			}
+		}
+
+		SkeletonNode rootNode;
+		CreateNode(rootNode, 0, children, settings.BoneLength);
+
+		std::shared_ptr<JointDirectory> jointDirectory = std::make_shared<JointDirectory>();
+		jointDirectory->SetRootNode(rootNode);
+
+		// The bind pose is the skeleton's default pose
+		const std::vector<FlatSkeletonNode>& nodes = jointDirectory->GetFlatNodes();
+		std::vector<glm::mat4> bindTransforms(nodes.size());
+		for (size_t i = 0; i < nodes.size(); i++)
+		{
+			glm::mat4 localTransform = glm::translate(glm::mat4(1.0f), nodes[i].Translation);
+			bindTransforms[i] = nodes[i].ParentIndex >= 0 ? bindTransforms[nodes[i].ParentIndex] * localTransform : localTransform;
+			jointDirectory->AppendJoint(nodes[i].Name, glm::inverse(bindTransforms[i]));
+		}
+		return jointDirectory;
+	}
+
+	std::unique_ptr<AnimationClip> CreateClip(const JointDirectory& skeleton, const SyntheticClipSettings& settings)
+	{
+		S_ASSERT(settings.DurationSeconds > 0.0f && settings.KeysPerSecond > 0.0f && settings.TicksPerSecond > 0.0f);
+
+		const std::vector<FlatSkeletonNode>& nodes = skeleton.GetFlatNodes();
+		float duration = settings.DurationSeconds * settings.TicksPerSecond;
+		int numKeys = glm::max((int)(settings.DurationSeconds * settings.KeysPerSecond + 0.5f), 1);
+
+		std::string name = settings.Name;
+		if (name.empty())
+			name = "Synthetic" + std::to_string(nodes.size()) + "x" + std::to_string(numKeys);
+
+		// Every joint swings back and forth once over the clip, out of phase with its neighbours
+		glm::vec3 swingAxis = glm::normalize(glm::vec3(1.0f, 0.5f, 0.25f));
+		float phase = settings.Seed * 0.7f;
+
+		std::vector<JointClip> jointClips;
+		jointClips.reserve(nodes.size());
+		for (size_t node = 0; node < nodes.size(); node++)
+		{
+			std::vector<PositionKeyFrame> positionKeys;
+			std::vector<RotationKeyFrame> rotationKeys;
+			std::vector<ScaleKeyFrame> scaleKeys;
+			positionKeys.reserve(numKeys);
+			rotationKeys.reserve(numKeys);
+			scaleKeys.reserve(numKeys);
+
+			for (int key = 0; key < numKeys; key++)
+			{
+				float timestamp = duration * key / glm::max(numKeys - 1, 1);
+				float angle = glm::sin(glm::two_pi<float>() * key / numKeys + node + phase * (node % 5 + 1)) * 0.5f;
+				glm::quat rotation = glm::angleAxis(angle, swingAxis);
+				glm::vec3 translation = nodes[node].Translation;
+
+				if (nodes[node].ParentIndex < 0)
+				{
+					float seconds = timestamp / settings.TicksPerSecond;
+					float heading = settings.RootTurnRate * seconds;
+					float tumble = settings.RootTumbleRate * seconds;
+					rotation = glm::angleAxis(heading, glm::vec3(0.0f, 1.0f, 0.0f)) * glm::angleAxis(tumble, settings.RootTumbleAxis)
+						* rotation;
+					translation += GetRootOffset(settings.RootSpeed, settings.RootTurnRate, seconds);
+				}
+
+				positionKeys.push_back({ translation, timestamp });
+				rotationKeys.push_back({ rotation, timestamp });
+				scaleKeys.push_back({ glm::vec3(1.0f), timestamp });
+			}
+
+			jointClips.emplace_back(nodes[node].Name, std::move(positionKeys), std::move(rotationKeys), std::move(scaleKeys));
+		}
+
+		auto clip = std::make_unique<AnimationClip>(name, duration, settings.TicksPerSecond, std::move(jointClips), true);
+		clip->BindSkeleton(skeleton);
+		if (settings.ShouldExtractRootMotion)
+			clip->ExtractRootMotion(skeleton);
+		return clip;
+	}
+
+	int GetDepth(const JointDirectory& skeleton)
+	{
+		// Parents come before their children, so a single pass sees every parent's depth first
+		const std::vector<FlatSkeletonNode>& nodes = skeleton.GetFlatNodes();
+		std::vector<int> depths(nodes.size());
+		int maxDepth = 0;
+		for (size_t i = 0; i < nodes.size(); i++)
+		{
+			depths[i] = nodes[i].ParentIndex >= 0 ? depths[nodes[i].ParentIndex] + 1 : 1;
+			maxDepth = std::max(maxDepth, depths[i]);
+		}
+		return maxDepth;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "AnimationClip.h"
+#include "JointDirectory.h"
+
+struct SyntheticSkeletonSettings
+{
+	int NumJoints = 65;
+
+	//! How many chains start at each branching joint
+	int Branching = 3;
+
+	//! Joints per chain between two branching joints (e.g. 3 for upper arm, forearm and hand).
+	//! Longer chains make deeper skeletons: roughly ChainLength * log(NumJoints / ChainLength) / log(Branching) levels.
+	int ChainLength = 1;
+
+	//! Distance of each joint from its parent, along the parent's Y axis
+	float BoneLength = 1.0f;
+};
+
+struct SyntheticClipSettings
+{
+	float DurationSeconds = 1.0f;
+
+	//! Key frames per second on every channel, spread evenly over the duration
+	float KeysPerSecond = 30.0f;
+
+	float TicksPerSecond = 30.0f;
+
+	//! Clips with different seeds swing their joints out of phase with each other
+	int Seed = 0;
+
+	//! The root moves forward (along its Z axis) at this many units per second, turning by this many radians per second
+	float RootSpeed = 0.0f;
+	float RootTurnRate = 0.0f;
+
+	//! The root also tumbles about a horizontal axis of the direction it's heading in at this many radians per second,
+	//! e.g. head over heels about X or cartwheeling about Z
+	float RootTumbleRate = 0.0f;
+	glm::vec3 RootTumbleAxis = glm::vec3(1.0f, 0.0f, 0.0f);
+
+	//! Moves the root's travel into the clip's root motion track (see AnimationClip::ExtractRootMotion)
+	bool ShouldExtractRootMotion = false;
+
+	//! Named "Synthetic<nodes>x<keys>" if left empty
+	std::string Name;
+};
+
+//! Skeletons and clips of any size for benchmarks and scaling tests, without model files, a window or a GL context
+namespace SyntheticRigHelper
+{
+	//! Joints are named "syntheticrig:Joint<index>" and numbered breadth first. Every node is bound as a joint,
+	//! with the skeleton's default pose as its bind pose.
+	std::shared_ptr<JointDirectory> CreateSkeleton(const SyntheticSkeletonSettings& settings);
+
+	//! Clip animating every node of the skeleton, in local time (see AnimationClip::UsesLocalTime)
+	std::unique_ptr<AnimationClip> CreateClip(const JointDirectory& skeleton, const SyntheticClipSettings& settings);
+
+	//! Number of nodes on the longest path from the root to a leaf, including both
+	int GetDepth(const JointDirectory& skeleton);
+}
\ No newline at end of file
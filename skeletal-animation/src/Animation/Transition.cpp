@@ -1,7 +1,11 @@
 #include "Transition.h"
 
 #include "BlendHelper.h"
+#include "PoseHelper.h"
+#include "FrameArena.h"
 #include "Animator.h"
+#include "AllocationTracker.h"
+#include "Profiler.h"
 
 Transition::Transition(AnimationState* sourceState, AnimationState* targetState, float duration)
 	: m_SourceState(sourceState), m_TargetState(targetState), m_Duration(duration)
@@ -9,21 +13,36 @@ Transition::Transition(AnimationState* sourceState, AnimationState* targetState,
 
 }
 
-void Transition::Update(float deltaTime)
+void Transition::Update(Animator& animator, float deltaTime)
 {
+	S_PROFILE_SCOPE("Transition::Update");
+	S_ALLOCATION_SCOPE("Transitions");
+
 	m_TimePassed += deltaTime;
 
 	if (m_TimePassed >= m_Duration)
 	{
-		Animator::GetInstance()->OnTransitionFinished(this);
+		animator.OnTransitionFinished(this);
 		// Reset
 		m_SourceState->Reset();
 		m_TimePassed = 0.0f;
 		return;
 	}
 
-	m_SourceState->Update(deltaTime);
-	m_TargetState->Update(deltaTime);
+	m_SourceState->Update(animator, deltaTime);
+	m_TargetState->Update(animator, deltaTime);
+}
+
+void Transition::Evaluate(const EvaluationContext& context, PoseView pose)
+{
+	S_PROFILE_SCOPE("Transition::Evaluate");
+	S_ALLOCATION_SCOPE("Transitions");
+
+	FrameArena::Scope scratchScope(context.Arena);
+	PoseView targetPose = PoseHelper::AllocatePose(context.Arena, pose.Size);
+
+	m_SourceState->Evaluate(context, pose);
+	m_TargetState->Evaluate(context, targetPose);
 
-	BlendHelper::BlendPoses(m_LocalPoses, m_SourceState->GetLocalPoses(), m_TargetState->GetLocalPoses(), m_TimePassed / m_Duration);
+	BlendHelper::BlendPoses(pose, pose, targetPose, m_TimePassed / m_Duration);
 }
\ No newline at end of file
@@ -1,19 +1,18 @@
 #pragma once
 
-#include <unordered_map>
-#include <string>
-
 #include "AnimationNode.h"
 
 class AnimationState;
+class Animator;
 
 class Transition
 {
 public:
 	Transition(AnimationState* sourceState, AnimationState* targetState, float duration);
-	void Update(float deltaTime);
+	void Update(Animator& animator, float deltaTime);
 
-	const std::unordered_map<std::string, LocalPose>& GetLocalPoses() const { return m_LocalPoses; }
+	//! Blend of the source and target states' poses, according to how far along the transition is
+	void Evaluate(const EvaluationContext& context, PoseView pose);
 
 	AnimationState* GetSourceState() const { return m_SourceState; }
 	AnimationState* GetTargetState() const { return m_TargetState; }
@@ -21,8 +20,6 @@ private:
 	AnimationState* m_SourceState;
 	AnimationState* m_TargetState;
 
-	std::unordered_map<std::string, LocalPose> m_LocalPoses;
-
 	float m_Duration;
 	float m_TimePassed = 0.0f;
 };
\ No newline at end of file
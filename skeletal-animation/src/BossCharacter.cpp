@@ -0,0 +1,77 @@
+#include "BossCharacter.h"
+
+#include "Animation/Animator.h"
+
+BossCharacter::BossCharacter(const std::string& assetDirectory, const std::shared_ptr<JointDirectory>& jointDirectory)
+	: m_JointDirectory(jointDirectory),
+	  m_IdleClip(assetDirectory + "/models/boss/idle (2).fbx", jointDirectory, false, true),
+	  m_WalkClip(assetDirectory + "/models/boss/walking.fbx", jointDirectory, false),
+	  m_RunClip(assetDirectory + "/models/boss/running.fbx", jointDirectory, false),
+	  m_HaltClip(assetDirectory + "/models/boss/run to stop.fbx", jointDirectory, false, true),
+	  m_JumpClip(assetDirectory + "/models/boss/jumping up.fbx", jointDirectory, false, true),
+	  m_FallClip(assetDirectory + "/models/boss/falling idle.fbx", jointDirectory, false, true),
+	  m_LandClip(assetDirectory + "/models/boss/hard landing.fbx", jointDirectory, false, true),
+	  m_RollClip(assetDirectory + "/models/boss/falling to roll.fbx", jointDirectory, false, true),
+	  m_LocomotionNode(&m_WalkClip, &m_RunClip),
+	  m_IdleState("Idle", &m_IdleClip, true),
+	  m_LocomotionState("Locomotion", &m_LocomotionNode, true, false),
+	  m_HaltState("Halting", &m_HaltClip),
+	  m_JumpState("Jumping", &m_JumpClip),
+	  m_FallState("Falling", &m_FallClip),
+	  m_LandState("Landing", &m_LandClip),
+	  m_RollState("Rolling", &m_RollClip),
+	  m_IdleToMove(&m_IdleState, &m_LocomotionState, 0.3f),
+	  m_MoveToIdle(&m_LocomotionState, &m_IdleState, 0.3f),
+	  m_RunToHalt(&m_LocomotionState, &m_HaltState, 0.1f),
+	  m_HaltToIdle(&m_HaltState, &m_IdleState, 0.1f),
+	  m_IdleToJump(&m_IdleState, &m_JumpState, 0.2f),
+	  m_RunToJump(&m_LocomotionState, &m_JumpState, 0.2f),
+	  m_JumpToFall(&m_JumpState, &m_FallState, 0.2f),
+	  m_FallToLand(&m_FallState, &m_LandState, 0.1f),
+	  m_FallToRoll(&m_FallState, &m_RollState, 0.3f),
+	  m_LandToIdle(&m_LandState, &m_IdleState, 0.3f),
+	  m_RollToMove(&m_RollState, &m_LocomotionState, 0.3f)
+{
+	// Nothing applies root motion to the boss yet, so its moving clips play in place the simple way
+	m_WalkClip.FreezeForwardTranslation();
+	m_RunClip.FreezeForwardTranslation();
+	m_HaltClip.FreezeForwardTranslation();
+	m_RollClip.FreezeForwardTranslation();
+
+	m_LocomotionState.AddVar<float>("MoveSpeed", { 0.2f, 0.0f, 1.0f });
+
+	m_FallState.SetCompletionTime(0.3f);
+	m_RollState.SetCompletionTime(0.7f);
+
+	m_IdleState.AddTriggerTransition("MoveTrigger", &m_IdleToMove);
+	m_LocomotionState.AddTriggerTransition("IdleTrigger", &m_MoveToIdle);
+	m_LocomotionState.AddTriggerTransition("HaltTrigger", &m_RunToHalt);
+	m_HaltState.SetOnCompleteTransition(&m_HaltToIdle);
+	m_IdleState.AddTriggerTransition("JumpTrigger", &m_IdleToJump);
+	m_LocomotionState.AddTriggerTransition("JumpTrigger", &m_RunToJump);
+	m_JumpState.SetOnCompleteTransition(&m_JumpToFall);
+	m_FallState.SetOnCompleteTransition(&m_FallToLand);
+	m_FallState.AddTriggerTransition("MoveTrigger", &m_FallToRoll);
+	m_LandState.SetOnCompleteTransition(&m_LandToIdle);
+	m_RollState.SetOnCompleteTransition(&m_RollToMove);
+}
+
+void BossCharacter::SetUpAnimator(Animator& animator)
+{
+	animator.SetDirectory(m_JointDirectory);
+	animator.SetState(&m_IdleState);
+	animator.SetFixedUpdateRate(ANIMATION_UPDATE_RATE);
+	animator.SetLodSettings(std::make_shared<AnimationLodSettings>(AnimationLodSettings::CreateDefault()));
+}
+
+std::vector<AnimationClip*> BossCharacter::GetCrowdClips()
+{
+	// Walking and running have their root motion extracted, so they play in place
+	return { &m_IdleClip, &m_WalkClip, &m_RunClip };
+}
+
+void BossCharacter::ReportMemory(MemoryReport& report) const
+{
+	for (const AnimationClip* clip : { &m_IdleClip, &m_WalkClip, &m_RunClip, &m_HaltClip, &m_JumpClip, &m_FallClip, &m_LandClip, &m_RollClip })
+		clip->ReportMemory(report);
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Animation/AnimationClip.h"
+#include "Animation/AnimationState.h"
+#include "Animation/BlendNode.h"
+#include "Animation/Transition.h"
+
+class Animator;
+class MemoryReport;
+
+//! The boss model's animation graph: idle, a walk/run blend, halting, and jumping through to falling, landing or rolling.
+//! Shared by the demo and headless tools, so a recording made in one (see AnimationRecording) can be replayed by the other.
+class BossCharacter
+{
+public:
+	//! Loads the clips from assetDirectory/models/boss, adding their skeleton to jointDirectory
+	BossCharacter(const std::string& assetDirectory, const std::shared_ptr<JointDirectory>& jointDirectory);
+
+	BossCharacter(const BossCharacter&) = delete;
+	BossCharacter& operator=(const BossCharacter&) = delete;
+
+	//! Starts the animator off in this graph's entry state, with the update rate and LOD settings the demo uses
+	void SetUpAnimator(Animator& animator);
+
+	//! The looping clips background characters play: idle, walk and run
+	std::vector<AnimationClip*> GetCrowdClips();
+
+	//! Adds the clips to the report
+	void ReportMemory(MemoryReport& report) const;
+private:
+	//! How many times per second the animation graph is ticked, independent of frame rate (0 = every frame)
+	static constexpr float ANIMATION_UPDATE_RATE = 30.0f;
+
+	std::shared_ptr<JointDirectory> m_JointDirectory;
+
+	// Clips --------------
+	AnimationClip m_IdleClip;
+	AnimationClip m_WalkClip;
+	AnimationClip m_RunClip;
+	AnimationClip m_HaltClip;
+	AnimationClip m_JumpClip;
+	AnimationClip m_FallClip;
+	AnimationClip m_LandClip;
+	AnimationClip m_RollClip;
+
+	BlendNode m_LocomotionNode;
+
+	// States --------------
+	AnimationState m_IdleState;
+	AnimationState m_LocomotionState;
+	AnimationState m_HaltState;
+	AnimationState m_JumpState;
+	AnimationState m_FallState;
+	AnimationState m_LandState;
+	AnimationState m_RollState;
+
+	// Transitions ----------
+	Transition m_IdleToMove;
+	Transition m_MoveToIdle;
+	Transition m_RunToHalt;
+	Transition m_HaltToIdle;
+	Transition m_IdleToJump;
+	Transition m_RunToJump;
+	Transition m_JumpToFall;
+	Transition m_FallToLand;
+	Transition m_FallToRoll;
+	Transition m_LandToIdle;
+	Transition m_RollToMove;
+};
\ No newline at end of file
@@ -1,3 +0,0 @@
-#pragma once
-
-#define S_ASSERT(x) { if (!(x)) __debugbreak(); }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "DrawBenchmark.h"
+
+#include "Model.h"
+#include "Shader.h"
+#include "SkinnedInstanceBatch.h"
+
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+namespace DrawBenchmark
+{
+	static constexpr int CROWD_SIZES[] = { 100, 1000, 10000 };
+
+	//! Frames drawn before timing starts, so shaders are compiled and buffers allocated, and frames timed per crowd size
+	static constexpr int WARM_UP_FRAMES = 2;
+	static constexpr int TIMED_FRAMES = 10;
+
+	//! Size of u_SkinningMatrices in AnimVert.glsl
+	static constexpr uint32_t MAX_SHADER_JOINTS = 100;
+
+	struct FrameTimes
+	{
+		//! Until the last draw call returns, and until the GPU has finished the frame
+		double SubmitMilliseconds = 0.0;
+		double FrameMilliseconds = 0.0;
+	};
+
+	using Clock = std::chrono::high_resolution_clock;
+
+	//! Characters stand in a square grid in front of the camera
+	static glm::mat4 GetModelMatrix(int index, int numCharacters)
+	{
+		int numColumns = (int)std::ceil(std::sqrt((float)numCharacters));
+		float spacing = 24.0f / numColumns;
+		glm::vec3 position((index % numColumns - 0.5f * (numColumns - 1)) * spacing, 0.0f, -(index / numColumns) * spacing);
+		return glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), glm::vec3(0.04f));
+	}
+
+	template <typename DrawFunction>
+	static FrameTimes TimeFrames(DrawFunction draw)
+	{
+		FrameTimes times;
+		for (int frame = 0; frame < WARM_UP_FRAMES + TIMED_FRAMES; frame++)
+		{
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			auto startTime = Clock::now();
+			draw();
+			auto submitTime = Clock::now();
+			glFinish();
+			auto endTime = Clock::now();
+
+			if (frame >= WARM_UP_FRAMES)
+			{
+				times.SubmitMilliseconds += std::chrono::duration<double, std::milli>(submitTime - startTime).count();
+				times.FrameMilliseconds += std::chrono::duration<double, std::milli>(endTime - startTime).count();
+			}
+		}
+
+		times.SubmitMilliseconds /= TIMED_FRAMES;
+		times.FrameMilliseconds /= TIMED_FRAMES;
+		return times;
+	}
+
+	static void WriteRow(std::ostream& stream, int numCharacters, const char* path, size_t numDrawCalls, const FrameTimes& times)
+	{
+		stream << std::setw(10) << numCharacters << std::setw(14) << path << std::setw(12) << numDrawCalls
+			<< std::fixed << std::setprecision(3)
+			<< std::setw(12) << times.SubmitMilliseconds << std::setw(12) << times.FrameMilliseconds << std::endl;
+	}
+
+	void Run(Model& model, Shader& shader, PaletteFormat paletteFormat, Shader& instancedShader, SkinnedInstanceBatch& batch,
+			 const std::vector<glm::mat4>& skinningMatrices, const glm::mat4& view, const glm::mat4& projection,
+			 std::ostream& stream)
+	{
+		uint32_t numUniformJoints = glm::min((uint32_t)skinningMatrices.size(), MAX_SHADER_JOINTS);
+		uint32_t vectorsPerJoint = PaletteHelper::GetFloatsPerJoint(paletteFormat) / 4;
+		std::vector<float> palette((size_t)numUniformJoints * vectorsPerJoint * 4);
+		PaletteHelper::Pack(paletteFormat, skinningMatrices.data(), numUniformJoints, palette.data());
+
+		shader.Bind();
+		shader.SetMat4("u_View", view);
+		shader.SetMat4("u_Projection", projection);
+		instancedShader.Bind();
+		instancedShader.SetMat4("u_View", view);
+		instancedShader.SetMat4("u_Projection", projection);
+
+		stream << "Renderer: " << glGetString(GL_RENDERER) << "\n"
+			<< "Per-character palettes are uploaded as " << PaletteHelper::GetName(paletteFormat) << ", "
+			<< palette.size() * sizeof(float) << " bytes each\n"
+			<< "Times are per frame, averaged over " << TIMED_FRAMES << " frames\n\n"
+			<< std::setw(10) << "Characters" << std::setw(14) << "Path" << std::setw(12) << "Draw calls"
+			<< std::setw(12) << "Submit ms" << std::setw(12) << "Frame ms" << "\n";
+
+		// Thousands of characters would be limited by fill rate, which instancing doesn't change, so nothing is rasterised
+		glEnable(GL_RASTERIZER_DISCARD);
+		for (int numCharacters : CROWD_SIZES)
+		{
+			FrameTimes perCharacterTimes = TimeFrames([&]()
+			{
+				shader.Bind();
+				for (int i = 0; i < numCharacters; i++)
+				{
+					shader.SetMat4("u_Model", GetModelMatrix(i, numCharacters));
+					if (paletteFormat == PaletteFormat::Matrix4x4)
+						shader.SetMat4Array("u_SkinningMatrices", skinningMatrices.data(), numUniformJoints);
+					else
+						shader.SetVec4Array("u_Palette", reinterpret_cast<const glm::vec4*>(palette.data()), numUniformJoints * vectorsPerJoint);
+					model.Draw(shader);
+				}
+			});
+			WriteRow(stream, numCharacters, "PerCharacter", model.GetNumMeshes() * numCharacters, perCharacterTimes);
+
+			FrameTimes instancedTimes = TimeFrames([&]()
+			{
+				batch.Clear();
+				for (int i = 0; i < numCharacters; i++)
+					batch.AddInstance(GetModelMatrix(i, numCharacters), skinningMatrices.data(), (uint32_t)skinningMatrices.size());
+				batch.Draw(instancedShader);
+			});
+			WriteRow(stream, numCharacters, "Instanced", model.GetNumMeshes(), instancedTimes);
+		}
+		glDisable(GL_RASTERIZER_DISCARD);
+	}
+}
\ No newline at end of file
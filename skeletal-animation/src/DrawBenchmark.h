@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <ostream>
+#include <vector>
+
+#include "Animation/PaletteFormat.h"
+
+class Model;
+class Shader;
+class SkinnedInstanceBatch;
+
+//! Times submitting crowds of 100, 1,000 and 10,000 skinned characters: a draw call per mesh per character with its
+//! palette uploaded as uniforms (AnimVert.glsl, compiled for paletteFormat), against one instanced draw per mesh
+//! (SkinnedInstanceBatch). Every character shows the same palette, since only the cost of getting it to the GPU is
+//! measured. Runs on whatever driver the demo gets, including Mesa's software renderer (LIBGL_ALWAYS_SOFTWARE=1).
+namespace DrawBenchmark
+{
+	void Run(Model& model, Shader& shader, PaletteFormat paletteFormat, Shader& instancedShader, SkinnedInstanceBatch& batch,
+			 const std::vector<glm::mat4>& skinningMatrices, const glm::mat4& view, const glm::mat4& projection,
+			 std::ostream& stream);
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include "Frustum.h"
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+	// Gribb/Hartmann: the planes are sums and differences of the matrix rows (glm matrices are column-major)
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+	m_Planes[0] = rows[3] + rows[0]; // left
+	m_Planes[1] = rows[3] - rows[0]; // right
+	m_Planes[2] = rows[3] + rows[1]; // bottom
+	m_Planes[3] = rows[3] - rows[1]; // top
+	m_Planes[4] = rows[3] + rows[2]; // near
+	m_Planes[5] = rows[3] - rows[2]; // far
+
+	for (glm::vec4& plane : m_Planes)
+		plane /= glm::length(glm::vec3(plane));
+}
+
+bool Frustum::Intersects(const BoundingBox& box) const
+{
+	for (const glm::vec4& plane : m_Planes)
+	{
+		// The corner of the box furthest along the plane normal; if even that is behind the plane, the whole box is
+		glm::vec3 furthestCorner(plane.x >= 0.0f ? box.Max.x : box.Min.x,
+								 plane.y >= 0.0f ? box.Max.y : box.Min.y,
+								 plane.z >= 0.0f ? box.Max.z : box.Min.z);
+
+		if (glm::dot(glm::vec3(plane), furthestCorner) + plane.w < 0.0f)
+			return false;
+	}
+	return true;
+}
\ No newline at end of file
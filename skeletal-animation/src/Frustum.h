@@ -0,0 +1,18 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Animation/BoundingBox.h"
+
+//! The six planes of a camera's view volume, for culling things that are off-screen
+class Frustum
+{
+public:
+	//! Extracts the planes from a combined projection * view matrix (see Camera)
+	Frustum(const glm::mat4& viewProjection);
+
+	bool Intersects(const BoundingBox& box) const;
+private:
+	//! xyz is the plane normal pointing into the frustum, w the distance from the origin
+	glm::vec4 m_Planes[6];
+};
\ No newline at end of file
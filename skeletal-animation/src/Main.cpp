@@ -7,10 +7,27 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "Camera.h"
+#include "Frustum.h"
 #include "Model.h"
 #include "Shader.h"
+#include "BossCharacter.h"
+#include "DrawBenchmark.h"
+#include "SkinnedInstanceBatch.h"
+#include "TextureHelper.h"
 #include "Animation/Animator.h"
-#include "Animation/BlendNode.h"
+#include "Animation/AnimationScheduler.h"
+#include "Animation/AnimationRecording.h"
+#include "Animation/Profiler.h"
+#include "Animation/AllocationTracker.h"
+#include "Animation/CpuSkinning.h"
+#include "Animation/MemoryReport.h"
+#include "Animation/PaletteAtlas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 
 static Camera s_Camera({ 0.0f, 4.0f, 13.0f });
 
@@ -19,7 +36,79 @@ static float s_LastFrameTime = 0.0f;
 
 static float s_MoveSpeed = 0.0f;
 
+//! CPU time per frame animators may use, and how many frames one can go without updating if over budget
+static constexpr float ANIMATION_BUDGET_MS = 2.0f;
+static constexpr int ANIMATION_MAX_FRAMES_WITHOUT_UPDATE = 4;
 
+//! Size of u_SkinningMatrices in AnimVert.glsl
+static constexpr uint32_t MAX_SHADER_JOINTS = 100;
+
+//! Texture unit of the palette atlas, after the ones Mesh::Draw binds its textures to
+static constexpr int PALETTE_ATLAS_TEXTURE_UNIT = 8;
+
+//! Spacing of the crowds standing behind the boss, and how many seconds each one's clip runs ahead of the previous one's
+static constexpr float CROWD_SPACING = 3.0f;
+static constexpr float CROWD_TIME_OFFSET = 0.37f;
+
+//! Scheduling priority of crowd animators, below the boss's
+static constexpr float CROWD_PRIORITY = 0.1f;
+
+
+
+//! One of the boss's meshes, skinned on the CPU as well as by AnimVert.glsl
+struct CpuSkinnedMesh
+{
+	CpuSkinning Skinning;
+	std::vector<glm::vec3> Positions;
+	std::vector<glm::vec3> Normals;
+};
+
+//! How far any of the points stick out of the box, along any axis
+static float GetDistanceOutside(const BoundingBox& box, const std::vector<glm::vec3>& points)
+{
+	glm::vec3 outside(0.0f);
+	for (const glm::vec3& point : points)
+		outside = glm::max(outside, glm::max(box.Min - point, point - box.Max));
+	return glm::max(outside.x, glm::max(outside.y, outside.z));
+}
+
+//! The light never changes, so there's no need to set it every frame
+static void SetUpLight(Shader& shader)
+{
+	shader.Bind();
+	shader.SetVec3("u_DirLight.Direction", { -0.2f, -1.0f, -0.3f });
+	shader.SetVec3("u_DirLight.Ambient", { 0.2f, 0.2f, 0.2f });
+	shader.SetVec3("u_DirLight.Diffuse", { 0.8f, 0.8f, 0.8f });
+	shader.SetVec3("u_DirLight.Specular", { 0.3f, 0.3f, 0.3f });
+}
+
+//! Rows of characters behind the boss, starting firstRow rows back
+static glm::mat4 GetCrowdModelMatrix(int index, int numColumns, int firstRow)
+{
+	int column = index % numColumns;
+	int row = firstRow + index / numColumns;
+	glm::vec3 position((column - 0.5f * (numColumns - 1)) * CROWD_SPACING, 0.0f, -(row + 1) * CROWD_SPACING);
+	return glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), glm::vec3(0.04f));
+}
+
+static int GetCrowdColumns(int numCharacters)
+{
+	return (int)std::ceil(std::sqrt((float)numCharacters));
+}
+
+//! Tells AnimVert.glsl which palette format it gets
+static std::string GetPaletteDefines(PaletteFormat format)
+{
+	switch (format)
+	{
+		case PaletteFormat::Affine3x4:
+			return "#define PALETTE_AFFINE_3X4\n";
+		case PaletteFormat::DualQuaternion:
+			return "#define PALETTE_DUAL_QUATERNION\n";
+		default:
+			return "";
+	}
+}
 
 void FrameBufferSizeCallback(GLFWwindow* window, int width, int height)
 {
@@ -41,8 +130,41 @@ void OnMouseScroll(GLFWwindow* window, double xOffset, double yOffset)
 	s_Camera.OnMouseScroll(yOffset);
 }
 
-int main()
+int main(int argc, char** argv)
 {
+	// --memory_report prints what the loaded assets cost and exits, instead of running the demo.
+	// --record=<file> saves the boss animator's inputs on exit, for replaying with animation-benchmarks --replay.
+	// --baked_crowd=<count> puts a crowd behind the boss, played back from baked palettes by the GPU (see PaletteAtlas).
+	// --instanced_crowd=<count> adds a crowd with an Animator each, drawn with one draw call per mesh (see SkinnedInstanceBatch).
+	// --draw_benchmark times drawing crowds one character at a time and instanced (see DrawBenchmark), then exits.
+	// --palette_format=matrix|affine|dual_quaternion picks how the boss's palette is uploaded (see PaletteFormat).
+	// --cpu_skinning also skins the boss on the CPU whenever its pose changes (see CpuSkinning), and reports on exit how
+	// far its vertices strayed outside the animator's bounds.
+	bool shouldReportMemory = false;
+	PaletteFormat paletteFormat = PaletteFormat::Matrix4x4;
+	bool shouldBenchmarkDraws = false;
+	bool shouldSkinOnCpu = false;
+	const char* recordingFilePath = nullptr;
+	int numCrowdCharacters = 0;
+	int numInstancedCharacters = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--memory_report") == 0)
+			shouldReportMemory = true;
+		else if (std::strncmp(argv[i], "--record=", 9) == 0)
+			recordingFilePath = argv[i] + 9;
+		else if (std::strncmp(argv[i], "--baked_crowd=", 14) == 0)
+			numCrowdCharacters = std::max(std::atoi(argv[i] + 14), 0);
+		else if (std::strncmp(argv[i], "--instanced_crowd=", 18) == 0)
+			numInstancedCharacters = std::max(std::atoi(argv[i] + 18), 0);
+		else if (std::strcmp(argv[i], "--draw_benchmark") == 0)
+			shouldBenchmarkDraws = true;
+		else if (std::strcmp(argv[i], "--cpu_skinning") == 0)
+			shouldSkinOnCpu = true;
+		else if (std::strncmp(argv[i], "--palette_format=", 17) == 0 && !PaletteHelper::ParseName(argv[i] + 17, paletteFormat))
+			std::cout << "Unknown palette format " << argv[i] + 17 << ", using matrices" << std::endl;
+	}
+
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -71,84 +193,137 @@ int main()
 
 	glfwSetFramebufferSizeCallback(window, FrameBufferSizeCallback);
 
-	Shader shader("assets/shaders/AnimVert.glsl", "assets/shaders/MeshFrag.glsl");
-	shader.Bind();
+	Shader shader("assets/shaders/AnimVert.glsl", "assets/shaders/MeshFrag.glsl", GetPaletteDefines(paletteFormat));
+	SetUpLight(shader);
 
 	std::shared_ptr<JointDirectory> jointDirectory = std::make_shared<JointDirectory>();
 
 	Model bossModel("assets/models/boss/The Boss.fbx", jointDirectory);
 
-	// Clips --------------
-	AnimationClip idleClip("assets/models/boss/idle (2).fbx", jointDirectory, false, true);
-	AnimationClip walkClip("assets/models/boss/walking.fbx", jointDirectory, true);
-	AnimationClip runClip("assets/models/boss/running.fbx", jointDirectory, true);
-	AnimationClip haltClip("assets/models/boss/run to stop.fbx", jointDirectory, true, true);
-	AnimationClip jumpClip("assets/models/boss/jumping up.fbx", jointDirectory, false, true);
-	AnimationClip fallClip("assets/models/boss/falling idle.fbx", jointDirectory, false, true);
-	AnimationClip landClip("assets/models/boss/hard landing.fbx", jointDirectory, false, true);
-	AnimationClip rollClip("assets/models/boss/falling to roll.fbx", jointDirectory, true, true);
-
-	BlendNode locomotionNode(&walkClip, &runClip);
+	BossCharacter boss("assets", jointDirectory);
 
-	// States --------------
-	AnimationState idleState("Idle", &idleClip, true);
+	Animator animator;
+	boss.SetUpAnimator(animator);
+	animator.SetPaletteFormat(paletteFormat);
 
-	AnimationState locomotionState("Locomotion", &locomotionNode, true, false);
-	locomotionState.AddVar<float>("MoveSpeed", { 0.2f, 0.0f, 1.0f });
+	glm::vec3 bossPosition(0.0f);
 
-	AnimationState haltState("Halting", &haltClip);
-	AnimationState jumpState("Jumping", &jumpClip);
-	AnimationState fallState("Falling", &fallClip);
-	AnimationState landState("Landing", &landClip);
-	AnimationState rollState("Rolling", &rollClip);
-	
-	fallState.SetCompletionTime(0.3f);
-	rollState.SetCompletionTime(0.7f);
+	AnimationScheduler animationScheduler(ANIMATION_BUDGET_MS, ANIMATION_MAX_FRAMES_WITHOUT_UPDATE);
+	animationScheduler.AddAnimator(&animator);
 
-	// Transitions ----------
-	Transition idleToMove(&idleState, &locomotionState, 0.3f);
-	idleState.AddTriggerTransition("MoveTrigger", &idleToMove);
+	// The crowd's palettes are baked once, here; after that the vertex shader reads them by clip and time
+	PaletteAtlas crowdAtlas;
+	std::unique_ptr<Shader> crowdShader;
+	uint32_t crowdAtlasTextureId = 0;
+	if (numCrowdCharacters > 0)
+	{
+		for (AnimationClip* clip : boss.GetCrowdClips())
+			crowdAtlas.AddClip(clip);
+		crowdAtlas.Build(*jointDirectory);
+		crowdAtlasTextureId = TextureHelper::CreatePaletteTexture(crowdAtlas);
+
+		crowdShader = std::make_unique<Shader>("assets/shaders/BakedAnimVert.glsl", "assets/shaders/MeshFrag.glsl");
+		SetUpLight(*crowdShader);
+		crowdShader->SetInt("u_PaletteAtlas", PALETTE_ATLAS_TEXTURE_UNIT);
+	}
 
-	Transition moveToIdle(&locomotionState, &idleState, 0.3f);
-	locomotionState.AddTriggerTransition("IdleTrigger", &moveToIdle);
+	// The instanced crowd is animated on the CPU like the boss, but drawn all at once. The batch adds instanced
+	// attributes to the boss's meshes, so it's only created when something draws with it.
+	std::unique_ptr<Shader> instancedShader;
+	std::unique_ptr<SkinnedInstanceBatch> instanceBatch;
+	if (numInstancedCharacters > 0 || shouldBenchmarkDraws)
+	{
+		instancedShader = std::make_unique<Shader>("assets/shaders/InstancedAnimVert.glsl", "assets/shaders/MeshFrag.glsl");
+		SetUpLight(*instancedShader);
+		instanceBatch = std::make_unique<SkinnedInstanceBatch>(bossModel);
+	}
 
-	Transition runToHalt(&locomotionState, &haltState, 0.1f);
-	locomotionState.AddTriggerTransition("HaltTrigger", &runToHalt);
-	
-	Transition haltToIdle(&haltState, &idleState, 0.1f);
-	haltState.SetOnCompleteTransition(&haltToIdle);
+	// Stands behind the baked crowd
+	int instancedColumns = GetCrowdColumns(numInstancedCharacters);
+	int bakedColumns = GetCrowdColumns(numCrowdCharacters);
+	int instancedFirstRow = numCrowdCharacters > 0 ? (numCrowdCharacters + bakedColumns - 1) / bakedColumns : 0;
 
-	Transition idleToJump(&idleState, &jumpState, 0.2f);
-	idleState.AddTriggerTransition("JumpTrigger", &idleToJump);
+	std::vector<AnimationClip*> crowdClips = boss.GetCrowdClips();
+	std::vector<std::unique_ptr<AnimationState>> instancedStates;
+	std::vector<std::unique_ptr<Animator>> instancedAnimators;
+	for (int i = 0; i < numInstancedCharacters; i++)
+	{
+		instancedStates.push_back(std::make_unique<AnimationState>("Crowd", crowdClips[i % crowdClips.size()], true));
+		instancedAnimators.push_back(std::make_unique<Animator>());
+
+		Animator& crowdAnimator = *instancedAnimators.back();
+		crowdAnimator.SetDirectory(jointDirectory);
+		crowdAnimator.SetState(instancedStates.back().get());
+		crowdAnimator.Update(CROWD_TIME_OFFSET * i);
+		animationScheduler.AddAnimator(&crowdAnimator, CROWD_PRIORITY);
+	}
 
-	Transition runToJump(&locomotionState, &jumpState, 0.2f);
-	locomotionState.AddTriggerTransition("JumpTrigger", &runToJump);
+	if (shouldBenchmarkDraws)
+	{
+		animator.Update(1.0f / 60.0f);
+		DrawBenchmark::Run(bossModel, shader, paletteFormat, *instancedShader, *instanceBatch, animator.GetSkinningMatrices(),
+						   s_Camera.GetViewMatrix(), s_Camera.GetProjectionMatrix(), std::cout);
+		glfwTerminate();
+		return 0;
+	}
 
-	Transition jumpToFall(&jumpState, &fallState, 0.2f);
-	jumpState.SetOnCompleteTransition(&jumpToFall);
+	std::vector<CpuSkinnedMesh> cpuSkinnedMeshes(shouldSkinOnCpu ? bossModel.GetNumMeshes() : 0);
+	size_t numCpuSkinnedVertices = 0;
+	for (size_t i = 0; i < cpuSkinnedMeshes.size(); i++)
+	{
+		CpuSkinnedMesh& mesh = cpuSkinnedMeshes[i];
+		mesh.Skinning.Build(bossModel.GetMesh(i).GetSkinningSource());
+		mesh.Positions.resize(mesh.Skinning.GetNumVertices());
+		mesh.Normals.resize(mesh.Skinning.GetNumVertices());
+		numCpuSkinnedVertices += mesh.Skinning.GetNumVertices();
+	}
+	if (shouldSkinOnCpu)
+		std::cout << "Skinning " << numCpuSkinnedVertices << " vertices of " << bossModel.GetName() << " on the CPU" << std::endl;
 
-	Transition fallToLand(&fallState, &landState, 0.1f);
-	fallState.SetOnCompleteTransition(&fallToLand);
+	if (shouldReportMemory)
+	{
+		MemoryReport memoryReport;
+		bossModel.ReportMemory(memoryReport);
+		jointDirectory->ReportMemory(memoryReport, bossModel.GetName());
+		boss.ReportMemory(memoryReport);
+		animator.ReportMemory(memoryReport, "Boss");
+		if (numCrowdCharacters > 0)
+			crowdAtlas.ReportMemory(memoryReport, "Crowd");
+		for (size_t i = 0; i < cpuSkinnedMeshes.size(); i++)
+			cpuSkinnedMeshes[i].Skinning.ReportMemory(memoryReport, bossModel.GetName() + "/" + std::to_string(i));
+
+		memoryReport.Write(std::cout);
+		glfwTerminate();
+		return 0;
+	}
 
-	Transition fallToRoll(&fallState, &rollState, 0.3f);
-	fallState.AddTriggerTransition("MoveTrigger", &fallToRoll);
+	// Sleeping animators keep the same palette, so there's no need to upload it again
+	uint32_t uploadedPaletteVersion = UINT32_MAX;
+	const std::string skinningMatricesUniform = "u_SkinningMatrices";
+	const std::string paletteUniform = "u_Palette";
 
-	Transition landToIdle(&landState, &idleState, 0.3f);
-	landState.SetOnCompleteTransition(&landToIdle);
+	uint32_t cpuSkinnedPaletteVersion = UINT32_MAX;
+	float maxDistanceOutsideBounds = 0.0f;
 
-	Transition rollToMove(&rollState, &locomotionState, 0.3f);
-	rollState.SetOnCompleteTransition(&rollToMove);
+	AnimationRecording recording;
+	if (recordingFilePath)
+		animator.SetRecording(&recording);
 
-	Animator* animator = Animator::GetInstance();
-	animator->SetDirectory(jointDirectory);
-	animator->SetState(&idleState);
+#ifdef S_ENABLE_PROFILER
+	Profiler::BeginSession();
+#endif
 
 	while (!glfwWindowShouldClose(window))
 	{
+		S_PROFILE_FRAME();
+
 		float time = glfwGetTime();
 		s_DeltaTime = (time - s_LastFrameTime);
 		s_LastFrameTime = time;
 
+		if (recordingFilePath)
+			recording.MarkFrame(s_DeltaTime);
+
 		ProcessInput(window);
 		s_Camera.UpdateInput(window, s_DeltaTime);
 
@@ -167,51 +342,164 @@ int main()
 			if (s_MoveSpeed > 0.1f)
 			{
 				s_MoveSpeed = 0.0f;
-				animator->SetFloat("MoveSpeed", s_MoveSpeed);
-				animator->SetTrigger("HaltTrigger");
+				animator.SetFloat("MoveSpeed", s_MoveSpeed);
+				animator.SetTrigger("HaltTrigger");
 			}
 		}
 		else if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
 		{
 			/*s_MoveSpeed = 0.0f;
-			animator->SetFloat("MoveSpeed", s_MoveSpeed);*/
-			animator->SetTrigger("JumpTrigger");
+			animator.SetFloat("MoveSpeed", s_MoveSpeed);*/
+			animator.SetTrigger("JumpTrigger");
 		}
 		s_MoveSpeed = glm::clamp(s_MoveSpeed, 0.0f, 1.0f);
 		if (s_MoveSpeed > 0)
-			animator->SetTrigger("MoveTrigger");
+			animator.SetTrigger("MoveTrigger");
 		else if (s_MoveSpeed <= 0)
-			animator->SetTrigger("IdleTrigger");
+			animator.SetTrigger("IdleTrigger");
+
+		animator.SetFloat("MoveSpeed", s_MoveSpeed);
+
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), bossPosition) * glm::scale(glm::mat4(1.0f), glm::vec3(0.04f));
 
-		animator->SetFloat("MoveSpeed", s_MoveSpeed);
+		// Off-screen characters only have their animation time advanced
+		Frustum frustum(s_Camera.GetProjectionMatrix() * s_Camera.GetViewMatrix());
+		bool isBossVisible = frustum.Intersects(animator.GetBounds().Transformed(model));
+		animator.SetVisible(isBossVisible);
 
-		animator->Update(s_DeltaTime);
+		for (int i = 0; i < numInstancedCharacters; i++)
+		{
+			Animator& crowdAnimator = *instancedAnimators[i];
+			glm::mat4 crowdModel = GetCrowdModelMatrix(i, instancedColumns, instancedFirstRow);
+			crowdAnimator.SetVisible(frustum.Intersects(crowdAnimator.GetBounds().Transformed(crowdModel)));
+		}
+
+		float bossDistance = glm::distance(s_Camera.GetPosition(), bossPosition);
+		animator.SetLodFromDistance(bossDistance);
+		animationScheduler.SetPriority(&animator, 1.0f / (1.0f + bossDistance));
+		animationScheduler.Update(s_DeltaTime);
+
+		if (shouldSkinOnCpu && animator.GetPaletteVersion() != cpuSkinnedPaletteVersion)
+		{
+			S_PROFILE_SCOPE("CpuSkinning");
+
+			const std::vector<glm::mat4>& skinningMatrices = animator.GetSkinningMatrices();
+			for (CpuSkinnedMesh& mesh : cpuSkinnedMeshes)
+			{
+				mesh.Skinning.Skin(skinningMatrices.data(), skinningMatrices.size(), mesh.Positions.data(), mesh.Normals.data());
+				maxDistanceOutsideBounds = glm::max(maxDistanceOutsideBounds, GetDistanceOutside(animator.GetBounds(), mesh.Positions));
+			}
+			cpuSkinnedPaletteVersion = animator.GetPaletteVersion();
+		}
 
 		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(0.04f));
-
 		shader.Bind();
 		shader.SetMat4("u_Model", model);
 		shader.SetMat4("u_View", s_Camera.GetViewMatrix());
 		shader.SetMat4("u_Projection", s_Camera.GetProjectionMatrix());
 
-		shader.SetVec3("u_DirLight.Direction", { -0.2f, -1.0f, -0.3f });
-		shader.SetVec3("u_DirLight.Ambient", { 0.2f, 0.2f, 0.2f });
-		shader.SetVec3("u_DirLight.Diffuse", { 0.8f, 0.8f, 0.8f });
-		shader.SetVec3("u_DirLight.Specular", { 0.3f, 0.3f, 0.3f });
+		if (isBossVisible)
+		{
+			if (animator.GetPaletteVersion() != uploadedPaletteVersion)
+			{
+				S_PROFILE_SCOPE("UploadSkinningMatrices");
+
+				if (paletteFormat == PaletteFormat::Matrix4x4)
+				{
+					auto& skinningMatrices = animator.GetSkinningMatrices();
+					uint32_t numMatrices = glm::min((uint32_t)skinningMatrices.size(), MAX_SHADER_JOINTS);
+					shader.SetMat4Array(skinningMatricesUniform, skinningMatrices.data(), numMatrices);
+				}
+				else
+				{
+					const std::vector<float>& palette = animator.GetPalette();
+					uint32_t vectorsPerJoint = PaletteHelper::GetFloatsPerJoint(paletteFormat) / 4;
+					uint32_t numJoints = glm::min((uint32_t)palette.size() / (vectorsPerJoint * 4), MAX_SHADER_JOINTS);
+					shader.SetVec4Array(paletteUniform, reinterpret_cast<const glm::vec4*>(palette.data()), numJoints * vectorsPerJoint);
+				}
+				uploadedPaletteVersion = animator.GetPaletteVersion();
+			}
 
-		auto& skinningMatrices = animator->GetSkinningMatrices();
-		for (uint32_t i = 0; i < skinningMatrices.size(); i++)
-			shader.SetMat4("u_SkinningMatrices[" + std::to_string(i) + "]", skinningMatrices[i]);
+			bossModel.Draw(shader);
+		}
 
-		bossModel.Draw(shader);
+		if (numCrowdCharacters > 0)
+		{
+			S_PROFILE_SCOPE("DrawBakedCrowd");
+
+			crowdShader->Bind();
+			crowdShader->SetMat4("u_View", s_Camera.GetViewMatrix());
+			crowdShader->SetMat4("u_Projection", s_Camera.GetProjectionMatrix());
+			glActiveTexture(GL_TEXTURE0 + PALETTE_ATLAS_TEXTURE_UNIT);
+			glBindTexture(GL_TEXTURE_2D, crowdAtlasTextureId);
+			glActiveTexture(GL_TEXTURE0);
+
+			// Each character plays one of the clips out of step with its neighbours
+			int numColumns = GetCrowdColumns(numCrowdCharacters);
+			for (int i = 0; i < numCrowdCharacters; i++)
+			{
+				crowdShader->SetMat4("u_Model", GetCrowdModelMatrix(i, numColumns, 0));
+
+				const PaletteAtlas::ClipInfo& clip = crowdAtlas.GetClip(i % crowdAtlas.GetNumClips());
+				crowdShader->SetInt("u_ClipFirstRow", clip.FirstRow);
+				crowdShader->SetInt("u_ClipNumFrames", clip.NumFrames);
+				crowdShader->SetFloat("u_ClipFrameDuration", clip.FrameDuration);
+				crowdShader->SetFloat("u_ClipDuration", clip.Duration);
+				crowdShader->SetFloat("u_ClipTime", time + CROWD_TIME_OFFSET * i);
+
+				bossModel.Draw(*crowdShader);
+			}
+		}
+
+		if (numInstancedCharacters > 0)
+		{
+			S_PROFILE_SCOPE("DrawInstancedCrowd");
+
+			instanceBatch->Clear();
+			for (int i = 0; i < numInstancedCharacters; i++)
+			{
+				const Animator& crowdAnimator = *instancedAnimators[i];
+				if (!crowdAnimator.IsVisible())
+					continue;
+
+				const std::vector<glm::mat4>& skinningMatrices = crowdAnimator.GetSkinningMatrices();
+				instanceBatch->AddInstance(GetCrowdModelMatrix(i, instancedColumns, instancedFirstRow), skinningMatrices.data(),
+										  (uint32_t)skinningMatrices.size());
+			}
+
+			instancedShader->Bind();
+			instancedShader->SetMat4("u_View", s_Camera.GetViewMatrix());
+			instancedShader->SetMat4("u_Projection", s_Camera.GetProjectionMatrix());
+			instanceBatch->Draw(*instancedShader);
+		}
 		
-		glfwSwapBuffers(window);
+		{
+			S_PROFILE_SCOPE("SwapBuffers");
+			glfwSwapBuffers(window);
+		}
 		glfwPollEvents();
 	}
 
+#ifdef S_ENABLE_PROFILER
+	Profiler::EndSession();
+	Profiler::WriteChromeTrace("animation-trace.json");
+	Profiler::WriteFrameSummary(std::cout);
+#endif
+	AllocationTracker::WriteReport(std::cout);
+
+	if (shouldSkinOnCpu)
+		std::cout << "Skinned vertices reached " << maxDistanceOutsideBounds << " model units outside the animator's bounds" << std::endl;
+
+	if (recordingFilePath)
+	{
+		if (recording.Save(recordingFilePath))
+			std::cout << "Recorded " << recording.GetNumFrames() << " frames to " << recordingFilePath << std::endl;
+		else
+			std::cout << "Failed to save recording to " << recordingFilePath << std::endl;
+	}
+
 	glfwTerminate();
 	return 0;
 }
\ No newline at end of file
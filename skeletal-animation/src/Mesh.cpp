@@ -1,31 +1,31 @@
 #include "Mesh.h"
 
+#include "Animation/CpuSkinning.h"
+#include "Animation/Profiler.h"
+#include "Animation/MemoryReport.h"
+
 Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<Texture>& textures)
 	: m_Vertices(vertices), m_Indices(indices), m_Textures(textures)
 {
 	SetUpMesh();
-}
 
-void Mesh::Draw(Shader& shader)
-{
+	// Built once here, rather than on every draw
 	uint32_t numDiffuseTextures = 0;
 	uint32_t numSpecularTextures = 0;
-	for (uint32_t i = 0; i < m_Textures.size(); i++)
+	for (const Texture& texture : m_Textures)
 	{
-		glActiveTexture(GL_TEXTURE0 + i);
-		if (m_Textures[i].Type == TextureType::Diffuse)
-		{
-			numDiffuseTextures++;
-			shader.SetInt("u_Material.TextureDiffuse" + std::to_string(numDiffuseTextures), i);
-		}
-		else if (m_Textures[i].Type == TextureType::Specular)
-		{
-			numSpecularTextures++;
-			shader.SetInt("u_Material.TextureSpecular" + std::to_string(numSpecularTextures), i);
-		}
-		glBindTexture(GL_TEXTURE_2D, m_Textures[i].Id);
+		if (texture.Type == TextureType::Diffuse)
+			m_TextureUniformNames.push_back("u_Material.TextureDiffuse" + std::to_string(++numDiffuseTextures));
+		else
+			m_TextureUniformNames.push_back("u_Material.TextureSpecular" + std::to_string(++numSpecularTextures));
 	}
-	glActiveTexture(GL_TEXTURE0);
+}
+
+void Mesh::Draw(Shader& shader)
+{
+	S_PROFILE_SCOPE("Mesh::Draw");
+
+	BindTextures(shader);
 
 	glBindVertexArray(m_VertexArrayId);
 	glDrawElements(GL_TRIANGLES, m_Indices.size(), GL_UNSIGNED_INT, nullptr);
@@ -33,6 +33,50 @@ void Mesh::Draw(Shader& shader)
 	glBindVertexArray(0);
 }
 
+void Mesh::SetInstanceBuffer(uint32_t instanceBufferId)
+{
+	glBindVertexArray(m_VertexArrayId);
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBufferId);
+
+	// A mat4 attribute takes four locations, one per column
+	for (uint32_t column = 0; column < 4; column++)
+	{
+		glEnableVertexAttribArray(7 + column);
+		glVertexAttribPointer(7 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+							  (void*)(offsetof(InstanceData, Model) + column * sizeof(glm::vec4)));
+		glVertexAttribDivisor(7 + column, 1);
+	}
+
+	glEnableVertexAttribArray(11);
+	glVertexAttribIPointer(11, 1, GL_INT, sizeof(InstanceData), (void*)offsetof(InstanceData, PaletteOffset));
+	glVertexAttribDivisor(11, 1);
+
+	glBindVertexArray(0);
+}
+
+void Mesh::DrawInstanced(Shader& shader, uint32_t numInstances)
+{
+	S_PROFILE_SCOPE("Mesh::DrawInstanced");
+
+	BindTextures(shader);
+
+	glBindVertexArray(m_VertexArrayId);
+	glDrawElementsInstanced(GL_TRIANGLES, m_Indices.size(), GL_UNSIGNED_INT, nullptr, numInstances);
+
+	glBindVertexArray(0);
+}
+
+void Mesh::BindTextures(Shader& shader)
+{
+	for (uint32_t i = 0; i < m_Textures.size(); i++)
+	{
+		glActiveTexture(GL_TEXTURE0 + i);
+		shader.SetInt(m_TextureUniformNames[i], i);
+		glBindTexture(GL_TEXTURE_2D, m_Textures[i].Id);
+	}
+	glActiveTexture(GL_TEXTURE0);
+}
+
 void Mesh::SetUpMesh()
 {
 	// Generate and bind vertex array
@@ -76,3 +120,32 @@ void Mesh::SetUpMesh()
 	glEnableVertexAttribArray(6);
 	glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Weights));
 }
+
+
+CpuSkinningSource Mesh::GetSkinningSource() const
+{
+	CpuSkinningSource source;
+	if (m_Vertices.empty())
+		return source;
+
+	source.Positions = &m_Vertices[0].Position;
+	source.Normals = &m_Vertices[0].Normal;
+	source.JointIds = m_Vertices[0].JointIds;
+	source.Weights = m_Vertices[0].Weights;
+	source.NumVertices = m_Vertices.size();
+	source.Stride = sizeof(Vertex);
+	return source;
+}
+
+void Mesh::ReportMemory(MemoryReport& report, const std::string& asset) const
+{
+	size_t cpuBytes = sizeof(*this) + MemoryHelper::GetVectorBytes(m_Vertices) + MemoryHelper::GetVectorBytes(m_Indices)
+		+ MemoryHelper::GetVectorBytes(m_Textures) + MemoryHelper::GetVectorBytes(m_TextureUniformNames);
+	for (const Texture& texture : m_Textures)
+		cpuBytes += MemoryHelper::GetStringBytes(texture.FileName);
+	for (const std::string& uniformName : m_TextureUniformNames)
+		cpuBytes += MemoryHelper::GetStringBytes(uniformName);
+
+	size_t gpuBytes = m_Vertices.size() * sizeof(Vertex) + m_Indices.size() * sizeof(uint32_t);
+	report.Add("Meshes", asset, cpuBytes, gpuBytes);
+}
\ No newline at end of file
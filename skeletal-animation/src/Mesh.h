@@ -6,6 +6,9 @@
 
 #include "Shader.h"
 
+class MemoryReport;
+struct CpuSkinningSource;
+
 enum class TextureType
 {
 	Diffuse, Specular
@@ -52,11 +55,23 @@ struct Vertex
 	}
 };
 
+//! Per-instance attributes of instanced draws (see InstancedAnimVert.glsl and SkinnedInstanceBatch)
+struct InstanceData
+{
+	glm::mat4 Model;
+
+	//! Where the instance's palette starts in the palette buffer, in joints
+	int32_t PaletteOffset;
+};
+
 struct Texture
 {
 	uint32_t Id;
 	TextureType Type;
 	std::string FileName;
+
+	//! Estimated size in video memory, including mipmaps
+	size_t GpuBytes = 0;
 };
 
 class Mesh
@@ -65,12 +80,31 @@ public:
 	Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<Texture>& textures);
 
 	void Draw(Shader& shader);
+
+	//! Reads InstanceData from the buffer, one per instance, for DrawInstanced. Only needs setting once per buffer.
+	void SetInstanceBuffer(uint32_t instanceBufferId);
+
+	//! Draws the mesh once for each of the first numInstances entries of the instance buffer, in a single draw call
+	void DrawInstanced(Shader& shader, uint32_t numInstances);
+
+	size_t GetNumVertices() const { return m_Vertices.size(); }
+
+	//! Where CpuSkinning::Build finds this mesh's positions, normals and joint influences
+	CpuSkinningSource GetSkinningSource() const;
+
+	//! Adds the vertex and index data, both the copies we keep and the GPU buffers, to the report's "Meshes".
+	//! Textures are shared between meshes, so Model reports those.
+	void ReportMemory(MemoryReport& report, const std::string& asset) const;
 private:
 	void SetUpMesh();
+	void BindTextures(Shader& shader);
 private:
 	uint32_t m_VertexArrayId, m_VertexBufferId, m_IndexBufferId;
 
 	std::vector<Vertex> m_Vertices;
 	std::vector<uint32_t> m_Indices;
 	std::vector<Texture> m_Textures;
+
+	//! Name of the sampler uniform each texture is bound to
+	std::vector<std::string> m_TextureUniformNames;
 };
\ No newline at end of file
@@ -1,9 +1,12 @@
 #include "Model.h"
 
-#include "Core.h"
+#include "Animation/Core.h"
+#include "Animation/AllocationTracker.h"
+#include "Animation/Profiler.h"
+#include "Animation/MemoryReport.h"
 
 #include "TextureHelper.h"
-#include "AssimpHelper.h"
+#include "Animation/AssimpHelper.h"
 
 static aiTextureType ToAssimpTextureType(TextureType type)
 {
@@ -26,10 +29,40 @@ Model::Model(const char* path, const std::shared_ptr<JointDirectory>& jointDirec
 
 void Model::Draw(Shader& shader)
 {
+	S_PROFILE_SCOPE("Model::Draw");
+	S_ALLOCATION_SCOPE("Rendering");
+
 	for (uint32_t i = 0; i < m_Meshes.size(); i++)
 		m_Meshes[i].Draw(shader);
 }
 
+void Model::SetInstanceBuffer(uint32_t instanceBufferId)
+{
+	for (Mesh& mesh : m_Meshes)
+		mesh.SetInstanceBuffer(instanceBufferId);
+}
+
+void Model::DrawInstanced(Shader& shader, uint32_t numInstances)
+{
+	S_PROFILE_SCOPE("Model::DrawInstanced");
+	S_ALLOCATION_SCOPE("Rendering");
+
+	for (Mesh& mesh : m_Meshes)
+		mesh.DrawInstanced(shader, numInstances);
+}
+
+void Model::ReportMemory(MemoryReport& report) const
+{
+	for (const Mesh& mesh : m_Meshes)
+		mesh.ReportMemory(report, m_Name);
+
+	report.Add("Meshes", m_Name, sizeof(*this) + MemoryHelper::GetStringMapBytes(m_TexturesLoaded));
+
+	// Textures are only uploaded once per model, however many meshes use them
+	for (const auto& [fileName, texture] : m_TexturesLoaded)
+		report.Add("Textures", m_Name + "/" + fileName, 0, texture.GpuBytes);
+}
+
 void Model::LoadModel(const std::string& path)
 {
 	Assimp::Importer importer;
@@ -38,9 +71,10 @@ void Model::LoadModel(const std::string& path)
 	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
 	{
 		std::cout << "Error loading model with Assimp: " << importer.GetErrorString() << std::endl;
-		__debugbreak();
+		S_DEBUGBREAK();
 	}
 	m_DirectoryPath = path.substr(0, path.find_last_of('/'));
+	m_Name = path.substr(path.find_last_of('/') + 1);
 
 	ProcessNode(scene->mRootNode, scene);
 }
@@ -139,7 +173,7 @@ std::vector<Texture> Model::LoadMaterialTextures(aiMaterial* material, TextureTy
 			if (false)
 			{
 				// Assuming that textures are all in same directory as model
-				texture.Id = TextureHelper::LoadTexture(textureFileName.c_str(), m_DirectoryPath);
+				texture.Id = TextureHelper::LoadTexture(textureFileName.c_str(), m_DirectoryPath, &texture.GpuBytes);
 				texture.Type = type;
 				texture.FileName = textureFileName;
 			}
@@ -147,7 +181,7 @@ std::vector<Texture> Model::LoadMaterialTextures(aiMaterial* material, TextureTy
 			{
 				// Assuming textures are embedded in model file
 				const aiTexture* aiTexture = scene->GetEmbeddedTexture(textureFileName.c_str());
-				texture.Id = TextureHelper::LoadTextureEmbedded(aiTexture);
+				texture.Id = TextureHelper::LoadTextureEmbedded(aiTexture, &texture.GpuBytes);
 				texture.Type = type;
 				texture.FileName = textureFileName;
 			}
@@ -171,7 +205,8 @@ void Model::ExtractJoints(std::vector<Vertex>& vertices, aiMesh* mesh, const aiS
 		aiBone* bone = mesh->mBones[i];
 		
 		std::string jointName = bone->mName.C_Str();
-		int jointId = m_JointDirectory->AppendJoint(jointName, AssimpHelper::AssimpToGlmMatrix(bone->mOffsetMatrix));
+		glm::mat4 inverseBindPose = AssimpHelper::AssimpToGlmMatrix(bone->mOffsetMatrix);
+		int jointId = m_JointDirectory->AppendJoint(jointName, inverseBindPose);
 
 		S_ASSERT(jointId != -1);
 		
@@ -179,6 +214,7 @@ void Model::ExtractJoints(std::vector<Vertex>& vertices, aiMesh* mesh, const aiS
 		aiVertexWeight* weights = bone->mWeights;
 
 		// Go through all vertices whose position is influenced by this joint
+		float jointRadius = 0.0f;
 		for (uint32_t j = 0; j < numVerticesInBone; j++)
 		{
 			uint32_t vertexId = weights[j].mVertexId;
@@ -186,6 +222,12 @@ void Model::ExtractJoints(std::vector<Vertex>& vertices, aiMesh* mesh, const aiS
 
 			S_ASSERT(vertexId < vertices.size());
 			vertices[vertexId].SetJointData(jointId, weight);
+
+			// Skinned vertices are weighted averages of rigidly transformed positions, so a sphere around each
+			// joint enclosing all of its vertices (in joint space) gives a conservative bound on the skinned mesh
+			glm::vec3 jointSpacePosition = glm::vec3(inverseBindPose * glm::vec4(vertices[vertexId].Position, 1.0f));
+			jointRadius = glm::max(jointRadius, glm::length(jointSpacePosition));
 		}
+		m_JointDirectory->ExpandJointRadius(jointId, jointRadius);
 	}
 }
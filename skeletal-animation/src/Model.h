@@ -9,12 +9,25 @@
 #include "Mesh.h"
 #include "Animation/JointDirectory.h"
 
+class MemoryReport;
+
 class Model
 {
 public:
 	Model(const char* path, const std::shared_ptr<JointDirectory>& jointDirectory);
 
 	void Draw(Shader& shader);
+
+	//! Instanced drawing of every mesh, with per-instance attributes from the buffer (see Mesh::SetInstanceBuffer)
+	void SetInstanceBuffer(uint32_t instanceBufferId);
+	void DrawInstanced(Shader& shader, uint32_t numInstances);
+
+	const std::string& GetName() const { return m_Name; }
+	size_t GetNumMeshes() const { return m_Meshes.size(); }
+	const Mesh& GetMesh(size_t index) const { return m_Meshes[index]; }
+
+	//! Adds this model's meshes and textures (but not its shared skeleton) to the report
+	void ReportMemory(MemoryReport& report) const;
 private:
 	void LoadModel(const std::string& path);
 	void ProcessNode(aiNode* node, const aiScene* scene);
@@ -24,6 +37,7 @@ private:
 
 private:
 	std::vector<Mesh> m_Meshes;
+	std::string m_Name;
 	std::string m_DirectoryPath;
 
 	std::unordered_map<std::string, Texture> m_TexturesLoaded;
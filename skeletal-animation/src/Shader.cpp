@@ -1,12 +1,19 @@
 #include "Shader.h"
+#include "Animation/Core.h"
 #include <glm/gtc/type_ptr.hpp>
 
-std::string Shader::ParseShader(const char* fileName)
+std::string Shader::ParseShader(const char* fileName, const std::string& defines)
 {
 	std::stringstream buffer;
 	std::ifstream fileStream(fileName);
 	buffer << fileStream.rdbuf();
-	return buffer.str();
+	std::string source = buffer.str();
+
+	// #version has to come first
+	size_t versionLineEnd = source.find('\n');
+	if (!defines.empty() && versionLineEnd != std::string::npos)
+		source.insert(versionLineEnd + 1, defines);
+	return source;
 }
 
 uint32_t Shader::CompileShader(const char* source, GLenum type)
@@ -25,16 +32,16 @@ uint32_t Shader::CompileShader(const char* source, GLenum type)
 		
 		const char* shaderTypeName = (type == GL_VERTEX_SHADER) ? "Vertex" : "Fragment";
 		std::cout << shaderTypeName << " shader failed to compile:\n" << infoLog;
-		__debugbreak();
+		S_DEBUGBREAK();
 	}
 	return shaderId;
 }
 
 
-Shader::Shader(const char* vertexPath, const char* fragmentPath)
+Shader::Shader(const char* vertexPath, const char* fragmentPath, const std::string& defines)
 {
-	std::string vertexSource = ParseShader(vertexPath);
-	std::string fragmentSource = ParseShader(fragmentPath);
+	std::string vertexSource = ParseShader(vertexPath, defines);
+	std::string fragmentSource = ParseShader(fragmentPath, defines);
 
 	uint32_t vertId = CompileShader(vertexSource.c_str(), GL_VERTEX_SHADER);
 	uint32_t fragId = CompileShader(fragmentSource.c_str(), GL_FRAGMENT_SHADER);
@@ -53,7 +60,7 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
 		glGetProgramInfoLog(m_RendererId, sizeof(infoLog), nullptr, infoLog);
 
 		std::cout << "Shader program failed to link:\n" << infoLog;
-		__debugbreak();
+		S_DEBUGBREAK();
 	}
 
 	glDeleteShader(vertId);
@@ -111,6 +118,18 @@ void Shader::SetMat4(const std::string& name, const glm::mat4& value)
 	glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
+void Shader::SetMat4Array(const std::string& name, const glm::mat4* values, uint32_t count)
+{
+	if (m_ShaderLocationCache.find(name) != m_ShaderLocationCache.end())
+	{
+		glUniformMatrix4fv(m_ShaderLocationCache.at(name), count, GL_FALSE, glm::value_ptr(values[0]));
+		return;
+	}
+	int location = glGetUniformLocation(m_RendererId, name.c_str());
+	m_ShaderLocationCache[name] = location;
+	glUniformMatrix4fv(location, count, GL_FALSE, glm::value_ptr(values[0]));
+}
+
 void Shader::SetVec3(const std::string& name, const glm::vec3& value)
 {
 	if (m_ShaderLocationCache.find(name) != m_ShaderLocationCache.end())
@@ -124,3 +143,15 @@ void Shader::SetVec3(const std::string& name, const glm::vec3& value)
 }
 
 
+
+void Shader::SetVec4Array(const std::string& name, const glm::vec4* values, uint32_t count)
+{
+	if (m_ShaderLocationCache.find(name) != m_ShaderLocationCache.end())
+	{
+		glUniform4fv(m_ShaderLocationCache.at(name), count, glm::value_ptr(values[0]));
+		return;
+	}
+	int location = glGetUniformLocation(m_RendererId, name.c_str());
+	m_ShaderLocationCache[name] = location;
+	glUniform4fv(location, count, glm::value_ptr(values[0]));
+}
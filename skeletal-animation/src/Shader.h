@@ -12,7 +12,8 @@
 class Shader
 {
 public:
-	Shader(const char* vertexPath, const char* fragmentPath);
+	//! defines, if given, are inserted after the #version line of both shaders, e.g. "#define PALETTE_AFFINE_3X4\n"
+	Shader(const char* vertexPath, const char* fragmentPath, const std::string& defines = "");
 	~Shader();
 
 	void Bind();
@@ -21,12 +22,16 @@ public:
 	void SetInt(const std::string& name, int value);
 	void SetFloat(const std::string& name, float value);
 	void SetMat4(const std::string& name, const glm::mat4& value);
+	//! Sets `count` consecutive elements of a mat4 array uniform, starting with the named one
+	void SetMat4Array(const std::string& name, const glm::mat4* values, uint32_t count);
 	void SetVec3(const std::string& name, const glm::vec3& value);
+	//! Sets `count` consecutive elements of a vec4 array uniform, starting with the named one
+	void SetVec4Array(const std::string& name, const glm::vec4* values, uint32_t count);
 
 	uint32_t GetId() const { return m_RendererId; }
 
 private:
-	std::string ParseShader(const char* fileName);
+	std::string ParseShader(const char* fileName, const std::string& defines);
 	uint32_t CompileShader(const char* source, GLenum type);
 
 	uint32_t m_RendererId;
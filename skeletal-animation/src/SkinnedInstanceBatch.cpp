@@ -0,0 +1,86 @@
+#include "SkinnedInstanceBatch.h"
+
+#include "Model.h"
+#include "Shader.h"
+
+#include "Animation/Core.h"
+#include "Animation/PaletteFormat.h"
+#include "Animation/Profiler.h"
+
+#include <glad/glad.h>
+
+SkinnedInstanceBatch::SkinnedInstanceBatch(Model& model)
+	: m_Model(model)
+{
+	// The meshes' instanced attributes read from this buffer, so give it a store before they point at it
+	glGenBuffers(1, &m_InstanceBufferId);
+	glBindBuffer(GL_ARRAY_BUFFER, m_InstanceBufferId);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	model.SetInstanceBuffer(m_InstanceBufferId);
+
+	glGenBuffers(1, &m_PaletteBufferId);
+	glBindBuffer(GL_TEXTURE_BUFFER, m_PaletteBufferId);
+	glGenTextures(1, &m_PaletteTextureId);
+	glBindTexture(GL_TEXTURE_BUFFER, m_PaletteTextureId);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_PaletteBufferId);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &m_MaxPaletteTexels);
+}
+
+SkinnedInstanceBatch::~SkinnedInstanceBatch()
+{
+	glDeleteTextures(1, &m_PaletteTextureId);
+	glDeleteBuffers(1, &m_PaletteBufferId);
+	glDeleteBuffers(1, &m_InstanceBufferId);
+}
+
+void SkinnedInstanceBatch::Clear()
+{
+	m_Instances.clear();
+	m_PaletteTexels.clear();
+}
+
+void SkinnedInstanceBatch::AddInstance(const glm::mat4& model, const glm::mat4* skinningMatrices, uint32_t numJoints)
+{
+	InstanceData instance;
+	instance.Model = model;
+	instance.PaletteOffset = (int32_t)(m_PaletteTexels.size() / TEXELS_PER_JOINT);
+	m_Instances.push_back(instance);
+
+	size_t firstTexel = m_PaletteTexels.size();
+	m_PaletteTexels.resize(firstTexel + (size_t)numJoints * TEXELS_PER_JOINT);
+	PaletteHelper::Pack(PaletteFormat::Affine3x4, skinningMatrices, numJoints, &m_PaletteTexels[firstTexel].x);
+}
+
+void SkinnedInstanceBatch::Draw(Shader& shader)
+{
+	S_PROFILE_SCOPE("SkinnedInstanceBatch::Draw");
+
+	if (m_Instances.empty())
+		return;
+
+	// GL 3.3 only promises 65536 texels, enough for a few hundred characters; desktop drivers and llvmpipe allow far more
+	S_ASSERT(m_PaletteTexels.size() <= (size_t)m_MaxPaletteTexels);
+
+	// Orphaning the old storage lets the driver hand out new memory rather than wait for last frame's draws
+	{
+		S_PROFILE_SCOPE("UploadInstances");
+		glBindBuffer(GL_ARRAY_BUFFER, m_InstanceBufferId);
+		glBufferData(GL_ARRAY_BUFFER, m_Instances.size() * sizeof(InstanceData), m_Instances.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, m_PaletteBufferId);
+		glBufferData(GL_TEXTURE_BUFFER, m_PaletteTexels.size() * sizeof(glm::vec4), m_PaletteTexels.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	shader.Bind();
+	shader.SetInt("u_Palettes", PALETTE_TEXTURE_UNIT);
+	glActiveTexture(GL_TEXTURE0 + PALETTE_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, m_PaletteTextureId);
+	glActiveTexture(GL_TEXTURE0);
+
+	m_Model.DrawInstanced(shader, GetNumInstances());
+}
\ No newline at end of file
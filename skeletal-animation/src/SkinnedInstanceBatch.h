@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Mesh.h"
+
+class Model;
+class Shader;
+
+//! Draws many skinned characters sharing a Model with a single instanced draw call per mesh (see InstancedAnimVert.glsl),
+//! instead of a draw call per mesh per character and a palette upload for each.
+//! Every instance's palette goes into one texture buffer in PaletteFormat::Affine3x4, one texel per matrix row, and its
+//! model matrix and palette offset into an instance buffer. Both are refilled every frame.
+class SkinnedInstanceBatch
+{
+public:
+	//! Texture unit u_Palettes is bound to, after the ones Mesh::Draw binds its textures to
+	static constexpr int PALETTE_TEXTURE_UNIT = 8;
+
+	//! Points the model's meshes at this batch's instance buffer, so only one batch can draw a model. This adds
+	//! instanced attributes to the meshes' vertex arrays, so only create a batch for models that are drawn instanced.
+	explicit SkinnedInstanceBatch(Model& model);
+	~SkinnedInstanceBatch();
+
+	SkinnedInstanceBatch(const SkinnedInstanceBatch&) = delete;
+	SkinnedInstanceBatch& operator=(const SkinnedInstanceBatch&) = delete;
+
+	//! Starts a new frame's instances
+	void Clear();
+
+	void AddInstance(const glm::mat4& model, const glm::mat4* skinningMatrices, uint32_t numJoints);
+
+	uint32_t GetNumInstances() const { return (uint32_t)m_Instances.size(); }
+
+	//! Uploads the instances and palettes added since Clear, then draws them
+	void Draw(Shader& shader);
+private:
+	//! Texels per joint in the palette buffer
+	static constexpr int TEXELS_PER_JOINT = 3;
+
+	Model& m_Model;
+
+	uint32_t m_InstanceBufferId;
+	uint32_t m_PaletteBufferId;
+	uint32_t m_PaletteTextureId;
+
+	//! Largest palette buffer the driver can read through a texture, in texels
+	int m_MaxPaletteTexels = 0;
+
+	std::vector<InstanceData> m_Instances;
+	std::vector<glm::vec4> m_PaletteTexels;
+};
\ No newline at end of file
@@ -1,9 +1,12 @@
 #include "TextureHelper.h"
 
+#include "Animation/Core.h"
+#include "Animation/PaletteAtlas.h"
+
 #include <glad/glad.h>
 #include <iostream>
 
-uint32_t TextureHelper::LoadTexture(const char* fileName, const std::string& directoryPath)
+uint32_t TextureHelper::LoadTexture(const char* fileName, const std::string& directoryPath, size_t* gpuBytes)
 {
 	std::string path = directoryPath + '/' + fileName;
 
@@ -13,7 +16,7 @@ uint32_t TextureHelper::LoadTexture(const char* fileName, const std::string& dir
 	if (!data)
 	{
 		std::cout << "Failed to load texture." << std::endl;
-		__debugbreak();
+		S_DEBUGBREAK();
 	}
 
 	uint32_t textureId;
@@ -28,7 +31,7 @@ uint32_t TextureHelper::LoadTexture(const char* fileName, const std::string& dir
 	else
 	{
 		std::cout << "Unknown image format in texture: " << path << std::endl;
-		__debugbreak();
+		S_DEBUGBREAK();
 	}
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, imageFormat, GL_UNSIGNED_BYTE, data);
@@ -42,10 +45,12 @@ uint32_t TextureHelper::LoadTexture(const char* fileName, const std::string& dir
 
 	stbi_image_free(data);
 
+	if (gpuBytes)
+		*gpuBytes = EstimateGpuBytes(width, height);
 	return textureId;
 }
 
-uint32_t TextureHelper::LoadTextureEmbedded(const aiTexture* texture)
+uint32_t TextureHelper::LoadTextureEmbedded(const aiTexture* texture, size_t* gpuBytes)
 {
 	uint32_t textureId;
 	glGenTextures(1, &textureId);
@@ -83,7 +88,40 @@ uint32_t TextureHelper::LoadTextureEmbedded(const aiTexture* texture)
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
-	//stbi_image_free(image_data);
-	
+	// GL has its own copy now
+	stbi_image_free(image_data);
+
+	if (gpuBytes)
+		*gpuBytes = EstimateGpuBytes(width, height);
+	return textureId;
+}
+
+uint32_t TextureHelper::CreatePaletteTexture(const PaletteAtlas& atlas, size_t* gpuBytes)
+{
+	uint32_t textureId;
+	glGenTextures(1, &textureId);
+	glBindTexture(GL_TEXTURE_2D, textureId);
+
+	// Rows of palettes aren't a multiple of four bytes apart when stored as halves
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (atlas.UsesHalfFloats())
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, atlas.GetWidth(), atlas.GetHeight(), 0, GL_RGBA, GL_HALF_FLOAT, atlas.GetTexels());
+	else
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, atlas.GetWidth(), atlas.GetHeight(), 0, GL_RGBA, GL_FLOAT, atlas.GetTexels());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	if (gpuBytes)
+		*gpuBytes = atlas.GetTexelBytes();
 	return textureId;
 }
+
+size_t TextureHelper::EstimateGpuBytes(int width, int height)
+{
+	size_t baseLevelBytes = (size_t)width * height * 4;
+	return baseLevelBytes + baseLevelBytes / 3;
+}
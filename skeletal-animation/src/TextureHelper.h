@@ -7,9 +7,18 @@
 
 #include <assimp/scene.h>
 
+class PaletteAtlas;
+
 namespace TextureHelper
 {
-	uint32_t LoadTexture(const char* fileName, const std::string& directoryPath);
+	//! gpuBytes, if given, receives the estimated size of the texture in video memory
+	uint32_t LoadTexture(const char* fileName, const std::string& directoryPath, size_t* gpuBytes = nullptr);
+
+	uint32_t LoadTextureEmbedded(const aiTexture* texture, size_t* gpuBytes = nullptr);
+
+	//! Float texture holding the atlas's palettes, read one texel at a time by BakedAnimVert.glsl (no filtering or mipmaps)
+	uint32_t CreatePaletteTexture(const PaletteAtlas& atlas, size_t* gpuBytes = nullptr);
 
-	uint32_t LoadTextureEmbedded(const aiTexture* texture);
+	//! Drivers generally store 8 bit RGB as RGBA, and a full mip chain adds another third
+	size_t EstimateGpuBytes(int width, int height);
 }
\ No newline at end of file